@@ -0,0 +1,282 @@
+#include "Analytics.h"
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <chrono>
+
+namespace {
+
+// One session's share of a type, kept for the learning curve
+struct SessionPoint {
+    int64_t startTime = 0;
+    std::string sessionId;
+    int attempts = 0;
+    int goals = 0;
+};
+
+struct TypePartial {
+    int     sessions = 0;
+    int64_t attempts = 0;
+    int64_t goals = 0;
+    std::array<int, 101> histogram{};   // sessions by accuracy, 1% bins
+    // Blocks of BLOCK attempts: squared distance of each block's accuracy
+    // from its session's, and what chance alone would give on average
+    int64_t blocks = 0;
+    double  blockSq = 0.0;
+    double  blockChance = 0.0;
+    TimingStats timing;                 // sessions folded in one by one
+    std::vector<SessionPoint> points;
+
+    void Merge(TypePartial&& o)
+    {
+        sessions += o.sessions;
+        attempts += o.attempts;
+        goals += o.goals;
+        for (size_t i = 0; i < histogram.size(); i++) histogram[i] += o.histogram[i];
+        blocks += o.blocks;
+        blockSq += o.blockSq;
+        blockChance += o.blockChance;
+        timing.Fold(o.timing);
+        points.insert(points.end(), std::make_move_iterator(o.points.begin()), std::make_move_iterator(o.points.end()));
+    }
+};
+
+// What one worker has seen. Every field merges by addition or concatenation,
+// so partials can be combined in any grouping.
+struct Partial {
+    std::unordered_map<std::string, TypePartial> types;
+    size_t files = 0;
+    size_t skipped = 0;
+
+    void Fold(const ImportedSession& s)
+    {
+        files++;
+        std::unordered_map<std::string, std::pair<int, int>> tally;   // type -> attempts, goals
+        std::unordered_map<std::string, TimingStats> timing;
+        for (const auto& shot : s.shots) {
+            const std::string& type = shot.shotType.empty() ? "Unknown" : shot.shotType;
+            auto& t = tally[type];
+            t.first += shot.attempts;
+            t.second += shot.goals;
+            if (!shot.attemptTimes.empty()) timing[type].Add(TimingStats::Of(shot.attemptTimes));
+        }
+
+        for (const auto& [type, t] : tally) {
+            if (t.first <= 0) continue;
+            TypePartial& p = types[type];
+            p.sessions++;
+            p.attempts += t.first;
+            p.goals += t.second;
+            auto times = timing.find(type);
+            if (times != timing.end()) p.timing.Fold(times->second);
+            p.points.push_back({ s.startTime, s.sessionId, t.first, t.second });
+            double acc = (double)t.second / t.first;
+            if (t.first >= Analytics::MIN_SESSION_ATTEMPTS) p.histogram[(size_t)std::lround(acc * 100.0)]++;
+        }
+
+        for (const auto& shot : s.shots) {
+            const auto& h = shot.attemptHistory;
+            if (h.size() < (size_t)Analytics::BLOCK) continue;
+            const auto& t = tally[shot.shotType.empty() ? "Unknown" : shot.shotType];
+            double acc = (double)t.second / t.first;
+            // A block is part of the session it is compared with, which
+            // narrows its spread by the finite-population factor
+            double chance = acc * (1.0 - acc) / Analytics::BLOCK *
+                (t.first - Analytics::BLOCK) / std::max(1, t.first - 1);
+            TypePartial& p = types[shot.shotType.empty() ? "Unknown" : shot.shotType];
+            for (size_t b = 0; b + Analytics::BLOCK <= h.size(); b += Analytics::BLOCK) {
+                int g = 0;
+                for (size_t i = b; i < b + Analytics::BLOCK; i++) g += h[i];
+                double d = (double)g / Analytics::BLOCK - acc;
+                p.blocks++;
+                p.blockSq += d * d;
+                p.blockChance += chance;
+            }
+        }
+    }
+
+    void Merge(Partial&& o)
+    {
+        for (auto& [type, p] : o.types) types[type].Merge(std::move(p));
+        files += o.files;
+        skipped += o.skipped;
+    }
+};
+
+float Percentile(const std::array<int, 101>& histogram, double q)
+{
+    int64_t total = 0;
+    for (int n : histogram) total += n;
+    if (total == 0) return 0.f;
+    int64_t seen = 0;
+    for (size_t i = 0; i < histogram.size(); i++) {
+        seen += histogram[i];
+        if (seen >= q * total) return (float)i / 100.f;
+    }
+    return 1.f;
+}
+
+TypeAnalytics Finish(const std::string& type, TypePartial& p)
+{
+    TypeAnalytics r;
+    r.type = type;
+    r.sessions = p.sessions;
+    r.attempts = p.attempts;
+    r.goals = p.goals;
+    r.timing = p.timing;
+    r.p10 = Percentile(p.histogram, 0.10);
+    r.p25 = Percentile(p.histogram, 0.25);
+    r.p50 = Percentile(p.histogram, 0.50);
+    r.p75 = Percentile(p.histogram, 0.75);
+    r.p90 = Percentile(p.histogram, 0.90);
+    if (p.blocks > 0)
+        r.consistency = p.blockSq > 0.0
+            ? (float)(100.0 * std::min(1.0, std::sqrt(p.blockChance / p.blockSq)))
+            : 100.f;
+
+    // Order sessions by time; the id only breaks ties so the curve is the
+    // same whichever worker saw what
+    std::sort(p.points.begin(), p.points.end(), [](const SessionPoint& a, const SessionPoint& b) {
+        return a.startTime != b.startTime ? a.startTime < b.startTime : a.sessionId < b.sessionId;
+    });
+    int64_t block = std::max<int64_t>(Analytics::CURVE_BLOCK,
+        (p.attempts + Analytics::CURVE_POINTS - 1) / Analytics::CURVE_POINTS);
+    int64_t practice = 0, chunkAttempts = 0, chunkGoals = 0;
+    for (const auto& pt : p.points) {
+        practice += pt.attempts;
+        chunkAttempts += pt.attempts;
+        chunkGoals += pt.goals;
+        if (chunkAttempts >= block || &pt == &p.points.back()) {
+            r.curve.push_back({ (int)practice, (float)chunkGoals / (float)chunkAttempts });
+            chunkAttempts = chunkGoals = 0;
+        }
+    }
+    return r;
+}
+
+AnalyticsReport Report(Partial& total)
+{
+    AnalyticsReport report;
+    report.files = total.files + total.skipped;
+    report.skipped = total.skipped;
+    for (auto& [type, p] : total.types) report.types.push_back(Finish(type, p));
+    std::sort(report.types.begin(), report.types.end(),
+        [](const TypeAnalytics& a, const TypeAnalytics& b) { return a.type < b.type; });
+    return report;
+}
+
+// Runs work(worker, i) for every i in [0, n) on `threads` threads. Each
+// takes the next index as it finishes one, as Importer::Run does, so a
+// slow file holds up only the worker reading it.
+template<typename Work>
+void Share(size_t n, unsigned threads, Work&& work, const std::atomic<bool>* cancel)
+{
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::thread> pool;
+    for (unsigned w = 0; w < threads; w++)
+        pool.emplace_back([&, w]() {
+            for (size_t i = next.fetch_add(1); i < n && !(cancel && *cancel); i = next.fetch_add(1)) work(w, i);
+        });
+    for (auto& t : pool) t.join();
+}
+
+unsigned Workers(unsigned threads, size_t items)
+{
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    return (unsigned)std::min<size_t>(threads, std::max<size_t>(1, items));
+}
+
+} // namespace
+
+AnalyticsReport Analytics::Run(
+    const std::filesystem::path& folder,
+    unsigned threads,
+    std::function<void(const ImportProgress&)> onProgress,
+    const std::atomic<bool>* cancel)
+{
+    const auto files = Importer::Discover(folder);
+    const auto start = std::chrono::steady_clock::now();
+    threads = Workers(threads, files.size());
+
+    std::vector<Partial> partials(threads);
+    std::atomic<size_t>   done{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::atomic<bool>     finished{ false };
+    std::mutex              mtx;
+    std::condition_variable cv;
+
+    auto snapshot = [&]() {
+        ImportProgress p;
+        p.filesDone = done;
+        p.filesTotal = files.size();
+        p.bytesRead = bytes;
+        p.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return p;
+    };
+
+    // Progress comes from this thread, as with Importer::Run
+    std::thread workers([&]() {
+        std::vector<std::string> buffers(threads);
+        Share(files.size(), threads, [&](unsigned w, size_t i) {
+            std::string& buf = buffers[w];
+            ImportedSession session;
+            bool ok = false;
+            std::ifstream in(files[i], std::ios::binary | std::ios::ate);
+            if (in.is_open()) {
+                std::streamsize size = in.tellg();
+                in.seekg(0);
+                buf.resize(size > 0 ? (size_t)size : 0);
+                if (size > 0 && in.read(buf.data(), size)) {
+                    bytes += (uint64_t)size;
+                    ok = Importer::Parse(buf, files[i].stem().string().substr(8), session);   // strip "session_"
+                }
+            }
+            if (ok) partials[w].Fold(session);
+            else partials[w].skipped++;
+            done++;
+        }, cancel);
+        std::lock_guard<std::mutex> lock(mtx);
+        finished = true;
+        cv.notify_all();
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!finished) {
+            cv.wait_for(lock, std::chrono::milliseconds(250));
+            if (onProgress && !finished) {
+                lock.unlock();
+                onProgress(snapshot());
+                lock.lock();
+            }
+        }
+    }
+    workers.join();
+
+    for (unsigned w = 1; w < threads; w++) partials[0].Merge(std::move(partials[w]));
+    AnalyticsReport report = Report(partials[0]);
+    report.threads = threads;
+    report.elapsedSec = snapshot().elapsedSec;
+    if (onProgress) onProgress(snapshot());
+    return report;
+}
+
+AnalyticsReport Analytics::Run(const std::vector<ImportedSession>& sessions, unsigned threads)
+{
+    const auto start = std::chrono::steady_clock::now();
+    threads = Workers(threads, sessions.size());
+
+    std::vector<Partial> partials(threads);
+    Share(sessions.size(), threads, [&](unsigned w, size_t i) { partials[w].Fold(sessions[i]); }, nullptr);
+
+    for (unsigned w = 1; w < threads; w++) partials[0].Merge(std::move(partials[w]));
+    AnalyticsReport report = Report(partials[0]);
+    report.threads = threads;
+    report.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
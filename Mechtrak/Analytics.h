@@ -0,0 +1,77 @@
+#pragma once
+#include "Importer.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <atomic>
+
+// Cross-session analytics over the session_*.json files in rl_best_stats:
+// per shot type learning curves, percentiles of session accuracy and a
+// consistency score. Kept free of BakkesMod like the Importer so
+// tools/mechtrak_analyze.cpp can build it.
+//
+// Workers take files one at a time from a shared counter. Each parses its
+// file, folds it into its own partial result and drops it, so memory
+// holds a few counters per type and session rather than every attempt.
+// Partials combine with an associative Merge, so the result does not depend
+// on which worker saw which file.
+
+struct CurvePoint {
+    int   practice = 0;         // attempts of this type played up to the end of the block
+    float accuracy = 0.f;       // 0..1 over the block
+};
+
+struct TypeAnalytics {
+    std::string type;
+    int     sessions = 0;       // sessions with at least one attempt of this type
+    int64_t attempts = 0;
+    int64_t goals = 0;
+
+    // Percentiles of per-session accuracy (0..1), over sessions with at
+    // least Analytics::MIN_SESSION_ATTEMPTS of this type
+    float p10 = 0.f, p25 = 0.f, p50 = 0.f, p75 = 0.f, p90 = 0.f;
+
+    // 0..100. Compares the spread of accuracy over blocks of BLOCK attempts
+    // with what chance alone gives at the same accuracy: 100 is as steady as
+    // chance allows, 50 swings twice as much.
+    float consistency = 0.f;
+
+    // Accuracy against practice, oldest first, at most CURVE_POINTS points
+    std::vector<CurvePoint> curve;
+
+    // Time-to-first-touch, attempt length and pace, over the attempts that
+    // have times (files saved before they were recorded add nothing)
+    TimingStats timing;
+
+    float Accuracy() const { return attempts > 0 ? (float)goals / (float)attempts : 0.f; }
+};
+
+struct AnalyticsReport {
+    std::vector<TypeAnalytics> types;   // by type name
+    size_t   files = 0;
+    size_t   skipped = 0;               // unreadable or not a session
+    unsigned threads = 0;
+    double   elapsedSec = 0.0;
+};
+
+class Analytics {
+public:
+    static constexpr int MIN_SESSION_ATTEMPTS = 10;
+    static constexpr int BLOCK = 10;
+    static constexpr int CURVE_BLOCK = 100;    // fewest attempts behind one curve point
+    static constexpr int CURVE_POINTS = 120;
+
+    // Analyses every session file in folder on `threads` workers (0 =
+    // hardware concurrency). onProgress is called from the calling thread
+    // roughly every 250 ms. Setting *cancel stops early with what was read.
+    static AnalyticsReport Run(
+        const std::filesystem::path& folder,
+        unsigned threads,
+        std::function<void(const ImportProgress&)> onProgress,
+        const std::atomic<bool>* cancel = nullptr
+    );
+
+    // Same, over sessions already in memory (e.g. history.mtk)
+    static AnalyticsReport Run(const std::vector<ImportedSession>& sessions, unsigned threads);
+};
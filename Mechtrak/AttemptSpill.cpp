@@ -0,0 +1,500 @@
+#include "AttemptSpill.h"
+#include "ShotStats.h"
+#include "Codec.h"
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <cstdio>
+
+namespace {
+
+constexpr char     MAGIC[4] = { 'M', 'T', 'K', 'S' };
+constexpr uint8_t  VERSION = 1;
+constexpr uint64_t SLACK = 1 << 20;   // dead journal bytes before Compact() looks
+
+// What a sealed block stores: outcomes packed eight per byte and the times
+// of its newest attempts as zigzag deltas (see Codec.h)
+struct BlockBody {
+    std::vector<bool>     history;
+    std::vector<uint32_t> times;
+};
+
+struct Extent;
+
+// One session's spill file for this run: "MTKS", a version byte, then block
+// bodies back to back. Blocks hold it through shared_ptr, and the file goes
+// when the last of them does. Only Flush() and Compact(), on the scheduler,
+// touch the file; the game thread hands them bodies in memory.
+struct Journal {
+    std::string key;            // sanitized session id
+    std::filesystem::path path;
+    std::mutex m;
+    uint64_t size = 0;
+    bool     broken = false;
+    // Blocks waiting for Flush, oldest first, and the ones in the file
+    std::vector<std::weak_ptr<const Extent>> unwritten;
+    std::vector<std::weak_ptr<const Extent>> written;
+
+    ~Journal()
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+
+    bool Add(std::shared_ptr<const Extent> e, std::string body);
+    bool Read(const Extent& e, std::string& out);
+    void Flush();
+    void Compact();
+};
+
+// Where a block's body is: in memory until its journal is next flushed,
+// then at offset in the file. Both are guarded by the journal's mutex.
+struct Extent {
+    std::shared_ptr<Journal> journal;
+    size_t bytes = 0;
+    mutable std::string body;
+    mutable uint64_t    offset = 0;
+};
+
+std::mutex             mtx;
+std::filesystem::path  dir;
+std::string            currentId;
+std::weak_ptr<Journal> current;
+uint64_t               nextSeq = 1;
+std::vector<std::weak_ptr<Journal>> journals;
+std::atomic<size_t>    budget{ 256 * 1024 };
+std::atomic<bool>      pending{ false };
+
+// Session ids come from the server; keep filenames boring
+std::string SanitizeKey(const std::string& sessionId)
+{
+    std::string key = sessionId;
+    for (auto& c : key)
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-') c = '_';
+    return key.empty() ? "unknown" : key;
+}
+
+// A file name no journal of this run has used; caller holds mtx
+std::filesystem::path NewPathLocked(const std::string& key)
+{
+    char num[24];
+    std::snprintf(num, sizeof(num), "_%llu.mtb", (unsigned long long)nextSeq++);
+    return dir / (key + num);
+}
+
+// The journal new blocks of sessionId go to
+std::shared_ptr<Journal> JournalFor(const std::string& sessionId)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (dir.empty()) return nullptr;
+    auto journal = current.lock();
+    if (journal && currentId == sessionId) return journal;
+
+    journal = std::make_shared<Journal>();
+    journal->key = SanitizeKey(sessionId);
+    journal->path = NewPathLocked(journal->key);
+    current = journal;
+    currentId = sessionId;
+    std::erase_if(journals, [](const auto& j) { return j.expired(); });
+    journals.push_back(journal);
+    return journal;
+}
+
+bool Journal::Add(std::shared_ptr<const Extent> e, std::string body)
+{
+    std::lock_guard<std::mutex> lock(m);
+    if (broken) return false;
+    e->body = std::move(body);
+    unwritten.push_back(std::move(e));
+    pending = true;
+    return true;
+}
+
+bool Journal::Read(const Extent& e, std::string& out)
+{
+    std::lock_guard<std::mutex> lock(m);
+    if (!e.body.empty()) {
+        out = e.body;
+        return true;
+    }
+    std::ifstream file(path, std::ios::binary);
+    out.resize(e.bytes);
+    file.seekg((std::streamoff)e.offset);
+    file.read(out.data(), (std::streamsize)e.bytes);
+    return (bool)file;
+}
+
+void Journal::Flush()
+{
+    // Copies the waiting bodies out so Read() is not held up by the write
+    std::vector<std::shared_ptr<const Extent>> batch;
+    std::string data;
+    uint64_t at;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (broken) return;
+        for (const auto& w : unwritten)
+            if (auto e = w.lock()) {
+                data += e->body;
+                batch.push_back(std::move(e));
+            }
+        unwritten.clear();
+        at = size;
+    }
+    if (batch.empty()) return;
+    if (at == 0) {
+        data.insert(0, MAGIC, sizeof(MAGIC));
+        data.insert(sizeof(MAGIC), 1, (char)VERSION);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::app);
+    file.write(data.data(), (std::streamsize)data.size());
+    file.flush();
+
+    std::lock_guard<std::mutex> lock(m);
+    // A half-written block would shift every offset after it; the bodies
+    // stay in memory instead
+    if (!file) { broken = true; return; }
+    uint64_t offset = at == 0 ? sizeof(MAGIC) + 1 : at;
+    for (auto& e : batch) {
+        e->offset = offset;
+        offset += e->bytes;
+        e->body.clear();
+        e->body.shrink_to_fit();
+        written.push_back(e);
+    }
+    size = offset;
+}
+
+// Moves the live blocks to a new file once the dead bytes (blocks replaced
+// by flips, unsealed or dropped) pass SLACK and outweigh them
+void Journal::Compact()
+{
+    std::vector<std::shared_ptr<const Extent>> keep;
+    std::filesystem::path old;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if (broken || size == 0) return;
+        uint64_t live = 0;
+        for (const auto& w : written)
+            if (auto e = w.lock()) {
+                live += e->bytes;
+                keep.push_back(std::move(e));
+            }
+        uint64_t dead = size - sizeof(MAGIC) - 1 - live;
+        if (dead < SLACK || dead < live) return;
+        old = path;
+    }
+
+    // Only this thread moves offsets, so they can be read unlocked here
+    std::filesystem::path fresh;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (dir.empty()) return;
+        fresh = NewPathLocked(key);
+    }
+    std::vector<uint64_t> offsets;
+    uint64_t end = sizeof(MAGIC) + 1;
+    {
+        std::ifstream in(old, std::ios::binary);
+        std::ofstream out(fresh, std::ios::binary | std::ios::trunc);
+        out.write(MAGIC, sizeof(MAGIC));
+        out.put((char)VERSION);
+        std::string bytes;
+        for (const auto& e : keep) {
+            bytes.resize(e->bytes);
+            in.seekg((std::streamoff)e->offset);
+            in.read(bytes.data(), (std::streamsize)bytes.size());
+            out.write(bytes.data(), (std::streamsize)bytes.size());
+            offsets.push_back(end);
+            end += e->bytes;
+        }
+        out.flush();
+        if (!in || !out) {
+            out.close();
+            std::error_code ec;
+            std::filesystem::remove(fresh, ec);
+            return;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m);
+        for (size_t i = 0; i < keep.size(); i++) keep[i]->offset = offsets[i];
+        written.assign(keep.begin(), keep.end());
+        path = fresh;
+        size = end;
+    }
+    std::error_code ec;
+    std::filesystem::remove(old, ec);
+}
+
+size_t Resident(const ShotStats& s)
+{
+    return AttemptSpill::HotBytes(s) + s.sealed.ResidentBytes();
+}
+
+} // namespace
+
+template<>
+struct codec::Schema<BlockBody> {
+    static constexpr auto fields = std::make_tuple(
+        Member<BlockBody, std::vector<bool>>{ "history", &BlockBody::history },
+        Member<BlockBody, std::vector<uint32_t>>{ "times", &BlockBody::times }
+    );
+};
+
+// ─── SealedAttempts ───────────────────────────────────────────────────────────
+
+struct SealedAttempts::Block : Extent {
+    int         goals = 0;
+    size_t      timed = 0;
+    TimingStats timing;
+};
+
+struct SealedAttempts::Page : BlockBody {};
+
+std::shared_ptr<const SealedAttempts::Page> SealedAttempts::Load(size_t k) const
+{
+    if (page && pageBlock == k) return page;
+    const Block& b = *blocks[k];
+    auto loaded = std::make_shared<Page>();
+    std::string bytes;
+    size_t pos = 0;
+    if (!b.journal->Read(b, bytes) || !codec::Decode(bytes, pos, static_cast<BlockBody&>(*loaded)) ||
+        loaded->history.size() != AttemptSpill::BLOCK) {
+        // Lost with the file; keep the shape so indices still line up
+        loaded->history.assign(AttemptSpill::BLOCK, false);
+        loaded->times.clear();
+    }
+    page = loaded;
+    pageBlock = k;
+    return page;
+}
+
+bool SealedAttempts::Outcome(size_t i) const
+{
+    return Load(i / AttemptSpill::BLOCK)->history[i % AttemptSpill::BLOCK];
+}
+
+AttemptTime SealedAttempts::Time(size_t i) const
+{
+    size_t k = i / AttemptSpill::BLOCK, local = i % AttemptSpill::BLOCK;
+    if (blocks[k]->timed == 0) return {};
+    auto p = Load(k);
+    // Times cover the newest attempts of the block
+    size_t untimed = AttemptSpill::BLOCK - std::min(AttemptSpill::BLOCK, timing::Count(p->times));
+    return local >= untimed ? timing::At(p->times, local - untimed) : AttemptTime{};
+}
+
+bool SealedAttempts::Flip(size_t i)
+{
+    size_t k = i / AttemptSpill::BLOCK;
+    const Block& b = *blocks[k];
+    auto copy = std::make_shared<Page>(*Load(k));
+    bool wasGoal = copy->history[i % AttemptSpill::BLOCK];
+    copy->history[i % AttemptSpill::BLOCK] = !wasGoal;
+
+    std::string bytes;
+    codec::Encode(bytes, static_cast<const BlockBody&>(*copy));
+    auto block = std::make_shared<Block>();
+    block->journal = b.journal;
+    block->bytes = bytes.size();
+    block->goals = b.goals + (wasGoal ? -1 : 1);
+    block->timed = b.timed;
+    block->timing = b.timing;
+    if (!b.journal->Add(block, std::move(bytes))) return false;
+
+    blocks[k] = std::move(block);
+    page = std::move(copy);
+    pageBlock = k;
+    goals += wasGoal ? -1 : 1;
+    return true;
+}
+
+void SealedAttempts::Unseal(size_t from, std::vector<bool>& history, std::vector<uint32_t>& times)
+{
+    size_t k = from / AttemptSpill::BLOCK;
+    if (k >= blocks.size()) return;
+
+    std::vector<bool> h;
+    std::vector<uint32_t> t;
+    h.reserve((blocks.size() - k) * AttemptSpill::BLOCK + history.size());
+    for (size_t j = k; j < blocks.size(); j++) {
+        auto p = Load(j);
+        h.insert(h.end(), p->history.begin(), p->history.end());
+        t.insert(t.end(), p->times.begin(), p->times.end());
+    }
+    // Sealed times only join up if every hot attempt has times
+    bool joined = timing::Count(times) == history.size();
+    h.insert(h.end(), history.begin(), history.end());
+    history.swap(h);
+    if (joined) {
+        t.insert(t.end(), times.begin(), times.end());
+        times.swap(t);
+    }
+
+    blocks.resize(k);
+    if (pageBlock >= k) page.reset();
+    Recount();
+}
+
+void SealedAttempts::Recount()
+{
+    count = blocks.size() * AttemptSpill::BLOCK;
+    goals = 0;
+    timed = 0;
+    timing = TimingStats();
+    for (const auto& b : blocks) {
+        goals += b->goals;
+        timed += b->timed;
+        timing.Add(b->timing);
+    }
+}
+
+size_t SealedAttempts::DiskBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& b : blocks) bytes += b->bytes;
+    return bytes;
+}
+
+size_t SealedAttempts::ResidentBytes() const
+{
+    size_t bytes = blocks.capacity() * sizeof(blocks[0]) + blocks.size() * sizeof(Block);
+    if (page) bytes += sizeof(Page) + page->history.capacity() / 8 + page->times.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+// ─── AttemptSpill ─────────────────────────────────────────────────────────────
+
+void AttemptSpill::Open(const std::string& folder)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (folder.empty()) return;
+    dir = std::filesystem::path(folder) / "spill";
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    // Only the run that wrote a journal can read it
+    for (const auto& file : std::filesystem::directory_iterator(dir, ec))
+        if (file.path().extension() == ".mtb" || file.path().extension() == ".mtu")
+            std::filesystem::remove(file.path(), ec);
+}
+
+void AttemptSpill::SetBudget(size_t bytes)
+{
+    budget = bytes;
+}
+
+size_t AttemptSpill::Budget()
+{
+    return budget;
+}
+
+std::string AttemptSpill::UndoPath(const std::string& sessionId)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (dir.empty()) return "";
+    return (dir / (SanitizeKey(sessionId) + ".mtu")).string();
+}
+
+size_t AttemptSpill::HotBytes(const ShotStats& s)
+{
+    return s.attemptHistory.capacity() / 8 + s.attemptTimes.capacity() * sizeof(uint32_t);
+}
+
+size_t AttemptSpill::Enforce(ShotTable& shots, const std::string& sessionId)
+{
+    size_t limit = budget;
+    size_t resident = 0;
+    for (const auto& [num, s] : shots) resident += Resident(s);
+    if (resident <= limit) return 0;
+
+    // Decoded pages are the cheapest thing to give back
+    for (auto& [num, s] : shots) {
+        resident -= Resident(s);
+        s.sealed.page.reset();
+        resident += Resident(s);
+    }
+
+    std::shared_ptr<Journal> journal;
+    size_t sealedBlocks = 0;
+    while (resident > limit) {
+        ShotStats* pick = nullptr;
+        for (auto& [num, s] : shots)
+            if (s.attemptHistory.size() >= KEEP + BLOCK && (!pick || s.attemptHistory.size() > pick->attemptHistory.size()))
+                pick = &s;
+        if (!pick) break;
+        if (!journal && !(journal = JournalFor(sessionId))) break;
+
+        ShotStats& s = *pick;
+        auto& h = s.attemptHistory;
+        auto& t = s.attemptTimes;
+        // The block takes whatever times its attempts have, which are the
+        // newest of its BLOCK if the hot times start inside it
+        size_t untimed = h.size() - std::min(h.size(), timing::Count(t));
+        size_t timedHere = untimed < BLOCK ? BLOCK - untimed : 0;
+
+        BlockBody body;
+        body.history.assign(h.begin(), h.begin() + BLOCK);
+        body.times.assign(t.begin(), t.begin() + timedHere * timing::STRIDE);
+        std::string bytes;
+        codec::Encode(bytes, body);
+
+        auto block = std::make_shared<SealedAttempts::Block>();
+        block->journal = journal;
+        block->bytes = bytes.size();
+        block->goals = (int)std::count(body.history.begin(), body.history.end(), true);
+        block->timed = timedHere;
+        block->timing = TimingStats::Of(body.times);
+        if (!journal->Add(block, std::move(bytes))) break;
+
+        size_t before = Resident(s);
+        s.sealed.blocks.push_back(std::move(block));
+        s.sealed.Recount();
+        h.erase(h.begin(), h.begin() + BLOCK);
+        h.shrink_to_fit();
+        t.erase(t.begin(), t.begin() + timedHere * timing::STRIDE);
+        t.shrink_to_fit();
+        resident = resident - before + Resident(s);
+        sealedBlocks++;
+    }
+    return sealedBlocks;
+}
+
+void AttemptSpill::Flush()
+{
+    if (!pending.exchange(false)) return;
+    std::vector<std::shared_ptr<Journal>> open;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& j : journals)
+            if (auto journal = j.lock()) open.push_back(std::move(journal));
+    }
+    for (auto& journal : open) {
+        journal->Flush();
+        journal->Compact();
+    }
+}
+
+bool AttemptSpill::Pending()
+{
+    return pending;
+}
+
+AttemptSpill::Usage AttemptSpill::Measure(const ShotTable& shots)
+{
+    Usage u;
+    for (const auto& [num, s] : shots) {
+        u.hotAttempts += s.attemptHistory.size();
+        u.hotBytes += HotBytes(s);
+        u.sealedAttempts += s.sealed.Size();
+        u.blocks += s.sealed.Blocks();
+        u.residentBytes += Resident(s);
+        u.diskBytes += s.sealed.DiskBytes();
+    }
+    return u;
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include "AttemptTiming.h"
+#include "SessionArena.h"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct ShotStats;
+
+// The oldest attempts of one shot, sealed AttemptSpill::BLOCK at a time into
+// immutable compressed blocks in the session's spill journal. Only a small
+// descriptor per block stays in memory; outcomes and times are read back on
+// demand, with the last block read kept decoded. Copies share the blocks, so
+// a snapshot of the table costs its hot attempts only.
+class SealedAttempts {
+public:
+    size_t Size() const { return count; }
+    bool   Empty() const { return count == 0; }
+    int    Goals() const { return goals; }
+    // Sealed attempts with times, and their figures
+    size_t Timed() const { return timed; }
+    const TimingStats& Timing() const { return timing; }
+
+    // Attempt i < Size(); reads its block unless it is the one kept decoded
+    bool        Outcome(size_t i) const;
+    AttemptTime Time(size_t i) const;
+
+    // Turns attempt i from goal to miss or back in a rewritten copy of its
+    // block; false, with nothing changed, if the journal cannot take it
+    bool Flip(size_t i);
+    // Moves attempts [from, Size()) back in front of history and times,
+    // whole blocks at a time, so a few before `from` may come along
+    void Unseal(size_t from, std::vector<bool>& history, std::vector<uint32_t>& times);
+
+    size_t Blocks() const { return blocks.size(); }
+    size_t DiskBytes() const;
+    // Descriptors plus the decoded block, if any
+    size_t ResidentBytes() const;
+
+private:
+    friend class AttemptSpill;
+    struct Block;
+    struct Page;
+
+    // Block k decoded, through the one-block cache. Every block holds
+    // exactly BLOCK attempts, so attempt i is in block i / BLOCK.
+    std::shared_ptr<const Page> Load(size_t k) const;
+    void Recount();
+
+    std::vector<std::shared_ptr<const Block>> blocks;
+    size_t      count = 0;
+    int         goals = 0;
+    size_t      timed = 0;
+    TimingStats timing;
+    mutable std::shared_ptr<const Page> page;
+    mutable size_t pageBlock = 0;
+};
+
+// Keeps the in-memory part of the shot table under a budget. Every shot
+// holds its newest attempts hot, as plain bits and times the HUD, metrics
+// and edits work on; once the hot attempts of all shots outgrow the budget,
+// the oldest BLOCK of the biggest shot is sealed (see SealedAttempts), and
+// a flip of a sealed attempt makes a corrected copy of its block. Both only
+// encode the block in memory, so the game thread never waits on the disk;
+// Flush(), run as a Scheduler task, writes the bodies out and lets them go,
+// and reads page written blocks back in.
+//
+// Journals live in rl_best_stats\spill, one file per session and run. A
+// journal is deleted once the last block in it is dropped, and Open()
+// clears any a crash left behind; saves and the reload handoff always write
+// every attempt in full, so nothing outlives the run that sealed it. The
+// session log's older undo events sit alongside them (see UndoPath). Blocks
+// replaced by flips or unsealed stay in the file until Flush() finds them
+// outweighing the live ones and copies those to a fresh journal.
+class AttemptSpill {
+public:
+    static constexpr size_t BLOCK = 1024;      // attempts per sealed block
+    static constexpr size_t KEEP = 256;        // hot attempts a shot always keeps
+
+    struct Usage {
+        size_t hotAttempts = 0;
+        size_t hotBytes = 0;
+        size_t sealedAttempts = 0;
+        size_t blocks = 0;
+        size_t residentBytes = 0;   // hot bytes plus block descriptors and pages
+        size_t diskBytes = 0;
+    };
+
+    // Sealing is off until a folder is set
+    static void Open(const std::string& folder);
+    static void SetBudget(size_t bytes);
+    static size_t Budget();
+    // Where SessionLog keeps the session's older undo events; empty while
+    // sealing is off. Open() clears these too.
+    static std::string UndoPath(const std::string& sessionId);
+
+    // Seals the oldest attempts of the shots with the most hot ones until
+    // the table fits the budget, or no shot has KEEP + BLOCK hot attempts.
+    // Returns the number of blocks sealed. Touches no file; see Flush.
+    static size_t Enforce(ShotTable& shots, const std::string& sessionId);
+
+    // Writes the blocks sealed or flipped since the last call and compacts
+    // journals that have gone mostly dead. Safe on any thread.
+    static void Flush();
+    // True once a block is waiting for Flush
+    static bool Pending();
+
+    static Usage Measure(const ShotTable& shots);
+    // Memory the hot attempts of s hold
+    static size_t HotBytes(const ShotStats& s);
+};
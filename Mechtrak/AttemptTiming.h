@@ -0,0 +1,105 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// When one attempt happened, in ms since its session started; 0 where it is
+// not known
+struct AttemptTime {
+    uint32_t start = 0;     // round start (the shot reset)
+    uint32_t touch = 0;     // first car touch, 0 if the ball was never touched
+    uint32_t end = 0;       // the goal, explosion or reset that ended it
+};
+
+// Attempt times are kept flat, three 32-bit values per attempt in the order
+// above (12 bytes an attempt), and cover the most recent attempts of a shot:
+// attempts from before times were recorded simply have none. Free of
+// BakkesMod so the importer and analytics can use it.
+namespace timing {
+
+constexpr size_t STRIDE = 3;
+
+inline size_t Count(const std::vector<uint32_t>& times) { return times.size() / STRIDE; }
+
+inline AttemptTime At(const std::vector<uint32_t>& times, size_t k)
+{
+    return { times[k * STRIDE], times[k * STRIDE + 1], times[k * STRIDE + 2] };
+}
+
+inline void Push(std::vector<uint32_t>& times, const AttemptTime& t)
+{
+    times.insert(times.end(), { t.start, t.touch, t.end });
+}
+
+} // namespace timing
+
+// Time figures over a set of timed attempts. Add() merges figures from the
+// same session, whose offsets share a zero; Fold() adds another session's.
+struct TimingStats {
+    int      timed = 0;         // attempts with a start and an end
+    int      touched = 0;       // of those, the ones with a first touch
+    int64_t  touchMs = 0;       // summed start -> first touch
+    int64_t  durationMs = 0;    // summed start -> end
+    uint32_t firstStart = 0;    // earliest start and latest end in this session,
+    uint32_t lastEnd = 0;       // 0 with nothing timed here
+    int64_t  foldedSpanMs = 0;  // first start -> last end of the sessions folded in
+
+    // Mean seconds from the round start to the first touch
+    float TouchSec() const { return touched > 0 ? (float)(touchMs / 1000.0 / touched) : 0.f; }
+    // Mean seconds from the round start to the result
+    float AttemptSec() const { return timed > 0 ? (float)(durationMs / 1000.0 / timed) : 0.f; }
+    // Practice time the attempts were spread over, gaps between them included
+    int64_t SpanMs() const { return foldedSpanMs + (lastEnd > firstStart ? lastEnd - firstStart : 0); }
+    // Timed attempts per minute of that practice time
+    float PerMinute() const
+    {
+        int64_t span = SpanMs();
+        return span > 0 ? (float)(timed * 60000.0 / span) : 0.f;
+    }
+
+    void Add(const AttemptTime& t)
+    {
+        if (t.start == 0 || t.end < t.start) return;
+        timed++;
+        durationMs += t.end - t.start;
+        if (t.touch >= t.start && t.touch <= t.end) {
+            touched++;
+            touchMs += t.touch - t.start;
+        }
+        firstStart = lastEnd == 0 ? t.start : std::min(firstStart, t.start);
+        lastEnd = std::max(lastEnd, t.end);
+    }
+
+    void Add(const TimingStats& o)
+    {
+        Sum(o);
+        foldedSpanMs += o.foldedSpanMs;
+        if (o.lastEnd == 0) return;
+        firstStart = lastEnd == 0 ? o.firstStart : std::min(firstStart, o.firstStart);
+        lastEnd = std::max(lastEnd, o.lastEnd);
+    }
+
+    void Fold(const TimingStats& o)
+    {
+        Sum(o);
+        foldedSpanMs += o.SpanMs();
+    }
+
+    // One shot's times (see timing::)
+    static TimingStats Of(const std::vector<uint32_t>& times)
+    {
+        TimingStats s;
+        for (size_t k = 0, n = timing::Count(times); k < n; k++) s.Add(timing::At(times, k));
+        return s;
+    }
+
+private:
+    void Sum(const TimingStats& o)
+    {
+        timed += o.timed;
+        touched += o.touched;
+        touchMs += o.touchMs;
+        durationMs += o.durationMs;
+    }
+};
@@ -0,0 +1,376 @@
+#pragma once
+#include "JsonWriter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <type_traits>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+// Compile-time field descriptors. A type opts in by specializing
+// codec::Schema<T> with a constexpr tuple of Member/Computed fields; the JSON
+// writer, the field-level JSON reader and the binary codec below are all
+// generated from that one list, so field names are spelled exactly once.
+//
+// Encoding walks the tuple with a fold expression — no name lookups and no
+// virtual calls. Only JSON reading compares names, once per key.
+
+namespace codec {
+
+template<typename T, typename M>
+struct Member {
+    std::string_view name;
+    M T::* ptr;
+};
+
+// Derived, write-only JSON field (e.g. accuracy). Skipped by the binary codec
+// and by the reader.
+template<typename T, typename R>
+struct Computed {
+    std::string_view name;
+    R (*get)(const T&);
+};
+
+template<typename T> struct Schema;
+
+template<typename T, typename = void>
+struct HasSchema : std::false_type {};
+template<typename T>
+struct HasSchema<T, std::void_t<decltype(Schema<T>::fields)>> : std::true_type {};
+
+template<typename T> struct IsVector : std::false_type {};
+template<typename E, typename A> struct IsVector<std::vector<E, A>> : std::true_type {};
+
+// Vectors of integers other than bool, read element by element like bools
+template<typename T> struct IsIntVector : std::false_type {};
+template<typename E, typename A> struct IsIntVector<std::vector<E, A>>
+    : std::bool_constant<std::is_integral_v<E> && !std::is_same_v<E, bool>> {};
+
+// std::string, or one with another allocator such as std::pmr::string
+template<typename T> struct IsString : std::false_type {};
+template<typename A> struct IsString<std::basic_string<char, std::char_traits<char>, A>> : std::true_type {};
+
+template<typename T> struct IsIntMap : std::false_type {};
+template<typename V, typename C, typename A> struct IsIntMap<std::map<int, V, C, A>> : std::true_type {};
+
+template<typename F> struct IsMember : std::false_type {};
+template<typename T, typename M> struct IsMember<Member<T, M>> : std::true_type {};
+
+template<typename T, typename Fn>
+constexpr void ForEachField(Fn&& fn)
+{
+    std::apply([&](const auto&... f) { (fn(f), ...); }, Schema<T>::fields);
+}
+
+// ── JSON writing ────────────────────────────────────────────────────────────
+
+template<typename V> void WriteJson(JsonWriter& w, const V& v);
+
+// Writes T's fields into an object the caller has already opened
+template<typename T>
+void WriteFields(JsonWriter& w, const T& obj)
+{
+    ForEachField<T>([&](const auto& f) {
+        w.Key(f.name);
+        if constexpr (IsMember<std::decay_t<decltype(f)>>::value) WriteJson(w, obj.*(f.ptr));
+        else WriteJson(w, f.get(obj));
+    });
+}
+
+template<typename V>
+void WriteJson(JsonWriter& w, const V& v)
+{
+    if constexpr (std::is_same_v<V, bool>) w.Bool(v);
+    else if constexpr (std::is_integral_v<V>) w.Int((int64_t)v);
+    else if constexpr (std::is_floating_point_v<V>) w.Float(v);
+    else if constexpr (std::is_convertible_v<const V&, std::string_view>) w.String(v);
+    else if constexpr (std::is_same_v<V, std::vector<bool>>) {
+        w.BeginArray();
+        for (bool e : v) w.Bool(e);
+        w.EndArray();
+    }
+    else if constexpr (IsVector<V>::value) {
+        w.BeginArray();
+        for (const auto& e : v) WriteJson(w, e);
+        w.EndArray();
+    }
+    else if constexpr (IsIntMap<V>::value) {
+        w.BeginObject();
+        for (const auto& [k, e] : v) {
+            char buf[16];
+            auto r = std::to_chars(buf, buf + sizeof(buf), k);
+            w.Key(std::string_view(buf, r.ptr - buf));
+            WriteJson(w, e);
+        }
+        w.EndObject();
+    }
+    else {
+        static_assert(HasSchema<V>::value, "type has no codec::Schema");
+        w.BeginObject();
+        WriteFields(w, v);
+        w.EndObject();
+    }
+}
+
+// ── JSON reading ────────────────────────────────────────────────────────────
+
+// Field-level reader for use inside a JsonHandler: Key() resolves the name
+// to a field index once, then scalar events are assigned straight into the
+// member. A std::vector<bool> or vector-of-integer field takes its array
+// elements as they stream.
+template<typename T>
+class FieldReader {
+public:
+    bool Key(std::string_view key)
+    {
+        field = -1;
+        inArray = false;
+        int i = 0;
+        ForEachField<T>([&](const auto& f) {
+            if (field < 0 && IsMember<std::decay_t<decltype(f)>>::value && f.name == key) field = i;
+            i++;
+        });
+        return field >= 0;
+    }
+
+    bool Int(T& obj, int64_t v)
+    {
+        return Visit(obj, [&](auto& m) {
+            using M = std::decay_t<decltype(m)>;
+            if constexpr (std::is_same_v<M, std::vector<bool>>) { if (inArray) m.push_back(v != 0); }
+            else if constexpr (IsIntVector<M>::value) { if (inArray) m.push_back((typename M::value_type)v); }
+            else if constexpr (std::is_arithmetic_v<M>) m = (M)v;
+        });
+    }
+
+    bool Float(T& obj, double v)
+    {
+        return Visit(obj, [&](auto& m) {
+            using M = std::decay_t<decltype(m)>;
+            if constexpr (std::is_same_v<M, std::vector<bool>>) { if (inArray) m.push_back(v != 0.0); }
+            else if constexpr (IsIntVector<M>::value) { if (inArray) m.push_back((typename M::value_type)v); }
+            else if constexpr (std::is_arithmetic_v<M>) m = (M)v;
+        });
+    }
+
+    bool Bool(T& obj, bool v)
+    {
+        return Visit(obj, [&](auto& m) {
+            using M = std::decay_t<decltype(m)>;
+            if constexpr (std::is_same_v<M, std::vector<bool>>) { if (inArray) m.push_back(v); }
+            else if constexpr (std::is_arithmetic_v<M>) m = (M)v;
+        });
+    }
+
+    bool String(T& obj, std::string_view v)
+    {
+        return Visit(obj, [&](auto& m) {
+            using M = std::decay_t<decltype(m)>;
+            if constexpr (std::is_same_v<M, std::string>) m.assign(v);
+        });
+    }
+
+    // True if the current field is an array field; its old contents are dropped
+    bool BeginArray(T& obj)
+    {
+        Visit(obj, [&](auto& m) {
+            using M = std::decay_t<decltype(m)>;
+            if constexpr (std::is_same_v<M, std::vector<bool>> || IsIntVector<M>::value) { m.clear(); inArray = true; }
+        });
+        return inArray;
+    }
+
+    void EndArray() { inArray = false; field = -1; }
+    bool InArray() const { return inArray; }
+
+private:
+    int  field = -1;
+    bool inArray = false;
+
+    template<typename Fn>
+    bool Visit(T& obj, Fn&& fn)
+    {
+        if (field < 0) return false;
+        int i = 0;
+        ForEachField<T>([&](const auto& f) {
+            if constexpr (IsMember<std::decay_t<decltype(f)>>::value)
+                if (i == field) fn(obj.*(f.ptr));
+            i++;
+        });
+        return true;
+    }
+};
+
+// ── Binary codec ────────────────────────────────────────────────────────────
+// Unsigned ints are LEB128 varints, signed ints zigzag varints, floats raw
+// little-endian, strings and containers length-prefixed, bool vectors packed
+// eight per byte. Vectors of uint32_t (attempt times) store each element as
+// the zigzag difference from the one before, which keeps mostly increasing
+// millisecond offsets to a byte or two apiece. Fields are positional, so the
+// schema order is the format.
+
+inline void PutVarint(std::string& out, uint64_t v)
+{
+    while (v >= 0x80) { out.push_back((char)(v | 0x80)); v >>= 7; }
+    out.push_back((char)v);
+}
+
+inline bool GetVarint(std::string_view in, size_t& pos, uint64_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t b = (uint8_t)in[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+inline uint64_t ZigZag(int64_t v)   { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+inline int64_t  UnZigZag(uint64_t v){ return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+template<typename V> void Encode(std::string& out, const V& v);
+template<typename V> bool Decode(std::string_view in, size_t& pos, V& v);
+
+template<typename T>
+void EncodeFields(std::string& out, const T& obj)
+{
+    ForEachField<T>([&](const auto& f) {
+        if constexpr (IsMember<std::decay_t<decltype(f)>>::value) Encode(out, obj.*(f.ptr));
+    });
+}
+
+template<typename T>
+bool DecodeFields(std::string_view in, size_t& pos, T& obj)
+{
+    bool ok = true;
+    ForEachField<T>([&](const auto& f) {
+        if constexpr (IsMember<std::decay_t<decltype(f)>>::value)
+            if (ok) ok = Decode(in, pos, obj.*(f.ptr));
+    });
+    return ok;
+}
+
+template<typename V>
+void Encode(std::string& out, const V& v)
+{
+    if constexpr (std::is_same_v<V, bool>) out.push_back(v ? 1 : 0);
+    else if constexpr (std::is_integral_v<V> && std::is_signed_v<V>) PutVarint(out, ZigZag((int64_t)v));
+    else if constexpr (std::is_integral_v<V>) PutVarint(out, (uint64_t)v);
+    else if constexpr (std::is_floating_point_v<V>) {
+        char buf[sizeof(V)];
+        std::memcpy(buf, &v, sizeof(V));
+        out.append(buf, sizeof(V));
+    }
+    else if constexpr (IsString<V>::value) {
+        PutVarint(out, v.size());
+        out.append(v);
+    }
+    else if constexpr (std::is_same_v<V, std::vector<bool>>) {
+        PutVarint(out, v.size());
+        uint8_t byte = 0;
+        for (size_t i = 0; i < v.size(); i++) {
+            if (v[i]) byte |= (uint8_t)(1u << (i & 7));
+            if ((i & 7) == 7) { out.push_back((char)byte); byte = 0; }
+        }
+        if (v.size() & 7) out.push_back((char)byte);
+    }
+    else if constexpr (std::is_same_v<V, std::vector<uint32_t>>) {
+        PutVarint(out, v.size());
+        uint32_t prev = 0;
+        for (uint32_t e : v) { PutVarint(out, ZigZag((int64_t)e - prev)); prev = e; }
+    }
+    else if constexpr (IsVector<V>::value) {
+        PutVarint(out, v.size());
+        for (const auto& e : v) Encode(out, e);
+    }
+    else if constexpr (IsIntMap<V>::value) {
+        PutVarint(out, v.size());
+        for (const auto& [k, e] : v) { Encode(out, k); Encode(out, e); }
+    }
+    else {
+        static_assert(HasSchema<V>::value, "type has no codec::Schema");
+        EncodeFields(out, v);
+    }
+}
+
+template<typename V>
+bool Decode(std::string_view in, size_t& pos, V& v)
+{
+    if constexpr (std::is_same_v<V, bool>) {
+        if (pos >= in.size()) return false;
+        v = in[pos++] != 0;
+        return true;
+    }
+    else if constexpr (std::is_integral_v<V>) {
+        uint64_t raw;
+        if (!GetVarint(in, pos, raw)) return false;
+        if constexpr (std::is_signed_v<V>) v = (V)UnZigZag(raw);
+        else v = (V)raw;
+        return true;
+    }
+    else if constexpr (std::is_floating_point_v<V>) {
+        if (in.size() - pos < sizeof(V)) return false;
+        std::memcpy(&v, in.data() + pos, sizeof(V));
+        pos += sizeof(V);
+        return true;
+    }
+    else if constexpr (IsString<V>::value) {
+        uint64_t len;
+        if (!GetVarint(in, pos, len) || len > in.size() - pos) return false;
+        v.assign(in.data() + pos, (size_t)len);
+        pos += (size_t)len;
+        return true;
+    }
+    else if constexpr (std::is_same_v<V, std::vector<bool>>) {
+        uint64_t len;
+        if (!GetVarint(in, pos, len)) return false;
+        size_t nBytes = (size_t)((len + 7) / 8);
+        if (nBytes > in.size() - pos) return false;
+        v.resize((size_t)len);
+        for (size_t i = 0; i < len; i++)
+            v[i] = ((uint8_t)in[pos + (i >> 3)] >> (i & 7)) & 1;
+        pos += nBytes;
+        return true;
+    }
+    else if constexpr (std::is_same_v<V, std::vector<uint32_t>>) {
+        uint64_t n;
+        if (!GetVarint(in, pos, n) || n > in.size() - pos) return false;
+        v.resize((size_t)n);
+        int64_t prev = 0;
+        for (auto& e : v) {
+            uint64_t raw;
+            if (!GetVarint(in, pos, raw)) return false;
+            prev += UnZigZag(raw);
+            e = (uint32_t)prev;
+        }
+        return true;
+    }
+    else if constexpr (IsVector<V>::value) {
+        uint64_t n;
+        if (!GetVarint(in, pos, n) || n > in.size() - pos) return false;
+        v.clear();
+        v.resize((size_t)n);
+        for (auto& e : v) if (!Decode(in, pos, e)) return false;
+        return true;
+    }
+    else if constexpr (IsIntMap<V>::value) {
+        uint64_t n;
+        if (!GetVarint(in, pos, n) || n > in.size() - pos) return false;
+        v.clear();
+        for (uint64_t i = 0; i < n; i++) {
+            int k;
+            if (!Decode(in, pos, k) || !Decode(in, pos, v[k])) return false;
+        }
+        return true;
+    }
+    else {
+        static_assert(HasSchema<V>::value, "type has no codec::Schema");
+        return DecodeFields(in, pos, v);
+    }
+}
+
+} // namespace codec
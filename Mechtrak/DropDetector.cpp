@@ -0,0 +1,33 @@
+#include "DropDetector.h"
+#include <algorithm>
+#include <cmath>
+
+void DropDetector::Add(bool goal)
+{
+    if (baseAttempts < MIN_BASELINE) {
+        baseAttempts++;
+        baseGoals += goal;
+        return;
+    }
+
+    double n = baseAttempts, p = Before(), z2n = BASELINE_Z * BASELINE_Z / n;
+    double low = (p + z2n / 2.0 - BASELINE_Z * std::sqrt(p * (1.0 - p) / n + z2n / (4.0 * n))) / (1.0 + z2n);
+    // Kept away from 0 and 1 so a perfect or hopeless start still scores
+    double p0 = std::clamp(low, 0.05, 0.95);
+    double odds = p0 / (1.0 - p0) * ODDS_RATIO;
+    double p1 = odds / (1.0 + odds);
+
+    score += goal ? std::log(p1 / p0) : std::log((1.0 - p1) / (1.0 - p0));
+    // Capped, so a long slump can still clear once play recovers
+    score = std::min(score, 2.0 * THRESHOLD);
+    runAttempts++;
+    runGoals += goal;
+
+    if (score <= 0.0) {
+        // Excursion over: those attempts were ordinary after all
+        score = 0.0;
+        baseAttempts += runAttempts;
+        baseGoals += runGoals;
+        runAttempts = runGoals = 0;
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+// One-sided Bernoulli CUSUM that flags a fall in success rate. The baseline
+// is the accuracy over every attempt outside the current excursion. Each
+// attempt adds the log-likelihood ratio of "the odds of scoring halved"
+// against that baseline, and the sum is floored at 0. Past THRESHOLD the
+// stream has dropped, starting where the sum last left 0.
+//
+// The baseline is taken at the low end of its 1.5 sigma Wilson interval, so
+// a lucky first few dozen attempts do not make ordinary play look like a
+// slump. State is a handful of counters; an update is a few flops and a log.
+class DropDetector {
+public:
+    static constexpr int    MIN_BASELINE = 30;    // attempts before anything is flagged
+    static constexpr double ODDS_RATIO = 0.5;     // the fall the test is tuned for
+    static constexpr double THRESHOLD = 5.0;
+    static constexpr double BASELINE_Z = 1.5;
+
+    void Add(bool goal);
+    void Reset() { *this = DropDetector(); }
+
+    bool  Dropped() const { return score >= THRESHOLD; }
+    float Before() const { return baseAttempts > 0 ? (float)baseGoals / baseAttempts : 0.f; }
+    float Since() const { return runAttempts > 0 ? (float)runGoals / runAttempts : 0.f; }
+    // Attempts since the estimated change point, 0 outside an excursion
+    int   Length() const { return runAttempts; }
+    double Score() const { return score; }
+
+private:
+    double score = 0.0;
+    int    baseAttempts = 0;
+    int    baseGoals = 0;
+    int    runAttempts = 0;
+    int    runGoals = 0;
+};
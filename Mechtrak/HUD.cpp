@@ -1,7 +1,16 @@
 ﻿#include "pch.h"
 #include "HUD.h"
+#include "SessionAggregates.h"
+#include "LiveMetrics.h"
+#include "TrendGraph.h"
+#include "ShotGrid.h"
+#include "SessionTimeline.h"
+#include "imgui/imgui_timeline.h"
+#include "Analytics.h"
+#include "HistoryKernels.h"
 #include "imgui/imgui.h"
 #include <cmath>
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 
@@ -48,8 +57,8 @@ void HUD::Render(
     CanvasWrapper& canvas,
     std::shared_ptr<CVarManagerWrapper> cvarManager,
     std::shared_ptr<GameWrapper> gameWrapper,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes,
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
     int currentShotNumber,
     bool sessionActive)
 {
@@ -61,16 +70,23 @@ void HUD::Render(
 void HUD::RenderImGui(
     std::shared_ptr<CVarManagerWrapper> cvarManager,
     std::shared_ptr<GameWrapper> gameWrapper,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes,
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
+    const SessionAggregates& aggregates,
+    const LiveMetrics& metrics,
+    const TrendGraph& trend,
+    ShotGrid& grid,
     int currentShotNumber,
     bool sessionActive,
     bool& showEditPanel,
     std::function<void()> onEndSession,
-    std::function<void(int, int, int)> onEditShot)
+    std::function<void(int, int, int)> onEditShot,
+    std::function<void(int)> onSelectShot)
 {
     auto hideCvar = cvarManager->getCvar("mechtrak_hide_hud");
     if (hideCvar && hideCvar.getBoolValue()) return;
+    auto graphCvar = cvarManager->getCvar("mechtrak_remove_graph");
+    bool showGraph = !(graphCvar && graphCvar.getBoolValue());
 
     if (!gameWrapper->IsInCustomTraining() && sessionActive) return;
 
@@ -119,6 +135,7 @@ void HUD::RenderImGui(
     ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
     ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, { 0, 4 });
 
+    float hudH = 0.f;
     bool hudOpen = ImGui::Begin("##MechTrakHUD", nullptr, hudFlags);
     if (hudOpen) {
         ImDrawList* dl = ImGui::GetWindowDrawList();
@@ -126,14 +143,23 @@ void HUD::RenderImGui(
         ImFont* fnt = ImGui::GetFont();
         const float FS = fnt->FontSize;
 
-        ShotStats cur;
-        if (shotStats.count(currentShotNumber)) cur = shotStats[currentShotNumber];
-        float curAcc = cur.attempts > 0 ? (float)cur.goals / cur.attempts : 0.f;
+        const Tally& cur = aggregates.Shot(currentShotNumber);
+        float curAcc = cur.Accuracy();
 
         std::string shotType;
         if (shotTypes.count(currentShotNumber)) shotType = shotTypes[currentShotNumber];
 
-        const float PANEL_H = sessionActive ? 220.f : 115.f;
+        // A drop on this shot, or else across the session, gets its own line
+        RollingStats form = metrics.Shot(currentShotNumber);
+        RollingStats sessionForm = metrics.Session();
+        const RollingStats* drop = form.dropped ? &form : sessionForm.dropped ? &sessionForm : nullptr;
+        // Shots played before attempts were timed have no timing line
+        const TimingStats& times = aggregates.ShotTiming(currentShotNumber);
+
+        const float GRAPH_H = 44.f;
+        const float PANEL_H = sessionActive ? (drop ? 284.f : 262.f) + (times.timed > 0 ? 18.f : 0.f) +
+            (showGraph ? GRAPH_H + 26.f : 0.f) : 115.f;
+        hudH = PANEL_H;
         dl->AddRectFilled(wp, { wp.x + PW, wp.y + PANEL_H }, cBg, 14.f);
         dl->AddRect(wp, { wp.x + PW, wp.y + PANEL_H }, cBorder, 14.f, 0, 1.f);
         dl->AddRect({ wp.x + 1, wp.y + 1 }, { wp.x + PW - 1, wp.y + PANEL_H - 1 }, IM_COL32(255, 255, 255, 7), 14.f, 0, 1.f);
@@ -202,15 +228,144 @@ void HUD::RenderImGui(
                 drawStat(FmtNum(cur.attempts), "ATTEMPTS", sy + GAP * 2.f);
                 ImGui::Dummy({ PW, PR * 2.f + 16.f });
             }
+            // recent form: last 10/25/50 bars, then streak, trend and range
+            {
+                float cy = ImGui::GetCursorPosY();
+                const RollingStats& r = form;
+                auto pct = [](float f) { return std::to_string((int)(f * 100)) + "%"; };
+                const float LS = FS * 0.72f;
+                const float BW = (PW - PAD * 2.f - 16.f) / 3.f;
+                const char* labels[3] = { "LAST 10", "LAST 25", "LAST 50" };
+                const float windows[3] = { r.last10, r.last25, r.last50 };
+                for (int k = 0; k < 3; k++) {
+                    float bx = wp.x + PAD + k * (BW + 8.f), by = wp.y + cy;
+                    std::string lbl = std::string(labels[k]) + "  " + pct(windows[k]);
+                    dl->AddText(fnt, LS, { bx, by }, cSub, lbl.c_str());
+                    DrawProgressBar(dl, { bx, by + LS + 3.f }, BW, 4.f, windows[k], IM_COL32(255, 255, 255, 18),
+                        windows[k] >= 0.5f ? cGreen : IM_COL32(220, 150, 40, 255), 2.f);
+                }
+                std::string line = "STREAK " + std::to_string(r.streak) + "  BEST " + std::to_string(r.bestStreak) +
+                    "  TREND " + pct(r.ewma) + "  RANGE " + pct(r.wilsonLow) + "-" + pct(r.wilsonHigh);
+                dl->AddText(fnt, LS, { wp.x + PAD, wp.y + cy + LS + 14.f }, cSub, line.c_str());
+                ImGui::Dummy({ PW, LS * 2.f + 18.f });
+
+                if (times.timed > 0) {
+                    char buf[64];
+                    if (times.touched > 0)
+                        snprintf(buf, sizeof(buf), "TOUCH %.1fs  LENGTH %.1fs  %.1f/MIN", times.TouchSec(), times.AttemptSec(), times.PerMinute());
+                    else
+                        snprintf(buf, sizeof(buf), "TOUCH -  LENGTH %.1fs  %.1f/MIN", times.AttemptSec(), times.PerMinute());
+                    dl->AddText(fnt, LS, { wp.x + PAD, wp.y + ImGui::GetCursorPosY() - 4.f }, cSub, buf);
+                    ImGui::Dummy({ PW, 18.f });
+                }
+
+                if (drop) {
+                    std::string warn = std::string(drop == &form ? "SHOT" : "SESSION") + " DROPPING: " +
+                        pct(drop->dropFrom) + " -> " + pct(drop->dropTo) + " OVER LAST " + std::to_string(drop->dropLength);
+                    dl->AddText(fnt, FS * 0.78f, { wp.x + PAD, wp.y + ImGui::GetCursorPosY() }, IM_COL32(255, 140, 65, 255), warn.c_str());
+                    ImGui::Dummy({ PW, 22.f });
+                }
+            }
+            // trend: rolling accuracy over every attempt of this shot, already
+            // cut down to TrendGraph::BUDGET points
+            if (showGraph) {
+                float cy = ImGui::GetCursorPosY();
+                const float LS = FS * 0.72f;
+                size_t n = trend.Attempts(currentShotNumber);
+                std::string lbl = "TREND  LAST " + std::to_string(TrendGraph::WINDOW) + " OVER " + std::to_string(n) +
+                    (n == 1 ? " ATTEMPT" : " ATTEMPTS");
+                dl->AddText(fnt, LS, { wp.x + PAD, wp.y + cy }, cSub, lbl.c_str());
+
+                ImVec2 g0 = { wp.x + PAD, wp.y + cy + LS + 4.f };
+                ImVec2 g1 = { wp.x + PW - PAD, g0.y + GRAPH_H };
+                dl->AddRectFilled(g0, g1, cPillBg, 4.f);
+                float mid = g1.y - GRAPH_H * 0.5f;
+                dl->AddLine({ g0.x, mid }, { g1.x, mid }, IM_COL32(255, 255, 255, 22), 1.f);
+
+                const auto& pts = trend.Points(currentShotNumber);
+                if (!pts.empty()) {
+                    static std::vector<ImVec2> line;
+                    line.clear();
+                    float sx = (g1.x - g0.x - 4.f) / (float)(n - 1);
+                    for (const auto& p : pts)
+                        line.push_back({ g0.x + 2.f + p.x * sx, g1.y - 2.f - p.y * (GRAPH_H - 4.f) });
+                    dl->AddPolyline(line.data(), (int)line.size(), pts.back().y >= 0.5f ? cGreen : IM_COL32(220, 150, 40, 255), false, 1.5f);
+                }
+                ImGui::Dummy({ PW, LS + GRAPH_H + 18.f });
+            }
             ImGui::Dummy({ PW, 14.f });
         }
     }
     ImGui::End();
     ImGui::PopStyleVar(3);
 
-    // ── Window 2: edit panel (receives mouse input) ───────────────────────
     if (!showEditPanel || !sessionActive) return;
 
+    // ── Window 2: shot grid under the HUD (receives mouse input) ─────────
+    auto gridCvar = cvarManager->getCvar("mechtrak_show_grid");
+    if (!gridCvar || gridCvar.getBoolValue()) {
+        const int   NTILES = (int)shotStats.size();
+        const ImVec2 GS = ShotGrid::Size(NTILES);
+        const float GHDR = 24.f;
+        const float GH = GHDR + GS.y + 30.f;
+
+        ImGuiWindowFlags gridFlags =
+            ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+            ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse |
+            ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+            ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoFocusOnAppearing;
+
+        ImGui::SetNextWindowPos({ winX, winY + hudH + 10.f }, ImGuiCond_Always);
+        ImGui::SetNextWindowSize({ PW, GH }, ImGuiCond_Always);
+        ImGui::SetNextWindowBgAlpha(0.f);
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { 0, 0 });
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+
+        if (ImGui::Begin("##MechTrakGrid", nullptr, gridFlags)) {
+            ImDrawList* dl = ImGui::GetWindowDrawList();
+            ImVec2      wp = ImGui::GetWindowPos();
+            ImFont* fnt = ImGui::GetFont();
+            const float FS = fnt->FontSize;
+            const float LS = FS * 0.72f;
+
+            dl->AddRectFilled(wp, { wp.x + PW, wp.y + GH }, cBg, 14.f);
+            dl->AddRect(wp, { wp.x + PW, wp.y + GH }, cBorder, 14.f, 0, 1.f);
+            std::string title = "PACK  " + std::to_string(NTILES) + (NTILES == 1 ? " SHOT" : " SHOTS");
+            dl->AddText(fnt, LS, { wp.x + PAD, wp.y + (GHDR - LS) * 0.5f + 2.f }, cSub, title.c_str());
+
+            ImVec2 go = { wp.x + (PW - GS.x) * 0.5f, wp.y + GHDR };
+            grid.Draw(dl, go, shotStats, aggregates);
+
+            ImVec2 mouse = ImGui::GetIO().MousePos;
+            int hovered = ImGui::IsWindowHovered() ? grid.HitTest({ mouse.x - go.x, mouse.y - go.y }) : 0;
+            ImVec2 t;
+            if (grid.TileOf(currentShotNumber, t))
+                dl->AddRect({ go.x + t.x - 1.f, go.y + t.y - 1.f }, { go.x + t.x + ShotGrid::TILE + 1.f, go.y + t.y + ShotGrid::TILE + 1.f },
+                    cWhite, 0.f, 0, 2.f);
+            if (hovered && grid.TileOf(hovered, t))
+                dl->AddRect({ go.x + t.x, go.y + t.y }, { go.x + t.x + ShotGrid::TILE, go.y + t.y + ShotGrid::TILE },
+                    IM_COL32(255, 255, 255, 150), 0.f, 0, 1.f);
+            if (hovered && ImGui::IsMouseClicked(0) && onSelectShot) onSelectShot(hovered);
+
+            // the hovered shot, or else the current one
+            int shown = hovered ? hovered : currentShotNumber;
+            const Tally& st = aggregates.Shot(shown);
+            std::string info = "SHOT " + std::to_string(shown);
+            if (shotTypes.count(shown) && !shotTypes[shown].empty()) {
+                std::string up(shotTypes[shown]);
+                for (auto& c : up) c = (char)toupper((unsigned char)c);
+                info += ": " + up;
+            }
+            info += "  " + std::to_string((int)(st.Accuracy() * 100)) + "%  " +
+                std::to_string(st.goals) + "/" + std::to_string(st.attempts);
+            dl->AddText(fnt, LS, { wp.x + PAD, go.y + GS.y + 10.f }, IM_COL32(195, 220, 255, 215), info.c_str());
+        }
+        ImGui::End();
+        ImGui::PopStyleVar(2);
+    }
+
+    // ── Window 3: edit panel (receives mouse input) ──────────────────────
+
     // Layout constants — column positions
     // [SHOT NAME 12..190] [G- 198] [G val 224] [G+ 242] [A- 290] [A val 316] [A+ 334]
     const float EPW = 370.f;
@@ -327,7 +482,7 @@ void HUD::RenderImGui(
             dl->AddText(fnt, FS * 0.88f, { wp.x + 12.f, wp.y + rcy }, IM_COL32(195, 220, 255, 215), sLabel.c_str());
 
             // accuracy bar (thin strip at bottom of row)
-            float acc = s.attempts > 0 ? (float)s.goals / s.attempts : 0.f;
+            float acc = aggregates.Shot(shotNum).Accuracy();
             float bx = wp.x + 12.f, by2 = wp.y + ry + ROW - 5.f, barW = NAME_MAX_X - 12.f;
             dl->AddRectFilled({ bx, by2 }, { bx + barW, by2 + 3.f }, IM_COL32(255, 255, 255, 18), 2.f);
             if (acc > 0.f)
@@ -381,22 +536,233 @@ void HUD::RenderImGui(
     ImGui::PopStyleVar(4);
 }
 
+// ─── Session Timeline ─────────────────────────────────────────────────────────
+
+void HUD::RenderTimeline(SessionTimeline& timeline, const ShotTable& shotStats, uint32_t nowMs)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    const float TW = 720.f;
+    const float TH = 240.f;
+    const float HDR = 34.f;
+    const float PAD = 12.f;
+
+    const ImU32 cBg = IM_COL32(0, 0, 0, 242);
+    const ImU32 cHdr = IM_COL32(8, 25, 70, 235);
+    const ImU32 cBorder = IM_COL32(70, 130, 255, 40);
+    const ImU32 cWhite = IM_COL32(255, 255, 255, 255);
+    const ImU32 cSub = IM_COL32(150, 185, 255, 175);
+
+    auto& view = timeline.view;
+    const uint32_t total = std::max(nowMs, timeline.LastMs());
+    if (view.follow) {
+        view.start = 0;
+        view.span = std::max(total, SessionTimeline::MIN_SPAN);
+    }
+
+    ImGuiWindowFlags flags =
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse |
+        ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoFocusOnAppearing |
+        ImGuiWindowFlags_NoScrollWithMouse;
+
+    ImGui::SetNextWindowPos({ (io.DisplaySize.x - TW) * 0.5f, io.DisplaySize.y * 0.62f }, ImGuiCond_Always);
+    ImGui::SetNextWindowSize({ TW, TH }, ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.f);
+    // The padding keeps the track child off the rounded border
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { PAD, PAD });
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+    ImGui::PushStyleVar(ImGuiStyleVar_ChildBorderSize, 0.f);
+
+    if (ImGui::Begin("##MechTrakTimeline", nullptr, flags)) {
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        ImVec2      wp = ImGui::GetWindowPos();
+        ImFont* fnt = ImGui::GetFont();
+        const float FS = fnt->FontSize;
+
+        dl->AddRectFilled(wp, { wp.x + TW, wp.y + TH }, cBg, 14.f);
+        dl->AddRect(wp, { wp.x + TW, wp.y + TH }, cBorder, 14.f, 0, 1.f);
+        dl->AddRectFilled(wp, { wp.x + TW, wp.y + HDR }, cHdr, 14.f);
+        dl->AddRectFilled({ wp.x, wp.y + HDR * 0.5f }, { wp.x + TW, wp.y + HDR }, cHdr, 0.f);
+        dl->AddLine({ wp.x, wp.y + HDR }, { wp.x + TW, wp.y + HDR }, IM_COL32(120, 170, 255, 65), 1.f);
+
+        auto clock = [](uint32_t ms) {
+            char buf[16];
+            uint32_t s = ms / 1000;
+            if (s >= 3600) snprintf(buf, sizeof(buf), "%u:%02u:%02u", s / 3600, s / 60 % 60, s % 60);
+            else snprintf(buf, sizeof(buf), "%u:%02u", s / 60, s % 60);
+            return std::string(buf);
+            };
+        std::string title = "SESSION TIMELINE  " + clock(view.start) + " - " + clock(view.start + view.span);
+        dl->AddText(fnt, FS, { wp.x + PAD, wp.y + (HDR - FS) * 0.5f }, cWhite, title.c_str());
+        const char* HINT = "WHEEL ZOOM  DRAG PAN  DOUBLE-CLICK FIT";
+        ImVec2 hSz = fnt->CalcTextSizeA(FS * 0.72f, FLT_MAX, 0, HINT);
+        dl->AddText(fnt, FS * 0.72f, { wp.x + TW - hSz.x - PAD, wp.y + (HDR - FS * 0.72f) * 0.5f }, cSub, HINT);
+
+        // Track: the vendored timeline draws the child and the minute axis
+        // (minutes from the left edge); attempts are drawn straight into it
+        ImGui::SetCursorPos({ PAD, HDR + 8.f });
+        ImGui::PushStyleColor(ImGuiCol_ChildBg, IM_COL32(0, 0, 0, 0));
+        ImGui::PushStyleColor(ImGuiCol_Button, IM_COL32(255, 255, 255, 10));
+        ImGui::PushStyleColor(ImGuiCol_Border, IM_COL32(70, 100, 200, 60));
+        ImGui::PushStyleColor(ImGuiCol_Text, cSub);
+        if (ImGui::BeginTimeline("##MechTrakTimelineTrack", view.span / 60000.f)) {
+            ImDrawList* tdl = ImGui::GetWindowDrawList();
+            ImVec2 tp = ImGui::GetWindowPos();
+            ImVec2 t0 = { tp.x + ImGui::GetWindowContentRegionMin().x, tp.y + ImGui::GetWindowContentRegionMin().y };
+            ImVec2 t1 = { tp.x + ImGui::GetWindowContentRegionMax().x,
+                tp.y + ImGui::GetWindowContentRegionMax().y - ImGui::GetTextLineHeightWithSpacing() };
+            timeline.Draw(tdl, t0, t1, shotStats);
+
+            if (ImGui::IsWindowHovered()) {
+                const float W = t1.x - t0.x;
+                uint32_t at = view.start + (uint32_t)std::clamp((io.MousePos.x - t0.x) / W * view.span, 0.f, (float)view.span);
+                if (io.MouseWheel != 0.f) timeline.Zoom(powf(0.8f, io.MouseWheel), at, total);
+                if (ImGui::IsMouseDoubleClicked(0)) view.follow = true;
+                else if (ImGui::IsMouseDragging(0) && io.MouseDelta.x != 0.f)
+                    timeline.Pan((int64_t)(-io.MouseDelta.x / W * view.span), total);
+            }
+        }
+        float now = nowMs >= view.start && nowMs <= view.start + view.span ? (nowMs - view.start) / 60000.f : -1.f;
+        ImGui::EndTimeline(now);
+        ImGui::PopStyleColor(4);
+    }
+    ImGui::End();
+    ImGui::PopStyleVar(3);
+}
+
+// ─── Analytics Panel ──────────────────────────────────────────────────────────
+
+void HUD::RenderAnalytics(const AnalyticsReport* report, bool running, size_t filesDone, size_t filesTotal)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    const float AW = 560.f;
+    const float HDR = 34.f;
+    const float ROW = 30.f;
+    const float COLS_Y = HDR + 8.f;
+    const float ROWS_START = COLS_Y + 20.f;
+    const float PAD = 12.f;
+    // [TYPE 12] [SESSIONS 150] [ACC 215] [P10..P90 265..375] [CONSIST 390] [CURVE 450..548]
+    const float X_SESS = 150.f, X_ACC = 215.f, X_RANGE = 265.f, RANGE_W = 110.f;
+    const float X_CONS = 390.f, X_CURVE = 450.f, CURVE_W = AW - X_CURVE - PAD;
+
+    const ImU32 cBg = IM_COL32(0, 0, 0, 242);
+    const ImU32 cHdr = IM_COL32(8, 25, 70, 235);
+    const ImU32 cBorder = IM_COL32(70, 130, 255, 40);
+    const ImU32 cWhite = IM_COL32(255, 255, 255, 255);
+    const ImU32 cSub = IM_COL32(150, 185, 255, 175);
+    const ImU32 cGreen = IM_COL32(50, 200, 100, 255);
+    const ImU32 cLine = IM_COL32(120, 170, 255, 230);
+
+    const int NTYPES = report ? (int)report->types.size() : 0;
+    const float AH = ROWS_START + std::max(NTYPES, 1) * ROW + 26.f;
+
+    ImGuiWindowFlags flags =
+        ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+        ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse |
+        ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+        ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoNav |
+        ImGuiWindowFlags_NoFocusOnAppearing;
+
+    ImGui::SetNextWindowPos({ (io.DisplaySize.x - AW) * 0.5f, io.DisplaySize.y * 0.08f }, ImGuiCond_Always);
+    ImGui::SetNextWindowSize({ AW, AH }, ImGuiCond_Always);
+    ImGui::SetNextWindowBgAlpha(0.f);
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { 0, 0 });
+    ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+
+    if (ImGui::Begin("##MechTrakAnalytics", nullptr, flags)) {
+        ImDrawList* dl = ImGui::GetWindowDrawList();
+        ImVec2      wp = ImGui::GetWindowPos();
+        ImFont* fnt = ImGui::GetFont();
+        const float FS = fnt->FontSize;
+
+        dl->AddRectFilled(wp, { wp.x + AW, wp.y + AH }, cBg, 14.f);
+        dl->AddRect(wp, { wp.x + AW, wp.y + AH }, cBorder, 14.f, 0, 1.f);
+        dl->AddRectFilled(wp, { wp.x + AW, wp.y + HDR }, cHdr, 14.f);
+        dl->AddRectFilled({ wp.x, wp.y + HDR * 0.5f }, { wp.x + AW, wp.y + HDR }, cHdr, 0.f);
+        dl->AddLine({ wp.x, wp.y + HDR }, { wp.x + AW, wp.y + HDR }, IM_COL32(120, 170, 255, 65), 1.f);
+
+        std::string title = "ALL-TIME ANALYTICS";
+        if (report) title += "  -  " + FmtNum((int)(report->files - report->skipped)) + " SESSIONS";
+        ImVec2 tSz = fnt->CalcTextSizeA(FS, FLT_MAX, 0, title.c_str());
+        dl->AddText(fnt, FS, { wp.x + (AW - tSz.x) * 0.5f, wp.y + (HDR - tSz.y) * 0.5f }, cWhite, title.c_str());
+
+        float hy = wp.y + COLS_Y;
+        dl->AddText(fnt, FS * 0.72f, { wp.x + PAD, hy }, cSub, "SHOT TYPE");
+        dl->AddText(fnt, FS * 0.72f, { wp.x + X_SESS, hy }, cSub, "SESSIONS");
+        dl->AddText(fnt, FS * 0.72f, { wp.x + X_ACC, hy }, cSub, "ACC");
+        dl->AddText(fnt, FS * 0.72f, { wp.x + X_RANGE, hy }, cSub, "P10 - P50 - P90");
+        dl->AddText(fnt, FS * 0.72f, { wp.x + X_CONS, hy }, cSub, "CONSIST");
+        dl->AddText(fnt, FS * 0.72f, { wp.x + X_CURVE, hy }, cSub, "LEARNING CURVE");
+        dl->AddLine({ wp.x + 8.f, hy + 13.f }, { wp.x + AW - 8.f, hy + 13.f }, IM_COL32(70, 100, 200, 60), 1.f);
+
+        auto pct = [](float f) { return std::to_string((int)std::lround(f * 100.f)) + "%"; };
+
+        if (NTYPES == 0) {
+            const char* msg = running ? "Reading session files..." : "No saved sessions found";
+            dl->AddText(fnt, FS, { wp.x + PAD, wp.y + ROWS_START + (ROW - FS) * 0.5f }, cSub, msg);
+        }
+
+        std::vector<ImVec2> line;
+        for (int row = 0; row < NTYPES; row++) {
+            const TypeAnalytics& t = report->types[row];
+            float ry = wp.y + ROWS_START + row * ROW;
+            float cy = ry + (ROW - FS) * 0.5f;
+
+            dl->AddText(fnt, FS * 0.88f, { wp.x + PAD, cy }, IM_COL32(195, 220, 255, 215), t.type.c_str());
+            dl->AddText(fnt, FS * 0.88f, { wp.x + X_SESS, cy }, cWhite, FmtNum(t.sessions).c_str());
+            dl->AddText(fnt, FS * 0.88f, { wp.x + X_ACC, cy }, cWhite, pct(t.Accuracy()).c_str());
+
+            // p10..p90 span on a 0..100% track, tick at the median
+            float bx = wp.x + X_RANGE, by = ry + ROW * 0.5f - 2.f;
+            dl->AddRectFilled({ bx, by }, { bx + RANGE_W, by + 4.f }, IM_COL32(255, 255, 255, 18), 2.f);
+            dl->AddRectFilled({ bx + RANGE_W * t.p10, by }, { bx + RANGE_W * t.p90, by + 4.f },
+                t.p50 >= 0.5f ? cGreen : IM_COL32(220, 150, 40, 255), 2.f);
+            dl->AddLine({ bx + RANGE_W * t.p50, by - 3.f }, { bx + RANGE_W * t.p50, by + 7.f }, cWhite, 2.f);
+
+            dl->AddText(fnt, FS * 0.88f, { wp.x + X_CONS, cy }, cWhite, std::to_string((int)std::lround(t.consistency)).c_str());
+
+            // Accuracy against practice, 0..100% over the row height
+            if (t.curve.size() >= 2) {
+                float cx = wp.x + X_CURVE, top = ry + 4.f, h = ROW - 8.f;
+                float maxPractice = (float)t.curve.back().practice;
+                line.clear();
+                for (const auto& pt : t.curve)
+                    line.push_back({ cx + CURVE_W * pt.practice / maxPractice, top + h * (1.f - pt.accuracy) });
+                dl->AddLine({ cx, top + h * 0.5f }, { cx + CURVE_W, top + h * 0.5f }, IM_COL32(255, 255, 255, 18), 1.f);
+                dl->AddPolyline(line.data(), (int)line.size(), cLine, false, 1.5f);
+            }
+
+            if (row < NTYPES - 1)
+                dl->AddLine({ wp.x + 8.f, ry + ROW }, { wp.x + AW - 8.f, ry + ROW }, IM_COL32(70, 100, 200, 30), 1.f);
+        }
+
+        std::string foot = running
+            ? "UPDATING  " + std::to_string(filesDone) + " / " + std::to_string(filesTotal) + " FILES"
+            : "mechtrak_analytics TO CLOSE";
+        ImVec2 fSz = fnt->CalcTextSizeA(FS * 0.78f, FLT_MAX, 0, foot.c_str());
+        dl->AddText(fnt, FS * 0.78f, { wp.x + (AW - fSz.x) * 0.5f, wp.y + AH - 18.f }, cSub, foot.c_str());
+    }
+    ImGui::End();
+    ImGui::PopStyleVar(2);
+}
+
 void HUD::DrawMiniGraph(CanvasWrapper& canvas,
-    std::map<int, ShotStats>& shotStats, int currentShotNumber, int startX, int startY)
+    ShotTable& shotStats, int currentShotNumber, int startX, int startY)
 {
     if (!shotStats.count(currentShotNumber)) return;
     auto& s = shotStats[currentShotNumber];
+    // The hot attempts only; the canvas is 180px wide, and sealed ones
+    // would have to be read back every frame
     if (s.attemptHistory.empty()) return;
     int gW = 180, gH = 70, wSz = 5;
+    std::vector<float> acc(s.attemptHistory.size());
+    HistoryKernels::WindowAccuracy(PackedHistory(s.attemptHistory), wSz, acc.data());
     canvas.SetColor(100, 200, 255, 255);
     Vector2F last = { -1.f, -1.f };
-    for (size_t i = 0; i < s.attemptHistory.size(); i++) {
-        int goals = 0;
-        size_t ws = (i >= (size_t)(wSz - 1)) ? i - wSz + 1 : 0;
-        int    aw = (int)(i - ws + 1);
-        for (size_t j = ws; j <= i; j++) if (s.attemptHistory[j]) goals++;
-        float xp = startX + (i * gW / (float)s.attemptHistory.size());
-        float yp = startY + gH - ((float)goals / aw * gH);
+    for (size_t i = 0; i < acc.size(); i++) {
+        float xp = startX + (i * gW / (float)acc.size());
+        float yp = startY + gH - (acc[i] * gH);
         Vector2F pt = { xp, yp };
         if (last.X >= 0) canvas.DrawLine(last, pt, 2.f);
         last = pt;
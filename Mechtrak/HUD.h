@@ -2,16 +2,18 @@
 #include "bakkesmod/plugin/bakkesmodplugin.h"
 #include "bakkesmod/wrappers/canvaswrapper.h"
 #include "imgui/imgui.h"
+#include "ShotStats.h"
 #include <map>
 #include <string>
 #include <vector>
 #include <functional>
 
-struct ShotStats {
-    int attempts = 0;
-    int goals = 0;
-    std::vector<bool> attemptHistory;
-};
+class SessionAggregates;
+class LiveMetrics;
+class TrendGraph;
+class ShotGrid;
+class SessionTimeline;
+struct AnalyticsReport;
 
 class HUD {
 public:
@@ -19,8 +21,8 @@ public:
         CanvasWrapper& canvas,
         std::shared_ptr<CVarManagerWrapper> cvarManager,
         std::shared_ptr<GameWrapper> gameWrapper,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes,
+        ShotTable& shotStats,
+        ShotNames& shotTypes,
         int currentShotNumber,
         bool sessionActive
     );
@@ -28,18 +30,43 @@ public:
     static void RenderImGui(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
         std::shared_ptr<GameWrapper> gameWrapper,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes,
+        ShotTable& shotStats,
+        ShotNames& shotTypes,
+        const SessionAggregates& aggregates,
+        const LiveMetrics& metrics,
+        const TrendGraph& trend,
+        ShotGrid& grid,
         int currentShotNumber,
         bool sessionActive,
         bool& showEditPanel,
         std::function<void()> onEndSession,
-        std::function<void(int, int, int)> onEditShot  // shotNum, newGoals, newAttempts
+        std::function<void(int, int, int)> onEditShot,  // shotNum, newGoals, newAttempts
+        std::function<void(int)> onSelectShot
     );
 
+    // Cross-session analytics panel; report is null until the first run
+    // finishes, and done/total show a run in progress
+    static void RenderAnalytics(
+        const AnalyticsReport* report,
+        bool running,
+        size_t filesDone,
+        size_t filesTotal
+    );
+
+    // Every attempt of the session against time; wheel zooms, drag pans and
+    // a double click fits the whole session. nowMs is time since its start.
+    static void RenderTimeline(
+        SessionTimeline& timeline,
+        const ShotTable& shotStats,
+        uint32_t nowMs
+    );
+
+    // 1234 -> "1.2K"
+    static std::string FmtNum(int n);
+
     static void DrawMiniGraph(
         CanvasWrapper& canvas,
-        std::map<int, ShotStats>& shotStats,
+        ShotTable& shotStats,
         int currentShotNumber,
         int startX,
         int startY
@@ -51,5 +78,4 @@ private:
     static void DrawProgressBar(ImDrawList* dl, ImVec2 pos,
         float width, float height, float fraction,
         ImU32 bgCol, ImU32 fillCol, float rounding = 3.f);
-    static std::string FmtNum(int n);
 };
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include "Handoff.h"
+#include "SessionSchema.h"
+#include <filesystem>
+#include <fstream>
+
+template<>
+struct codec::Schema<RuntimeState> {
+    static constexpr auto fields = std::make_tuple(
+        Member<RuntimeState, int64_t>{ "savedAtMs", &RuntimeState::savedAtMs },
+        Member<RuntimeState, std::string>{ "sessionId", &RuntimeState::sessionId },
+        Member<RuntimeState, bool>{ "sessionActive", &RuntimeState::sessionActive },
+        Member<RuntimeState, int64_t>{ "sessionStartMs", &RuntimeState::sessionStartMs },
+        Member<RuntimeState, int>{ "currentShotNumber", &RuntimeState::currentShotNumber },
+        Member<RuntimeState, bool>{ "roundActive", &RuntimeState::roundActive },
+        Member<RuntimeState, bool>{ "justRecordedAttempt", &RuntimeState::justRecordedAttempt },
+        Member<RuntimeState, uint32_t>{ "roundStartMs", &RuntimeState::roundStartMs },
+        Member<RuntimeState, uint32_t>{ "firstTouchMs", &RuntimeState::firstTouchMs },
+        Member<RuntimeState, int>{ "lastKnownScore", &RuntimeState::lastKnownScore },
+        Member<RuntimeState, int64_t>{ "lastGoalAgoMs", &RuntimeState::lastGoalAgoMs },
+        Member<RuntimeState, bool>{ "showEditPanel", &RuntimeState::showEditPanel },
+        Member<RuntimeState, ShotTable>{ "shotStats", &RuntimeState::shotStats },
+        Member<RuntimeState, ShotNames>{ "shotTypes", &RuntimeState::shotTypes }
+    );
+};
+
+namespace {
+
+constexpr char MAGIC[4] = { 'M', 'T', 'K', 'R' };
+
+int64_t NowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void Handoff::Encode(std::string& out, const RuntimeState& state)
+{
+    out.assign(MAGIC, sizeof(MAGIC));
+    out.push_back((char)VERSION);
+    codec::Encode(out, state);
+}
+
+Handoff::Result Handoff::Decode(std::string_view in, RuntimeState& state)
+{
+    if (in.size() < 5 || in.compare(0, 4, std::string_view(MAGIC, 4)) != 0) return Result::BadHeader;
+    if ((uint8_t)in[4] != VERSION) return Result::VersionMismatch;
+
+    size_t pos = 5;
+    RuntimeState decoded;
+    if (!codec::Decode(in, pos, decoded) || pos != in.size()) return Result::Corrupt;
+    state = std::move(decoded);
+    return Result::Restored;
+}
+
+bool Handoff::Write(const std::string& path, const RuntimeState& state)
+{
+    std::string blob;
+    Encode(blob, state);
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(blob.data(), (std::streamsize)blob.size());
+        if (!file) return false;
+    }
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+Handoff::Result Handoff::Take(const std::string& path, const std::string& expectedSessionId, RuntimeState& state)
+{
+    std::string blob;
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) return Result::Missing;
+        std::streamsize size = file.tellg();
+        file.seekg(0);
+        blob.resize(size > 0 ? (size_t)size : 0);
+        if (size > 0 && !file.read(blob.data(), size)) blob.clear();
+    }
+    // Single use: a blob that is wrong now will not be right next load either
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+
+    RuntimeState decoded;
+    Result result = Decode(blob, decoded);
+    if (result != Result::Restored) return result;
+
+    int64_t age = NowMs() - decoded.savedAtMs;
+    if (age < 0 || age > std::chrono::duration_cast<std::chrono::milliseconds>(MAX_AGE).count())
+        return Result::Stale;
+    if (decoded.sessionActive && decoded.sessionId != expectedSessionId) return Result::OtherSession;
+
+    state = std::move(decoded);
+    return Result::Restored;
+}
+
+const char* Handoff::Describe(Result result)
+{
+    switch (result) {
+    case Result::Restored:        return "restored";
+    case Result::Missing:         return "no handoff";
+    case Result::BadHeader:       return "not a handoff file";
+    case Result::VersionMismatch: return "written by another plugin version";
+    case Result::Corrupt:         return "corrupt";
+    case Result::Stale:           return "too old";
+    case Result::OtherSession:    return "for another session";
+    }
+    return "";
+}
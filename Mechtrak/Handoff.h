@@ -0,0 +1,58 @@
+#pragma once
+#include "ShotStats.h"
+#include <map>
+#include <string>
+#include <string_view>
+#include <chrono>
+#include <cstdint>
+
+// In-memory plugin state that `plugin reload mechtrak` would otherwise lose
+struct RuntimeState {
+    int64_t     savedAtMs = 0;          // unix ms, for the freshness check
+    std::string sessionId;
+    bool        sessionActive = false;
+    int64_t     sessionStartMs = 0;     // unix ms
+    int         currentShotNumber = 1;
+    bool        roundActive = false;
+    bool        justRecordedAttempt = false;
+    uint32_t    roundStartMs = 0;       // since sessionStartMs
+    uint32_t    firstTouchMs = 0;
+    int         lastKnownScore = 0;
+    int64_t     lastGoalAgoMs = -1;     // -1 = no goal in the last window
+    bool        showEditPanel = false;
+    ShotTable   shotStats;
+    ShotNames   shotTypes;
+};
+
+// onUnload writes RuntimeState to rl_best_stats\handoff.mtk as "MTKR", a
+// version byte and the binary codec body; the next onLoad takes it (the file
+// is deleted on read) instead of going back to the server. The codec is
+// positional, so any change to RuntimeState or the ShotStats schema must bump
+// VERSION.
+class Handoff {
+public:
+    static constexpr uint8_t VERSION = 2;
+    static constexpr auto MAX_AGE = std::chrono::minutes(5);
+
+    enum class Result {
+        Restored,
+        Missing,
+        BadHeader,
+        VersionMismatch,
+        Corrupt,
+        Stale,
+        OtherSession
+    };
+
+    static void Encode(std::string& out, const RuntimeState& state);
+    static Result Decode(std::string_view in, RuntimeState& state);
+
+    static bool Write(const std::string& path, const RuntimeState& state);
+
+    // Reads and deletes the blob at path. state is only filled when the blob
+    // is younger than MAX_AGE and, if it holds an active session, that
+    // session is expectedSessionId.
+    static Result Take(const std::string& path, const std::string& expectedSessionId, RuntimeState& state);
+
+    static const char* Describe(Result result);
+};
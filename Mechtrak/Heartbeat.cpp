@@ -1,71 +1,78 @@
 #include "pch.h"
 #include "Heartbeat.h"
-#include "Config.h"
-#include <winhttp.h>
-#include <thread>
+#include "Http.h"
+#include "Outbox.h"
+#include "SyncWorker.h"
 
 void Heartbeat::Send(
     std::shared_ptr<CVarManagerWrapper> cvarManager,
     std::shared_ptr<GameWrapper> gameWrapper,
-    const std::string& sessionId)
+    const std::string& sessionId,
+    std::function<void(bool)> done)
 {
-    HINTERNET hSession = WinHttpOpen(L"RLStatsPlugin/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hSession) return;
-
-    HINTERNET hConnect = WinHttpConnect(hSession, SERVER_HOST.c_str(), SERVER_PORT, 0);
-    if (!hConnect) { WinHttpCloseHandle(hSession); return; }
-
-    HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", L"/api/heartbeat",
-        NULL, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
-        WINHTTP_FLAG_SECURE);
-
-    if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return;
-    }
-
-    std::string body = "{\"session_id\": \"" + sessionId + "\"}";
-    std::wstring headers = L"Content-Type: application/json\r\n";
-    WinHttpAddRequestHeaders(hRequest, headers.c_str(), -1, WINHTTP_ADDREQ_FLAG_ADD);
-
-    BOOL bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-        (LPVOID)body.c_str(), body.length(), body.length(), 0);
+    HttpRequest request;
+    request.method = L"POST";
+    request.path = L"/api/heartbeat";
+    request.headers = L"Content-Type: application/json\r\n";
+    request.body = "{\"session_id\": \"" + sessionId + "\"}";
+    request.timeout = std::chrono::seconds(5);
+    Http::SendScheduled(std::move(request), [done](HttpResponse&& response) { done(response.Answered()); });
+}
 
-    if (bResults) WinHttpReceiveResponse(hRequest, NULL);
+std::chrono::milliseconds Heartbeat::NextDelay(
+    std::chrono::milliseconds previous,
+    bool reachable,
+    bool inTraining,
+    bool sessionLoaded)
+{
+    using namespace std::chrono;
+    constexpr milliseconds BASE = seconds(30);
+    constexpr milliseconds SWITCH_POLL = seconds(10);
+    constexpr milliseconds MAX_IDLE = minutes(5);
 
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
+    // Server down or player in menus / matches: nothing to keep fresh
+    if (!reachable || !inTraining)
+        return std::min(std::max(previous, BASE / 2) * 2, MAX_IDLE);
+    return sessionLoaded ? BASE : SWITCH_POLL;
 }
 
 void Heartbeat::Start(
     std::shared_ptr<CVarManagerWrapper> cvarManager,
     std::shared_ptr<GameWrapper> gameWrapper,
-    std::string& sessionId,
-    bool& sessionActive,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes,
-    int& currentShotNumber)
+    const std::atomic<bool>& inTraining,
+    std::function<void(Session::ActiveSession)> onFetched)
 {
-    // Run heartbeat on background thread
-    std::thread([cvarManager, gameWrapper, &sessionId, &sessionActive,
-        &shotStats, &shotTypes, &currentShotNumber]() {
-            Send(cvarManager, gameWrapper, sessionId);
+    auto interval = std::make_shared<std::chrono::milliseconds>(std::chrono::seconds(30));
+
+    SyncWorker::SetIdleTask([cvarManager, gameWrapper, &inTraining, onFetched, interval](
+        std::function<void(std::chrono::milliseconds)> next) {
+            Session::Live live = Session::Published();
+            bool loaded = live.active && !live.sessionId.empty();
 
-        // If no session loaded yet, try again
-        if (!sessionActive || sessionId.empty()) {
-            cvarManager->log("No session loaded, retrying LoadActive...");
-            Session::LoadActive(cvarManager, sessionId, sessionActive,
-                shotStats, shotTypes, currentShotNumber);
-        }
-    }).detach();
+            Send(cvarManager, gameWrapper, live.sessionId, [cvarManager, &inTraining, onFetched, interval, next, loaded](bool reachable) {
+                auto finish = [&inTraining, interval, next, reachable, loaded]() {
+                    *interval = NextDelay(*interval, reachable, inTraining, loaded);
+                    next(*interval);
+                };
+                if (!reachable) {
+                    finish();
+                    return;
+                }
 
-    gameWrapper->SetTimeout([cvarManager, gameWrapper, &sessionId, &sessionActive,
-        &shotStats, &shotTypes, &currentShotNumber](GameWrapper* gw) {
-            Start(cvarManager, gameWrapper, sessionId, sessionActive,
-                shotStats, shotTypes, currentShotNumber);
-        }, 30.0f);
+                // A reachable server ends any upload backoff; flush what queued up
+                Outbox::NotifyOnline();
+                Session::DrainOutbox(cvarManager, [cvarManager, onFetched, finish, loaded]() {
+                    if (loaded) {
+                        finish();
+                        return;
+                    }
+                    // If no session loaded yet, try again
+                    cvarManager->log("No session loaded, fetching the active one...");
+                    Session::FetchActive(cvarManager, [onFetched, finish](Session::ActiveSession fetched) {
+                        onFetched(std::move(fetched));
+                        finish();
+                        });
+                    });
+                });
+        }, std::chrono::seconds(0));
 }
\ No newline at end of file
@@ -4,22 +4,38 @@
 #include "Session.h"
 #include <string>
 #include <map>
+#include <chrono>
+#include <atomic>
+#include <functional>
 
 class Heartbeat {
 public:
+    // done gets true if the server answered at all, on the Scheduler thread
     static void Send(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
         std::shared_ptr<GameWrapper> gameWrapper,
-        const std::string& sessionId
+        const std::string& sessionId,
+        std::function<void(bool reachable)> done
     );
 
+    // Delay until the next idle heartbeat: 30 s while training, doubling up
+    // to 5 min outside custom training, 10 s while no session is loaded in
+    // training (the user is about to start or switch one on the dashboard)
+    static std::chrono::milliseconds NextDelay(
+        std::chrono::milliseconds previous,
+        bool reachable,
+        bool inTraining,
+        bool sessionLoaded
+    );
+
+    // Runs the heartbeat as the SyncWorker's idle task. Successful uploads
+    // count as heartbeats, so while attempts are flowing none are sent.
+    // The session comes from Session::Published(); while none is loaded the
+    // active one is fetched and handed to onFetched, on the Scheduler thread.
     static void Start(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
         std::shared_ptr<GameWrapper> gameWrapper,
-        std::string& sessionId,
-        bool& sessionActive,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes,
-        int& currentShotNumber
+        const std::atomic<bool>& inTraining,
+        std::function<void(Session::ActiveSession)> onFetched
     );
 };
\ No newline at end of file
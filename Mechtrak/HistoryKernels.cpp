@@ -0,0 +1,364 @@
+#include "HistoryKernels.h"
+#include <array>
+#include <bit>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define MT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MT_AVX2
+#else
+#include <cpuid.h>
+#define MT_AVX2 __attribute__((target("avx2,popcnt")))
+#endif
+#endif
+
+PackedHistory::PackedHistory(const std::vector<bool>& history)
+{
+    Append(history);
+}
+
+void PackedHistory::Append(const std::vector<bool>& bits)
+{
+    size_t at = n;
+    n += bits.size();
+    words.resize((n + 63) / 64, 0);
+    // Iterating walks vector<bool>'s words; indexing would find each again.
+    // Bits gather in a register and land one word at a time.
+    uint64_t w = at & 63 ? words[at >> 6] : 0;
+    for (bool goal : bits) {
+        w |= (uint64_t)goal << (at & 63);
+        if ((++at & 63) == 0) {
+            words[(at >> 6) - 1] = w;
+            w = 0;
+        }
+    }
+    if (at & 63) words[at >> 6] = w;
+}
+
+void PackedHistory::Push(bool goal)
+{
+    if ((n & 63) == 0) words.push_back(0);
+    if (goal) words[n >> 6] |= 1ull << (n & 63);
+    n++;
+}
+
+namespace {
+
+// PREFIX[b][k] = goals among the low k + 1 bits of byte b
+constexpr auto PREFIX = [] {
+    std::array<std::array<uint8_t, 8>, 256> t{};
+    for (int b = 0; b < 256; b++) {
+        uint8_t c = 0;
+        for (int k = 0; k < 8; k++) {
+            c += (b >> k) & 1;
+            t[b][k] = c;
+        }
+    }
+    return t;
+}();
+
+// p[i] = goals among attempts [0, i). Rounded up to whole bytes; the
+// padding bits are zero so the extra entries just repeat the total.
+thread_local std::vector<int32_t> prefix;
+
+uint8_t ByteAt(const std::vector<uint64_t>& words, size_t j)
+{
+    return (uint8_t)(words[j >> 3] >> ((j & 7) * 8));
+}
+
+// ── Scalar ──────────────────────────────────────────────────────────────────
+
+void PrefixScalar(const PackedHistory& h)
+{
+    size_t bytes = (h.Size() + 7) / 8;
+    prefix.resize(1 + bytes * 8);
+    prefix[0] = 0;
+    int32_t base = 0;
+    for (size_t j = 0; j < bytes; j++) {
+        const auto& row = PREFIX[ByteAt(h.Words(), j)];
+        for (int k = 0; k < 8; k++) prefix[1 + j * 8 + k] = base + row[k];
+        base += row[7];
+    }
+}
+
+size_t GoalsScalar(const uint64_t* w, size_t from, size_t to)
+{
+    if (from >= to) return 0;
+    size_t a = from >> 6, b = (to - 1) >> 6;
+    uint64_t lo = ~0ull << (from & 63);
+    uint64_t hi = ~0ull >> (63 - ((to - 1) & 63));
+    if (a == b) return (size_t)std::popcount(w[a] & lo & hi);
+    size_t c = (size_t)std::popcount(w[a] & lo) + (size_t)std::popcount(w[b] & hi);
+    for (size_t i = a + 1; i < b; i++) c += (size_t)std::popcount(w[i]);
+    return c;
+}
+
+// Leading part of the window series, where fewer than `window` attempts exist
+size_t WindowHead(size_t n, int window, float* out)
+{
+    size_t head = std::min(n, (size_t)window - 1);
+    for (size_t i = 0; i < head; i++) out[i] = (float)prefix[i + 1] / (float)(i + 1);
+    return head;
+}
+
+void WindowScalar(const PackedHistory& h, int window, float* out)
+{
+    PrefixScalar(h);
+    size_t n = h.Size();
+    float inv = 1.f / (float)window;
+    for (size_t i = WindowHead(n, window, out); i < n; i++)
+        out[i] = (float)(prefix[i + 1] - prefix[i + 1 - window]) * inv;
+}
+
+void BlockScalar(const PackedHistory& h, int block, float* out)
+{
+    size_t n = h.Size(), full = n / (size_t)block;
+    float inv = 1.f / (float)block;
+    const uint64_t* w = h.Words().data();
+    for (size_t k = 0; k < full; k++)
+        out[k] = (float)GoalsScalar(w, k * block, (k + 1) * block) * inv;
+    if (full * block < n)
+        out[full] = (float)GoalsScalar(w, full * block, n) / (float)(n - full * block);
+}
+
+// Runs from per-word masks of run starts and run ends (the last goal of each
+// run), visited in bit order; a one-attempt run sets both bits
+struct RunCursor {
+    uint32_t start = 0;
+
+    template<typename Fn>
+    void Visit(size_t word, uint64_t starts, uint64_t ends, Fn& fn)
+    {
+        for (uint64_t m = starts | ends; m; m &= m - 1) {
+            int b = std::countr_zero(m);
+            uint64_t bit = 1ull << b;
+            uint32_t at = (uint32_t)(word * 64 + b);
+            if (starts & bit) start = at;
+            if (ends & bit) fn(start, at - start + 1);
+        }
+    }
+};
+
+uint64_t Starts(uint64_t x, uint64_t before) { return x & ~((x << 1) | (before >> 63)); }
+uint64_t Ends(uint64_t x, uint64_t after)    { return x & ~((x >> 1) | (after << 63)); }
+
+template<typename Fn>
+void RunsScalar(const PackedHistory& h, Fn&& fn)
+{
+    const auto& w = h.Words();
+    RunCursor cursor;
+    for (size_t j = 0; j < w.size(); j++) {
+        uint64_t before = j > 0 ? w[j - 1] : 0, after = j + 1 < w.size() ? w[j + 1] : 0;
+        cursor.Visit(j, Starts(w[j], before), Ends(w[j], after), fn);
+    }
+}
+
+// ── AVX2 ────────────────────────────────────────────────────────────────────
+
+#ifdef MT_X86
+
+bool DetectAvx2()
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuid(r, 0);
+    if (r[0] < 7) return false;
+    __cpuid(r, 1);
+    bool osxsave = (r[2] >> 27) & 1, popcnt = (r[2] >> 23) & 1;
+    if (!osxsave || !popcnt || (_xgetbv(0) & 6) != 6) return false;   // OS saves YMM state
+    __cpuidex(r, 7, 0);
+    return (r[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+}
+
+MT_AVX2 void PrefixAvx2(const PackedHistory& h)
+{
+    size_t bytes = (h.Size() + 7) / 8;
+    prefix.resize(1 + bytes * 8);
+    prefix[0] = 0;
+    int32_t base = 0;
+    for (size_t j = 0; j < bytes; j++) {
+        uint8_t b = ByteAt(h.Words(), j);
+        __m256i row = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)PREFIX[b].data()));
+        _mm256_storeu_si256((__m256i*)&prefix[1 + j * 8], _mm256_add_epi32(row, _mm256_set1_epi32(base)));
+        base += PREFIX[b][7];
+    }
+}
+
+// Nibble-lookup popcount, four words per step
+MT_AVX2 size_t PopcountAvx2(const uint64_t* w, size_t count)
+{
+    const __m256i lut = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(w + i));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, nibble));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    size_t c = (size_t)(_mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) +
+        _mm256_extract_epi64(acc, 2) + _mm256_extract_epi64(acc, 3));
+    for (; i < count; i++) c += (size_t)_mm_popcnt_u64(w[i]);
+    return c;
+}
+
+MT_AVX2 size_t GoalsAvx2(const uint64_t* w, size_t from, size_t to)
+{
+    if (from >= to) return 0;
+    size_t a = from >> 6, b = (to - 1) >> 6;
+    if (b - a < 8) return GoalsScalar(w, from, to);
+    uint64_t lo = ~0ull << (from & 63);
+    uint64_t hi = ~0ull >> (63 - ((to - 1) & 63));
+    return (size_t)_mm_popcnt_u64(w[a] & lo) + (size_t)_mm_popcnt_u64(w[b] & hi) + PopcountAvx2(w + a + 1, b - a - 1);
+}
+
+MT_AVX2 void WindowAvx2(const PackedHistory& h, int window, float* out)
+{
+    PrefixAvx2(h);
+    size_t n = h.Size();
+    const float inv = 1.f / (float)window;
+    const __m256 vinv = _mm256_set1_ps(inv);
+    const int32_t* p = prefix.data();
+    size_t i = WindowHead(n, window, out);
+    for (; i + 8 <= n; i += 8) {
+        __m256i hiSum = _mm256_loadu_si256((const __m256i*)(p + i + 1));
+        __m256i loSum = _mm256_loadu_si256((const __m256i*)(p + i + 1 - window));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(hiSum, loSum)), vinv));
+    }
+    for (; i < n; i++) out[i] = (float)(p[i + 1] - p[i + 1 - window]) * inv;
+}
+
+MT_AVX2 void BlockAvx2(const PackedHistory& h, int block, float* out)
+{
+    size_t n = h.Size(), full = n / (size_t)block, k = 0;
+    const float inv = 1.f / (float)block;
+    const uint64_t* w = h.Words().data();
+    if (block < 64) {
+        // Short blocks: gather their ends from the prefix counts, eight at a time
+        PrefixAvx2(h);
+        const __m256i step = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(block));
+        const __m256 vinv = _mm256_set1_ps(inv);
+        for (; k + 8 <= full; k += 8) {
+            __m256i s = _mm256_add_epi32(_mm256_set1_epi32((int)(k * block)), step);
+            __m256i e = _mm256_add_epi32(s, _mm256_set1_epi32(block));
+            __m256i g = _mm256_sub_epi32(_mm256_i32gather_epi32(prefix.data(), e, 4),
+                _mm256_i32gather_epi32(prefix.data(), s, 4));
+            _mm256_storeu_ps(out + k, _mm256_mul_ps(_mm256_cvtepi32_ps(g), vinv));
+        }
+    }
+    for (; k < full; k++) out[k] = (float)GoalsAvx2(w, k * block, (k + 1) * block) * inv;
+    if (full * block < n)
+        out[full] = (float)GoalsAvx2(w, full * block, n) / (float)(n - full * block);
+}
+
+// Start and end masks for four words at once; the neighbours come from
+// loads shifted by one word
+template<typename Fn>
+MT_AVX2 void RunsAvx2(const PackedHistory& h, Fn&& fn)
+{
+    const auto& w = h.Words();
+    size_t nw = w.size();
+    RunCursor cursor;
+    alignas(32) uint64_t starts[4], ends[4];
+    auto one = [&](size_t j) {
+        uint64_t before = j > 0 ? w[j - 1] : 0, after = j + 1 < nw ? w[j + 1] : 0;
+        cursor.Visit(j, Starts(w[j], before), Ends(w[j], after), fn);
+    };
+
+    size_t j = 0;
+    if (nw > 0) one(j++);
+    for (; j + 5 <= nw; j += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(w.data() + j));
+        __m256i before = _mm256_loadu_si256((const __m256i*)(w.data() + j - 1));
+        __m256i after = _mm256_loadu_si256((const __m256i*)(w.data() + j + 1));
+        __m256i s = _mm256_andnot_si256(_mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(before, 63)), x);
+        __m256i e = _mm256_andnot_si256(_mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(after, 63)), x);
+        _mm256_store_si256((__m256i*)starts, s);
+        _mm256_store_si256((__m256i*)ends, e);
+        for (int k = 0; k < 4; k++) cursor.Visit(j + k, starts[k], ends[k], fn);
+    }
+    for (; j < nw; j++) one(j);
+}
+
+bool useAvx2 = DetectAvx2();
+
+#else
+
+bool useAvx2 = false;
+
+#endif
+
+} // namespace
+
+const char* HistoryKernels::Backend()
+{
+    return useAvx2 ? "avx2" : "scalar";
+}
+
+void HistoryKernels::ForceScalar(bool scalar)
+{
+#ifdef MT_X86
+    useAvx2 = !scalar && DetectAvx2();
+#endif
+}
+
+size_t HistoryKernels::Goals(const PackedHistory& h, size_t from, size_t to)
+{
+    to = std::min(to, h.Size());
+#ifdef MT_X86
+    if (useAvx2) return GoalsAvx2(h.Words().data(), from, to);
+#endif
+    return GoalsScalar(h.Words().data(), from, to);
+}
+
+void HistoryKernels::WindowAccuracy(const PackedHistory& h, int window, float* out)
+{
+    if (h.Size() == 0 || window < 1) return;
+#ifdef MT_X86
+    if (useAvx2) return WindowAvx2(h, window, out);
+#endif
+    WindowScalar(h, window, out);
+}
+
+void HistoryKernels::BlockAccuracy(const PackedHistory& h, int block, float* out)
+{
+    if (h.Size() == 0 || block < 1) return;
+#ifdef MT_X86
+    if (useAvx2) return BlockAvx2(h, block, out);
+#endif
+    BlockScalar(h, block, out);
+}
+
+void HistoryKernels::GoalRuns(const PackedHistory& h, std::vector<Run>& out)
+{
+    out.clear();
+    auto add = [&](uint32_t start, uint32_t length) { out.push_back({ start, length }); };
+#ifdef MT_X86
+    if (useAvx2) return RunsAvx2(h, add);
+#endif
+    RunsScalar(h, add);
+}
+
+int HistoryKernels::LongestRun(const PackedHistory& h)
+{
+    uint32_t best = 0;
+    auto longest = [&](uint32_t, uint32_t length) { best = std::max(best, length); };
+#ifdef MT_X86
+    if (useAvx2) {
+        RunsAvx2(h, longest);
+        return (int)best;
+    }
+#endif
+    RunsScalar(h, longest);
+    return (int)best;
+}
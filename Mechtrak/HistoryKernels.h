@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Attempt outcomes packed 64 to a word: attempt i is bit i % 64 of word
+// i / 64, bits past Size() are zero. ShotStats keeps its std::vector<bool>,
+// whose words are not reachable portably; pack once per batch of queries.
+class PackedHistory {
+public:
+    PackedHistory() = default;
+    explicit PackedHistory(const std::vector<bool>& history);
+
+    void Push(bool goal);
+    // Push for each of bits, a good deal faster than one at a time
+    void Append(const std::vector<bool>& bits);
+
+    size_t Size() const { return n; }
+    bool operator[](size_t i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    const std::vector<uint64_t>& Words() const { return words; }
+
+private:
+    std::vector<uint64_t> words;
+    size_t n = 0;
+};
+
+// Batch queries over a PackedHistory for graphs and summaries. Each has a
+// portable scalar version and an AVX2 one; the AVX2 path is taken when the
+// CPU and OS support it, checked once. Both give identical results.
+// Free of BakkesMod so the tools can use them.
+class HistoryKernels {
+public:
+    struct Run {
+        uint32_t start;
+        uint32_t length;
+    };
+
+    // "avx2" or "scalar"
+    static const char* Backend();
+    // Pins the scalar path, e.g. to compare the two. Not thread safe.
+    static void ForceScalar(bool scalar);
+
+    // Goals among attempts [from, to)
+    static size_t Goals(const PackedHistory& h, size_t from, size_t to);
+
+    // out[i] = accuracy (0..1) over the `window` attempts ending at i, or all
+    // of them while fewer have been played. out holds h.Size() floats.
+    static void WindowAccuracy(const PackedHistory& h, int window, float* out);
+
+    // out[k] = accuracy of attempts [k * block, (k + 1) * block); the last
+    // block may be short. out holds ceil(h.Size() / block) floats.
+    static void BlockAccuracy(const PackedHistory& h, int block, float* out);
+
+    // Maximal runs of goals, oldest first
+    static void GoalRuns(const PackedHistory& h, std::vector<Run>& out);
+    static int  LongestRun(const PackedHistory& h);
+};
@@ -0,0 +1,243 @@
+#include "pch.h"
+#include "Http.h"
+#include "Config.h"
+#include "Scheduler.h"
+#include <winhttp.h>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+#include <atomic>
+
+namespace {
+
+using Error = HttpResponse::Error;
+
+struct Call {
+    Http::RequestId    id = 0;
+    HINTERNET          handle = NULL;
+    HttpRequest        request;         // body must outlive the send
+    Http::Completion   done;
+    Scheduler::TimerId deadline = 0;
+    // A Cancel or deadline can complete the call while a WinHTTP callback is
+    // still filling in the response
+    std::mutex         lock;
+    HttpResponse       response;
+    bool               completed = false;
+    std::atomic<int>   refs{ 2 };       // Send() and WinHTTP's HANDLE_CLOSING
+    char               buf[8192];
+};
+
+std::mutex              mtx;
+std::condition_variable released;
+HINTERNET               hSession = NULL;
+HINTERNET               hConnect = NULL;
+bool                    accepting = false;
+std::unordered_map<Http::RequestId, Call*> calls;   // not completed yet
+size_t                  live = 0;                   // not yet released by WinHTTP
+Http::RequestId         nextId = 1;
+
+void Release(Call* call)
+{
+    if (--call->refs > 0) return;
+    delete call;
+    std::lock_guard<std::mutex> lock(mtx);
+    live--;
+    released.notify_all();
+}
+
+// Caller has removed call from `calls`, so nothing else completes it. The
+// call itself stays alive until WinHTTP reports the handle closed.
+void Complete(Call* call, Error error)
+{
+    Scheduler::Cancel(call->deadline);
+    Http::Completion done = std::move(call->done);
+    HttpResponse response;
+    {
+        std::lock_guard<std::mutex> lock(call->lock);
+        call->completed = true;
+        response = std::move(call->response);
+    }
+    response.error = error;
+    WinHttpCloseHandle(call->handle);
+    if (done) done(std::move(response));
+}
+
+// From a WinHTTP callback; loses quietly to a Cancel or deadline
+void Finish(Call* call, Error error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!calls.erase(call->id)) return;
+    }
+    Complete(call, error);
+}
+
+bool Abort(Http::RequestId id, Error error)
+{
+    Call* call;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = calls.find(id);
+        if (it == calls.end()) return false;
+        call = it->second;
+        calls.erase(it);
+    }
+    Complete(call, error);
+    return true;
+}
+
+void Refuse(const Http::Completion& done)
+{
+    HttpResponse response;
+    response.error = Error::Refused;
+    if (done) done(std::move(response));
+}
+
+// Send -> receive headers -> (query available -> read)* -> complete
+void CALLBACK OnStatus(HINTERNET hRequest, DWORD_PTR context, DWORD status, LPVOID info, DWORD length)
+{
+    Call* call = (Call*)context;
+    if (!call) return;
+
+    switch (status) {
+    case WINHTTP_CALLBACK_STATUS_SENDREQUEST_COMPLETE:
+        if (!WinHttpReceiveResponse(hRequest, NULL)) Finish(call, Error::Network);
+        break;
+
+    case WINHTTP_CALLBACK_STATUS_HEADERS_AVAILABLE: {
+        DWORD code = 0;
+        DWORD size = sizeof(code);
+        WinHttpQueryHeaders(hRequest, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+            WINHTTP_HEADER_NAME_BY_INDEX, &code, &size, WINHTTP_NO_HEADER_INDEX);
+        {
+            std::lock_guard<std::mutex> lock(call->lock);
+            if (call->completed) break;
+            call->response.status = code;
+        }
+        if (!WinHttpQueryDataAvailable(hRequest, NULL)) Finish(call, Error::Network);
+        break;
+    }
+
+    case WINHTTP_CALLBACK_STATUS_DATA_AVAILABLE: {
+        DWORD avail = *(DWORD*)info;
+        if (avail == 0) { Finish(call, Error::None); break; }
+        DWORD toRead = avail < sizeof(call->buf) ? avail : (DWORD)sizeof(call->buf);
+        if (!WinHttpReadData(hRequest, call->buf, toRead, NULL)) Finish(call, Error::Network);
+        break;
+    }
+
+    case WINHTTP_CALLBACK_STATUS_READ_COMPLETE: {
+        if (length == 0) { Finish(call, Error::None); break; }
+        {
+            // Once completed, the response has been handed out
+            std::lock_guard<std::mutex> lock(call->lock);
+            if (call->completed) break;
+            if (call->request.onChunk) call->request.onChunk(std::string_view(call->buf, length));
+            else call->response.body.append(call->buf, length);
+        }
+        if (!WinHttpQueryDataAvailable(hRequest, NULL)) Finish(call, Error::Network);
+        break;
+    }
+
+    case WINHTTP_CALLBACK_STATUS_REQUEST_ERROR:
+        Finish(call, Error::Network);
+        break;
+
+    case WINHTTP_CALLBACK_STATUS_HANDLE_CLOSING:
+        Release(call);
+        break;
+    }
+}
+
+} // namespace
+
+void Http::Start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (accepting) return;
+    if (!hSession)
+        hSession = WinHttpOpen(L"RLStatsPlugin/1.0", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, WINHTTP_FLAG_ASYNC);
+    if (hSession && !hConnect)
+        hConnect = WinHttpConnect(hSession, SERVER_HOST.c_str(), SERVER_PORT, 0);
+    accepting = hConnect != NULL;
+}
+
+Http::StopResult Http::Stop(std::chrono::steady_clock::time_point until)
+{
+    std::vector<RequestId> ids;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        accepting = false;
+        for (const auto& entry : calls) ids.push_back(entry.first);
+    }
+    StopResult result;
+    for (RequestId id : ids)
+        if (Abort(id, Error::Cancelled)) result.cancelled++;
+
+    // WinHTTP calls back into this DLL until every handle reports closing
+    std::unique_lock<std::mutex> lock(mtx);
+    released.wait_until(lock, until, [] { return live == 0; });
+    result.stillOpen = (int)live;
+    // Closing the parents would only prompt more callbacks for the stragglers
+    if (live > 0) return result;
+    if (hConnect) { WinHttpCloseHandle(hConnect); hConnect = NULL; }
+    if (hSession) { WinHttpCloseHandle(hSession); hSession = NULL; }
+    return result;
+}
+
+Http::RequestId Http::Send(HttpRequest request, Completion done)
+{
+    Call* call = new Call;
+    call->request = std::move(request);
+    call->done = std::move(done);
+
+    HINTERNET hRequest;
+    RequestId id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        hRequest = accepting ? WinHttpOpenRequest(hConnect, call->request.method.c_str(),
+            call->request.path.c_str(), NULL, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
+            WINHTTP_FLAG_SECURE) : NULL;
+        if (hRequest) {
+            id = call->id = nextId++;
+            call->handle = hRequest;
+            // Before anyone can close it, so HANDLE_CLOSING always arrives
+            DWORD_PTR context = (DWORD_PTR)call;
+            WinHttpSetOption(hRequest, WINHTTP_OPTION_CONTEXT_VALUE, &context, sizeof(context));
+            WinHttpSetStatusCallback(hRequest, OnStatus,
+                WINHTTP_CALLBACK_FLAG_ALL_COMPLETIONS | WINHTTP_CALLBACK_FLAG_HANDLES, 0);
+            call->deadline = Scheduler::After(call->request.timeout, [id]() { Abort(id, Error::Timeout); });
+            calls[id] = call;
+            live++;
+        }
+    }
+    if (!hRequest) {
+        Completion refused = std::move(call->done);
+        delete call;
+        Refuse(refused);
+        return 0;
+    }
+
+    const HttpRequest& r = call->request;
+    if (!r.headers.empty())
+        WinHttpAddRequestHeaders(hRequest, r.headers.c_str(), (DWORD)-1, WINHTTP_ADDREQ_FLAG_ADD);
+    DWORD length = (DWORD)r.body.size();
+    if (!WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+        length ? (LPVOID)r.body.data() : WINHTTP_NO_REQUEST_DATA, length, length, (DWORD_PTR)call))
+        Finish(call, Error::Network);
+
+    Release(call);
+    return id;
+}
+
+bool Http::Cancel(RequestId id)
+{
+    return Abort(id, Error::Cancelled);
+}
+
+size_t Http::InFlight()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return calls.size();
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "Scheduler.h"
+
+struct HttpRequest {
+    std::wstring method = L"GET";
+    std::wstring path;
+    std::wstring headers;                   // "Name: value\r\n" lines
+    std::string  body;
+    std::chrono::milliseconds timeout{ 10000 };  // whole exchange, connect to last byte
+    // Given each piece of the body as WinHTTP reads it, on a WinHTTP thread,
+    // and never once the completion has run. When set, the body is not kept
+    // and the response's body stays empty.
+    std::function<void(std::string_view chunk)> onChunk;
+};
+
+struct HttpResponse {
+    enum class Error {
+        None,
+        Refused,     // transport stopped or never started
+        Network,     // connect, send or receive failed
+        Timeout,
+        Cancelled
+    };
+
+    Error       error = Error::None;
+    uint32_t    status = 0;                 // 0 unless the server answered
+    std::string body;
+
+    bool Answered() const { return error == Error::None; }
+};
+
+// Non-blocking HTTP to SERVER_HOST. Send() returns as soon as the request is
+// handed to the transport; the completion runs once, on a transport thread,
+// with the status and the body (or after the last onChunk, if the request
+// streams it). Keep completions short and hand session state back to the
+// Scheduler, which SendScheduled does. Nothing waits for a response, so one
+// slow request never holds up the Scheduler or the game thread.
+//
+// Two backends share this interface: WinHTTP in async mode (Http.cpp, the
+// plugin's) and plain HTTP over epoll (HttpLoopback.cpp, Linux only, which
+// tools/ link against a loopback server).
+class Http {
+public:
+    using RequestId = uint64_t;
+    using Completion = std::function<void(HttpResponse&& response)>;
+
+    struct StopResult {
+        int cancelled = 0;
+        int stillOpen = 0;   // handles WinHTTP had not released by the deadline
+    };
+
+    // Opens the shared session; Lifecycle::Start calls this
+    static void Start();
+    // Refuses new requests, cancels the ones in flight and waits until every
+    // handle has reported HANDLE_CLOSING or until passes. Anything still open
+    // then can call back into the DLL, so the caller must treat it as fatal.
+    static StopResult Stop(std::chrono::steady_clock::time_point until);
+
+    // 0 if refused, in which case done has already run
+    static RequestId Send(HttpRequest request, Completion done);
+    // Completes the request with Error::Cancelled; false if it already finished
+    static bool Cancel(RequestId id);
+
+    // Send, with done run as a Scheduler task instead of on the transport
+    // thread; onChunk still runs on the transport thread. Completions still
+    // queued when the scheduler stops are dropped with it.
+    static RequestId SendScheduled(HttpRequest request, Completion done);
+
+    static size_t InFlight();
+};
+
+inline Http::RequestId Http::SendScheduled(HttpRequest request, Completion done)
+{
+    return Send(std::move(request), [done = std::move(done)](HttpResponse&& response) {
+        auto r = std::make_shared<HttpResponse>(std::move(response));
+        // With the scheduler stopped there is nowhere else to run it
+        if (!Scheduler::After(std::chrono::milliseconds(0), [done, r]() { if (done) done(std::move(*r)); }) && done)
+            done(std::move(*r));
+    });
+}
@@ -0,0 +1,339 @@
+// Plain HTTP/1.0 backend of Http.h for Linux, so the tools/ programs can run
+// the plugin's request paths against a server on loopback. One epoll thread
+// drives every connection; Cancel, deadlines and Stop only mark a call and
+// wake it, so done always runs on that thread, exactly once. Not part of the
+// plugin build, which uses the WinHTTP backend in Http.cpp.
+#ifdef __linux__
+#include "Http.h"
+#include "Config.h"
+#include "Scheduler.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using Error = HttpResponse::Error;
+
+constexpr size_t MAX_HEADERS = 64 * 1024;
+
+struct Call {
+    Http::RequestId    id = 0;
+    int                fd = -1;
+    HttpRequest        request;
+    Http::Completion   done;
+    Scheduler::TimerId deadline = 0;
+    Error              abort = Error::None;  // set under mtx by Cancel, deadline or Stop
+    // Only the I/O thread touches the rest
+    std::string        out;                  // request line, headers and body
+    size_t             sent = 0;
+    bool               connected = false;
+    bool               headersDone = false;
+    std::string        head;
+    long long          remaining = -1;       // body bytes still due; -1 until close
+    HttpResponse       response;
+};
+
+std::mutex              mtx;
+std::condition_variable released;
+std::thread             io;
+int                     epfd = -1;
+int                     wake = -1;           // epoll data 0; calls use their id
+bool                    accepting = false;
+bool                    quit = false;
+sockaddr_storage        server{};
+socklen_t               serverLen = 0;
+std::string             hostHeader;
+std::unordered_map<Http::RequestId, std::unique_ptr<Call>> calls;   // not completed yet
+size_t                  live = 0;                                   // done not yet returned
+Http::RequestId         nextId = 1;
+
+std::string Narrow(const std::wstring& text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (wchar_t c : text) out += c < 0x80 ? (char)c : '?';
+    return out;
+}
+
+void Wake()
+{
+    uint64_t one = 1;
+    if (write(wake, &one, sizeof(one)) < 0) {}
+}
+
+// Marks a call for the I/O thread to complete; false if it already is
+bool Mark(Http::RequestId id, Error error)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = calls.find(id);
+        if (it == calls.end() || it->second->abort != Error::None) return false;
+        it->second->abort = error;
+    }
+    Wake();
+    return true;
+}
+
+// I/O thread only. An earlier mark wins over how the exchange ended.
+void Finish(Call* c, Error error)
+{
+    std::unique_ptr<Call> call;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = calls.find(c->id);
+        if (it == calls.end()) return;
+        call = std::move(it->second);
+        calls.erase(it);
+        if (call->abort != Error::None) error = call->abort;
+    }
+    Scheduler::Cancel(call->deadline);
+    close(call->fd);
+    call->response.error = error;
+    if (call->done) call->done(std::move(call->response));
+    call.reset();
+    std::lock_guard<std::mutex> lock(mtx);
+    live--;
+    released.notify_all();
+}
+
+// Body bytes, up to Content-Length when the server sent one
+void Body(Call* call, const char* data, size_t n)
+{
+    if (call->remaining >= 0 && (long long)n > call->remaining) n = (size_t)call->remaining;
+    if (n) {
+        if (call->request.onChunk) call->request.onChunk(std::string_view(data, n));
+        else call->response.body.append(data, n);
+    }
+    if (call->remaining >= 0) {
+        call->remaining -= (long long)n;
+        if (call->remaining == 0) Finish(call, Error::None);
+    }
+}
+
+// Collects the status line and headers, then hands on what follows them
+void Consume(Call* call, const char* data, size_t n)
+{
+    if (call->headersDone) { Body(call, data, n); return; }
+    call->head.append(data, n);
+    size_t end = call->head.find("\r\n\r\n");
+    if (end == std::string::npos) {
+        if (call->head.size() > MAX_HEADERS) Finish(call, Error::Network);
+        return;
+    }
+    std::string head = call->head.substr(0, end + 2);
+    std::string rest = call->head.substr(end + 4);
+    call->head.clear();
+    call->headersDone = true;
+
+    if (head.compare(0, 7, "HTTP/1.") != 0 || head.size() < 12) { Finish(call, Error::Network); return; }
+    call->response.status = (uint32_t)std::strtoul(head.c_str() + 9, nullptr, 10);
+    for (size_t at = head.find("\r\n") + 2; at < head.size();) {
+        size_t eol = head.find("\r\n", at);
+        std::string line = head.substr(at, eol - at);
+        at = eol + 2;
+        if (line.size() > 15 && strncasecmp(line.c_str(), "Content-Length:", 15) == 0)
+            call->remaining = std::strtoll(line.c_str() + 15, nullptr, 10);
+    }
+    if (call->remaining == 0) { Finish(call, Error::None); return; }
+    Body(call, rest.data(), rest.size());
+}
+
+// connect -> write the request -> read until Content-Length or close
+void Step(Call* call, uint32_t events)
+{
+    if (!call->connected) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(call->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err) { Finish(call, Error::Network); return; }
+        call->connected = true;
+    }
+    if (call->sent < call->out.size()) {
+        ssize_t n = send(call->fd, call->out.data() + call->sent, call->out.size() - call->sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) Finish(call, Error::Network);
+            return;
+        }
+        call->sent += (size_t)n;
+        if (call->sent < call->out.size()) return;
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.u64 = call->id;
+        epoll_ctl(epfd, EPOLL_CTL_MOD, call->fd, &ev);
+        return;
+    }
+    if (!(events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) return;
+
+    char buf[16384];
+    Http::RequestId id = call->id;
+    for (;;) {
+        ssize_t n = recv(call->fd, buf, sizeof(buf), 0);
+        if (n > 0) {
+            Consume(call, buf, (size_t)n);
+            // Finished by the last bytes, and gone
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!calls.count(id)) return;
+            continue;
+        }
+        if (n == 0) Finish(call, call->headersDone && call->remaining < 0 ? Error::None : Error::Network);
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) Finish(call, Error::Network);
+        return;
+    }
+}
+
+void Run()
+{
+    epoll_event events[64];
+    for (;;) {
+        int n = epoll_wait(epfd, events, 64, -1);
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.u64 == 0) {
+                uint64_t count;
+                if (read(wake, &count, sizeof(count)) < 0) {}
+                continue;
+            }
+            Call* call;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                auto it = calls.find(events[i].data.u64);
+                if (it == calls.end()) continue;
+                call = it->second.get();
+            }
+            Step(call, events[i].events);
+        }
+
+        // Complete whatever was cancelled, timed out or stopped meanwhile
+        std::vector<Call*> marked;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (quit) return;
+            for (const auto& entry : calls)
+                if (entry.second->abort != Error::None) marked.push_back(entry.second.get());
+        }
+        for (Call* call : marked) Finish(call, Error::None);
+    }
+}
+
+} // namespace
+
+void Http::Start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (accepting) return;
+
+    std::string host = Narrow(SERVER_HOST);
+    std::string port = std::to_string(SERVER_PORT);
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0 || !found) return;
+    std::memcpy(&server, found->ai_addr, found->ai_addrlen);
+    serverLen = found->ai_addrlen;
+    freeaddrinfo(found);
+    hostHeader = host + ":" + port;
+
+    if (!io.joinable()) {
+        epfd = epoll_create1(EPOLL_CLOEXEC);
+        wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.u64 = 0;
+        epoll_ctl(epfd, EPOLL_CTL_ADD, wake, &ev);
+        quit = false;
+        io = std::thread(Run);
+    }
+    accepting = true;
+}
+
+Http::StopResult Http::Stop(std::chrono::steady_clock::time_point until)
+{
+    StopResult result;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        accepting = false;
+        for (auto& entry : calls)
+            if (entry.second->abort == Error::None) {
+                entry.second->abort = Error::Cancelled;
+                result.cancelled++;
+            }
+    }
+    if (wake >= 0) Wake();
+
+    std::unique_lock<std::mutex> lock(mtx);
+    released.wait_until(lock, until, [] { return live == 0; });
+    result.stillOpen = (int)live;
+    // A completion still running keeps the thread
+    if (live > 0 || !io.joinable()) return result;
+    quit = true;
+    lock.unlock();
+    Wake();
+    io.join();
+    close(wake);
+    close(epfd);
+    wake = epfd = -1;
+    return result;
+}
+
+Http::RequestId Http::Send(HttpRequest request, Completion done)
+{
+    auto call = std::make_unique<Call>();
+    call->request = std::move(request);
+    call->done = std::move(done);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    int fd = accepting ? socket(server.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0) : -1;
+    if (fd < 0) {
+        lock.unlock();
+        HttpResponse response;
+        response.error = Error::Refused;
+        if (call->done) call->done(std::move(response));
+        return 0;
+    }
+
+    // HTTP/1.0, so the answer is never chunked and the server closes after it
+    const HttpRequest& r = call->request;
+    call->out = Narrow(r.method) + " " + Narrow(r.path) + " HTTP/1.0\r\nHost: " + hostHeader +
+        "\r\nContent-Length: " + std::to_string(r.body.size()) + "\r\n" + Narrow(r.headers) + "\r\n" + r.body;
+    call->fd = fd;
+    RequestId id = call->id = nextId++;
+    if (connect(fd, (const sockaddr*)&server, serverLen) != 0 && errno != EINPROGRESS)
+        call->abort = Error::Network;
+    call->deadline = Scheduler::After(r.timeout, [id]() { Mark(id, Error::Timeout); });
+    Call* raw = call.get();
+    calls[id] = std::move(call);
+    live++;
+
+    epoll_event ev{};
+    ev.events = EPOLLOUT;
+    ev.data.u64 = id;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+    bool failed = raw->abort != Error::None;
+    lock.unlock();
+    if (failed) Wake();
+    return id;
+}
+
+bool Http::Cancel(RequestId id)
+{
+    return Mark(id, Error::Cancelled);
+}
+
+size_t Http::InFlight()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return calls.size();
+}
+#endif
@@ -21,8 +21,9 @@
 #include <climits>
 #include <limits>
 
-// Forward to project's root pch if present (optional).
-#if defined(__has_include)
+// Forward to project's root pch if present (optional). The tools build
+// ImGui on its own with IMGUI_NO_ROOT_PCH, as the root one needs the SDK.
+#if defined(__has_include) && !defined(IMGUI_NO_ROOT_PCH)
 #  if __has_include("../pch.h")
 #    include "../pch.h"
 #  endif
@@ -0,0 +1,308 @@
+#include "Importer.h"
+#include "Codec.h"
+#include "json.hpp"
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <chrono>
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr char    AGG_MAGIC[4] = { 'M', 'T', 'K', 'H' };
+constexpr uint8_t AGG_VERSION = 3;
+
+// ── Field helpers — older files stored some numbers as strings ───────────────
+
+int GetInt(const json& obj, const char* key, int fallback = 0)
+{
+    auto it = obj.find(key);
+    if (it == obj.end()) return fallback;
+    if (it->is_number_integer() || it->is_number_unsigned()) return it->get<int>();
+    if (it->is_number_float()) return (int)it->get<double>();
+    if (it->is_string()) {
+        try { return std::stoi(it->get<std::string>()); }
+        catch (...) { return fallback; }
+    }
+    return fallback;
+}
+
+std::string GetString(const json& obj, const char* key, const std::string& fallback)
+{
+    auto it = obj.find(key);
+    if (it == obj.end() || !it->is_string()) return fallback;
+    std::string s = it->get<std::string>();
+    return s.empty() ? fallback : s;
+}
+
+int64_t ParseStartTime(const json& obj)
+{
+    auto it = obj.find("startTime");
+    if (it == obj.end()) return 0;
+    if (it->is_number()) {
+        int64_t v = it->get<int64_t>();
+        return v > 100000000000LL ? v / 1000 : v;   // accept ms timestamps
+    }
+    if (!it->is_string()) return 0;
+
+    // SaveToFile writes local time as %Y-%m-%dT%H:%M:%S
+    std::tm tm = {};
+    std::istringstream ss(it->get<std::string>());
+    ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    if (ss.fail()) return 0;
+    tm.tm_isdst = -1;
+    return (int64_t)std::mktime(&tm);
+}
+
+bool ParseShot(const json& shotData, int shotNum, ImportedShot& shot)
+{
+    if (!shotData.is_object()) return false;
+    shot.shotNum = shotNum;
+    shot.shotType = GetString(shotData, "shotType", "Unknown");
+    shot.attempts = std::max(0, GetInt(shotData, "attempts"));
+    shot.goals = std::clamp(GetInt(shotData, "goals"), 0, shot.attempts);
+
+    auto hist = shotData.find("attemptHistory");
+    if (hist != shotData.end() && hist->is_array()) {
+        shot.attemptHistory.reserve(hist->size());
+        for (const auto& v : *hist) {
+            if (v.is_boolean()) shot.attemptHistory.push_back(v.get<bool>());
+            else if (v.is_number()) shot.attemptHistory.push_back(v.get<int>() != 0);
+        }
+    }
+
+    // Files from before attempts were timed have none
+    auto times = shotData.find("attemptTimes");
+    if (times != shotData.end() && times->is_array()) {
+        shot.attemptTimes.reserve(times->size());
+        for (const auto& v : *times)
+            shot.attemptTimes.push_back(v.is_number() ? (uint32_t)std::max<int64_t>(0, v.get<int64_t>()) : 0);
+        // Whole attempts, at most one per counted attempt, newest kept
+        size_t keep = std::min(timing::Count(shot.attemptTimes), (size_t)shot.attempts) * timing::STRIDE;
+        shot.attemptTimes.erase(shot.attemptTimes.begin(), shot.attemptTimes.end() - keep);
+    }
+    return true;
+}
+
+} // namespace
+
+template<>
+struct codec::Schema<ImportedShot> {
+    static constexpr auto fields = std::make_tuple(
+        Member<ImportedShot, int>{ "shotNum", &ImportedShot::shotNum },
+        Member<ImportedShot, std::string>{ "shotType", &ImportedShot::shotType },
+        Member<ImportedShot, int>{ "attempts", &ImportedShot::attempts },
+        Member<ImportedShot, int>{ "goals", &ImportedShot::goals },
+        Member<ImportedShot, std::vector<bool>>{ "attemptHistory", &ImportedShot::attemptHistory },
+        Member<ImportedShot, std::vector<uint32_t>>{ "attemptTimes", &ImportedShot::attemptTimes }
+    );
+};
+
+template<>
+struct codec::Schema<ImportedSession> {
+    static constexpr auto fields = std::make_tuple(
+        Member<ImportedSession, std::string>{ "sessionId", &ImportedSession::sessionId },
+        Member<ImportedSession, bool>{ "completed", &ImportedSession::completed },
+        Member<ImportedSession, int64_t>{ "startTime", &ImportedSession::startTime },
+        Member<ImportedSession, int>{ "durationMinutes", &ImportedSession::durationMinutes },
+        Member<ImportedSession, std::vector<ImportedShot>>{ "shots", &ImportedSession::shots }
+    );
+};
+
+std::vector<std::filesystem::path> Importer::Discover(const std::filesystem::path& folder)
+{
+    std::vector<std::filesystem::path> files;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(folder, ec)) {
+        if (!entry.is_regular_file(ec)) continue;
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("session_", 0) == 0 && entry.path().extension() == ".json")
+            files.push_back(entry.path());
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+bool Importer::Parse(const std::string& text, const std::string& fallbackId, ImportedSession& out)
+{
+    json root = json::parse(text, nullptr, false);
+    if (root.is_discarded() || !root.is_object()) return false;
+
+    out.sessionId = GetString(root, "sessionId", fallbackId);
+    out.completed = GetString(root, "status", "completed") != "active";
+    out.startTime = ParseStartTime(root);
+    out.durationMinutes = std::max(0, GetInt(root, "durationMinutes"));
+    out.shots.clear();
+
+    // "shots" is an object keyed by shot number; a session with no shots
+    // dumps as null, and server exports call it shots_data
+    auto shots = root.find("shots");
+    if (shots == root.end()) shots = root.find("shots_data");
+    if (shots == root.end() || shots->is_null()) return true;
+
+    if (shots->is_object()) {
+        for (auto& [key, shotData] : shots->items()) {
+            int shotNum;
+            try { shotNum = std::stoi(key); }
+            catch (...) { continue; }
+            ImportedShot shot;
+            if (ParseShot(shotData, shotNum, shot)) out.shots.push_back(std::move(shot));
+        }
+        std::sort(out.shots.begin(), out.shots.end(),
+            [](const ImportedShot& a, const ImportedShot& b) { return a.shotNum < b.shotNum; });
+    }
+    else if (shots->is_array()) {
+        int shotNum = 1;
+        for (const auto& shotData : *shots) {
+            ImportedShot shot;
+            if (ParseShot(shotData, GetInt(shotData, "shotNum", shotNum), shot))
+                out.shots.push_back(std::move(shot));
+            shotNum++;
+        }
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+ImportProgress Importer::Run(
+    const std::filesystem::path& folder,
+    const std::filesystem::path& outFile,
+    unsigned threads,
+    std::function<void(const ImportProgress&)> onProgress,
+    const std::atomic<bool>* cancel)
+{
+    const auto files = Discover(folder);
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<ImportedSession> sessions(files.size());
+    std::vector<char>            parsed(files.size(), 0);
+
+    std::atomic<size_t>   next{ 0 };
+    std::atomic<size_t>   done{ 0 };
+    std::atomic<size_t>   skipped{ 0 };
+    std::atomic<uint64_t> bytes{ 0 };
+    std::mutex              mtx;
+    std::condition_variable cv;
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = (unsigned)std::min<size_t>(threads, std::max<size_t>(1, files.size()));
+
+    // Files are handed out one at a time from a shared counter so a few huge
+    // sessions don't leave the other workers idle. Each worker reuses one
+    // read buffer for every file it parses.
+    auto worker = [&]() {
+        std::string buf;
+        for (size_t i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1)) {
+            if (cancel && *cancel) {
+                // Count the rest as done so the progress loop can finish
+                if (++done == files.size()) {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    cv.notify_all();
+                }
+                continue;
+            }
+            std::ifstream in(files[i], std::ios::binary | std::ios::ate);
+            bool ok = false;
+            if (in.is_open()) {
+                std::streamsize size = in.tellg();
+                in.seekg(0);
+                buf.resize(size > 0 ? (size_t)size : 0);
+                if (size > 0 && in.read(buf.data(), size)) {
+                    bytes += (uint64_t)size;
+                    std::string fallbackId = files[i].stem().string().substr(8); // strip "session_"
+                    ok = Parse(buf, fallbackId, sessions[i]);
+                }
+            }
+            parsed[i] = ok ? 1 : 0;
+            if (!ok) skipped++;
+            if (++done == files.size()) {
+                std::lock_guard<std::mutex> lock(mtx);
+                cv.notify_all();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) pool.emplace_back(worker);
+
+    auto snapshot = [&]() {
+        ImportProgress p;
+        p.filesDone = done;
+        p.filesTotal = files.size();
+        p.filesSkipped = skipped;
+        p.bytesRead = bytes;
+        p.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return p;
+    };
+
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (done < files.size()) {
+            cv.wait_for(lock, std::chrono::milliseconds(250));
+            if (onProgress && done < files.size()) {
+                lock.unlock();
+                onProgress(snapshot());
+                lock.lock();
+            }
+        }
+    }
+    for (auto& t : pool) t.join();
+
+    std::vector<ImportedSession> good;
+    good.reserve(files.size());
+    for (size_t i = 0; i < files.size(); i++)
+        if (parsed[i]) good.push_back(std::move(sessions[i]));
+    std::stable_sort(good.begin(), good.end(),
+        [](const ImportedSession& a, const ImportedSession& b) { return a.startTime < b.startTime; });
+
+    bool written = !(cancel && *cancel) && WriteAggregate(outFile, good);
+
+    ImportProgress result = snapshot();
+    result.written = written;
+    if (onProgress) onProgress(result);
+    return result;
+}
+
+bool Importer::WriteAggregate(const std::filesystem::path& outFile,
+    const std::vector<ImportedSession>& sessions)
+{
+    std::string out(AGG_MAGIC, sizeof(AGG_MAGIC));
+    out.push_back((char)AGG_VERSION);
+    codec::Encode(out, sessions);
+
+    // Write beside the target and rename so a crash never leaves half a file
+    std::filesystem::path tmp = outFile;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        file.write(out.data(), (std::streamsize)out.size());
+        if (!file) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, outFile, ec);
+    return !ec;
+}
+
+bool Importer::ReadAggregate(const std::filesystem::path& inFile,
+    std::vector<ImportedSession>& sessions)
+{
+    std::ifstream file(inFile, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::string in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (in.size() < 5 || in.compare(0, 4, AGG_MAGIC, 4) != 0 || (uint8_t)in[4] != AGG_VERSION)
+        return false;
+
+    size_t pos = 5;
+    return codec::Decode(in, pos, sessions);
+}
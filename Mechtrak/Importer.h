@@ -0,0 +1,71 @@
+#pragma once
+#include "AttemptTiming.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <cstdint>
+#include <atomic>
+
+// Bulk importer for the session_*.json files Session::SaveToFile leaves in
+// rl_best_stats. Kept free of BakkesMod / WinHTTP so tools/mechtrak_import.cpp
+// can build it as a standalone CLI.
+
+struct ImportedShot {
+    int shotNum = 0;
+    std::string shotType = "Unknown";
+    int attempts = 0;
+    int goals = 0;
+    std::vector<bool> attemptHistory;
+    std::vector<uint32_t> attemptTimes;   // newest attempts only; see AttemptTiming.h
+};
+
+struct ImportedSession {
+    std::string sessionId;
+    bool completed = true;
+    int64_t startTime = 0;          // unix seconds, 0 if unknown
+    int durationMinutes = 0;
+    std::vector<ImportedShot> shots;
+};
+
+struct ImportProgress {
+    size_t   filesDone = 0;
+    size_t   filesTotal = 0;
+    size_t   filesSkipped = 0;
+    uint64_t bytesRead = 0;
+    double   elapsedSec = 0.0;
+    bool     written = false;   // the aggregate reached outFile (Run only)
+
+    double FilesPerSec() const { return elapsedSec > 0.0 ? filesDone / elapsedSec : 0.0; }
+    double MBPerSec()    const { return elapsedSec > 0.0 ? bytesRead / (1024.0 * 1024.0) / elapsedSec : 0.0; }
+};
+
+class Importer {
+public:
+    // Finds every session_*.json directly inside folder, sorted by name.
+    static std::vector<std::filesystem::path> Discover(const std::filesystem::path& folder);
+
+    // Parses one session file, normalizing older / hand-edited schemas.
+    // Returns false if the text is not a usable session.
+    static bool Parse(const std::string& text, const std::string& fallbackId, ImportedSession& out);
+
+    // Parses every discovered file on `threads` workers (0 = hardware
+    // concurrency) and writes the compact aggregate to outFile.
+    // onProgress is called from the calling thread roughly every 250 ms.
+    // Setting *cancel stops the workers and skips writing outFile; check
+    // `written` on the result either way.
+    static ImportProgress Run(
+        const std::filesystem::path& folder,
+        const std::filesystem::path& outFile,
+        unsigned threads,
+        std::function<void(const ImportProgress&)> onProgress,
+        const std::atomic<bool>* cancel = nullptr
+    );
+
+    // Compact aggregate format (history.mtk): "MTKH", u8 version, then the
+    // session list in the binary codec (see codec::Schema in Importer.cpp).
+    static bool WriteAggregate(const std::filesystem::path& outFile,
+        const std::vector<ImportedSession>& sessions);
+    static bool ReadAggregate(const std::filesystem::path& inFile,
+        std::vector<ImportedSession>& sessions);
+};
@@ -0,0 +1,279 @@
+#include "JsonReader.h"
+#include <charconv>
+#include <cstring>
+
+void JsonStreamParser::Reset()
+{
+    stack.clear();
+    token.clear();
+    lex = Lex::None;
+    expect = Expect::Value;
+    stringIsKey = false;
+    escape = false;
+    unicodeDigits = -1;
+    unicodeAcc = 0;
+    highSurrogate = 0;
+    failed = false;
+    error.clear();
+}
+
+bool JsonStreamParser::Fail(const char* msg)
+{
+    failed = true;
+    error = msg;
+    return false;
+}
+
+bool JsonStreamParser::BeginValue()
+{
+    if (expect != Expect::Value && expect != Expect::ValueOrEnd)
+        return Fail("unexpected value");
+    return true;
+}
+
+void JsonStreamParser::AfterValue()
+{
+    expect = stack.empty() ? Expect::Done : Expect::CommaOrEnd;
+}
+
+bool JsonStreamParser::EmitNumber()
+{
+    lex = Lex::None;
+    const char* first = token.data();
+    const char* last = first + token.size();
+    bool isFloat = token.find_first_of(".eE") != std::string::npos;
+    bool ok = false;
+    if (!isFloat) {
+        int64_t v = 0;
+        auto r = std::from_chars(first, last, v);
+        if (r.ec == std::errc::result_out_of_range) isFloat = true;
+        else if (r.ec != std::errc() || r.ptr != last) return Fail("bad number");
+        else ok = handler.Int(v);
+    }
+    if (isFloat) {
+        double d = 0.0;
+        auto r = std::from_chars(first, last, d);
+        if (r.ec != std::errc() || r.ptr != last) return Fail("bad number");
+        ok = handler.Float(d);
+    }
+    token.clear();
+    if (!ok) return Fail("aborted by handler");
+    AfterValue();
+    return true;
+}
+
+bool JsonStreamParser::EmitLiteral()
+{
+    lex = Lex::None;
+    bool ok = false;
+    if (token == "true") ok = handler.Bool(true);
+    else if (token == "false") ok = handler.Bool(false);
+    else if (token == "null") ok = handler.Null();
+    else return Fail("bad literal");
+    token.clear();
+    if (!ok) return Fail("aborted by handler");
+    AfterValue();
+    return true;
+}
+
+bool JsonStreamParser::EmitString()
+{
+    lex = Lex::None;
+    bool ok = stringIsKey ? handler.Key(token) : handler.String(token);
+    token.clear();
+    if (!ok) return Fail("aborted by handler");
+    if (stringIsKey) expect = Expect::Colon;
+    else AfterValue();
+    return true;
+}
+
+void JsonStreamParser::AppendUtf8(uint32_t cp)
+{
+    if (cp < 0x80) {
+        token.push_back((char)cp);
+    }
+    else if (cp < 0x800) {
+        token.push_back((char)(0xC0 | (cp >> 6)));
+        token.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000) {
+        token.push_back((char)(0xE0 | (cp >> 12)));
+        token.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        token.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+    else {
+        token.push_back((char)(0xF0 | (cp >> 18)));
+        token.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+        token.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+        token.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Handles one character of a string body that is part of an escape sequence
+// or the closing quote; plain runs are appended in bulk by Feed().
+bool JsonStreamParser::StringChar(char c)
+{
+    if (unicodeDigits >= 0) {
+        uint32_t v;
+        if (c >= '0' && c <= '9') v = c - '0';
+        else if (c >= 'a' && c <= 'f') v = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v = c - 'A' + 10;
+        else return Fail("bad \\u escape");
+        unicodeAcc = (unicodeAcc << 4) | v;
+        if (++unicodeDigits < 4) return true;
+        unicodeDigits = -1;
+
+        if (unicodeAcc >= 0xD800 && unicodeAcc <= 0xDBFF) {
+            highSurrogate = unicodeAcc;
+        }
+        else if (unicodeAcc >= 0xDC00 && unicodeAcc <= 0xDFFF && highSurrogate) {
+            AppendUtf8(0x10000 + ((highSurrogate - 0xD800) << 10) + (unicodeAcc - 0xDC00));
+            highSurrogate = 0;
+        }
+        else {
+            AppendUtf8(unicodeAcc);
+            highSurrogate = 0;
+        }
+        return true;
+    }
+
+    if (escape) {
+        escape = false;
+        switch (c) {
+        case '"':  token.push_back('"'); break;
+        case '\\': token.push_back('\\'); break;
+        case '/':  token.push_back('/'); break;
+        case 'b':  token.push_back('\b'); break;
+        case 'f':  token.push_back('\f'); break;
+        case 'n':  token.push_back('\n'); break;
+        case 'r':  token.push_back('\r'); break;
+        case 't':  token.push_back('\t'); break;
+        case 'u':  unicodeDigits = 0; unicodeAcc = 0; break;
+        default:   return Fail("bad escape");
+        }
+        return true;
+    }
+
+    if (c == '\\') { escape = true; return true; }
+    if (c == '"') return EmitString();
+    token.push_back(c);
+    return true;
+}
+
+bool JsonStreamParser::Structural(char c)
+{
+    switch (c) {
+    case ' ': case '\t': case '\n': case '\r':
+        return true;
+
+    case '{':
+    case '[':
+        if (!BeginValue()) return false;
+        stack.push_back(c);
+        if (!(c == '{' ? handler.StartObject() : handler.StartArray())) return Fail("aborted by handler");
+        expect = c == '{' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+        return true;
+
+    case '}':
+    case ']': {
+        char open = c == '}' ? '{' : '[';
+        Expect emptyOk = c == '}' ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+        if (stack.empty() || stack.back() != open || (expect != emptyOk && expect != Expect::CommaOrEnd))
+            return Fail("unexpected close");
+        stack.pop_back();
+        if (!(c == '}' ? handler.EndObject() : handler.EndArray())) return Fail("aborted by handler");
+        AfterValue();
+        return true;
+    }
+
+    case ':':
+        if (expect != Expect::Colon) return Fail("unexpected ':'");
+        expect = Expect::Value;
+        return true;
+
+    case ',':
+        if (expect != Expect::CommaOrEnd) return Fail("unexpected ','");
+        expect = stack.back() == '{' ? Expect::Key : Expect::Value;
+        return true;
+
+    case '"':
+        if (expect == Expect::Key || expect == Expect::KeyOrEnd) stringIsKey = true;
+        else if (BeginValue()) stringIsKey = false;
+        else return false;
+        lex = Lex::String;
+        return true;
+
+    case 't': case 'f': case 'n':
+        if (!BeginValue()) return false;
+        lex = Lex::Literal;
+        token.push_back(c);
+        return true;
+
+    default:
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            if (!BeginValue()) return false;
+            lex = Lex::Number;
+            token.push_back(c);
+            return true;
+        }
+        return Fail("unexpected character");
+    }
+}
+
+bool JsonStreamParser::Feed(const char* data, size_t len)
+{
+    if (failed) return false;
+    const char* p = data;
+    const char* end = data + len;
+
+    while (p < end) {
+        switch (lex) {
+        case Lex::String: {
+            // Copy the run up to the next quote/backslash in one go
+            if (!escape && unicodeDigits < 0) {
+                const char* q = p;
+                while (q < end && *q != '"' && *q != '\\') q++;
+                token.append(p, q - p);
+                p = q;
+                if (p == end) break;
+            }
+            if (!StringChar(*p++)) return false;
+            break;
+        }
+        case Lex::Number: {
+            char c = *p;
+            if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+                token.push_back(c);
+                p++;
+            }
+            else if (!EmitNumber()) return false;
+            break;
+        }
+        case Lex::Literal: {
+            char c = *p;
+            if (c >= 'a' && c <= 'z') {
+                token.push_back(c);
+                p++;
+                if (token.size() > 5) return Fail("bad literal");
+            }
+            else if (!EmitLiteral()) return false;
+            break;
+        }
+        case Lex::None:
+            if (expect == Expect::Done && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+                return Fail("trailing data");
+            if (!Structural(*p++)) return false;
+            break;
+        }
+    }
+    return true;
+}
+
+bool JsonStreamParser::Finish()
+{
+    if (failed) return false;
+    if (lex == Lex::Number && !EmitNumber()) return false;
+    if (lex == Lex::Literal && !EmitLiteral()) return false;
+    if (lex == Lex::String || expect != Expect::Done) return Fail("unexpected end of input");
+    return true;
+}
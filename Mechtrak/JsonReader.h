@@ -0,0 +1,67 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+// Receives parse events from JsonStreamParser. Return false to stop parsing.
+class JsonHandler {
+public:
+    virtual ~JsonHandler() = default;
+    virtual bool StartObject()           { return true; }
+    virtual bool EndObject()             { return true; }
+    virtual bool StartArray()            { return true; }
+    virtual bool EndArray()              { return true; }
+    virtual bool Key(std::string_view)   { return true; }
+    virtual bool String(std::string_view){ return true; }
+    virtual bool Int(int64_t)            { return true; }
+    virtual bool Float(double)           { return true; }
+    virtual bool Bool(bool)              { return true; }
+    virtual bool Null()                  { return true; }
+};
+
+// Incremental (push) JSON parser. Feed() takes the body in whatever chunks
+// the transport delivers; tokens split across chunks are carried over, so
+// the full response never has to be buffered or turned into a DOM.
+class JsonStreamParser {
+public:
+    explicit JsonStreamParser(JsonHandler& handler) : handler(handler) {}
+
+    bool Feed(const char* data, size_t len);
+    bool Feed(std::string_view chunk) { return Feed(chunk.data(), chunk.size()); }
+
+    // Flushes a trailing number/literal; true if exactly one complete
+    // document was parsed without errors.
+    bool Finish();
+
+    bool Failed() const { return failed; }
+    const std::string& Error() const { return error; }
+    void Reset();
+
+private:
+    enum class Lex : uint8_t { None, String, Number, Literal };
+    enum class Expect : uint8_t { Value, ValueOrEnd, Key, KeyOrEnd, Colon, CommaOrEnd, Done };
+
+    JsonHandler& handler;
+    std::vector<char> stack;     // '{' or '['
+    std::string token;           // partial string / number / literal
+    Lex    lex = Lex::None;
+    Expect expect = Expect::Value;
+    bool   stringIsKey = false;
+    bool   escape = false;
+    int    unicodeDigits = -1;   // >= 0 while reading \uXXXX
+    uint32_t unicodeAcc = 0;
+    uint32_t highSurrogate = 0;
+    bool   failed = false;
+    std::string error;
+
+    bool Fail(const char* msg);
+    bool BeginValue();
+    void AfterValue();
+    bool EmitNumber();
+    bool EmitLiteral();
+    bool EmitString();
+    bool StringChar(char c);
+    void AppendUtf8(uint32_t cp);
+    bool Structural(char c);
+};
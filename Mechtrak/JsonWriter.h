@@ -0,0 +1,116 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+// Minimal streaming JSON writer. Appends straight into a caller-owned buffer
+// so repeated saves reuse one allocation instead of building a json tree.
+// Pretty mode matches nlohmann's dump(2) layout and is meant for debugging.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out, bool pretty = false) : out(out), pretty(pretty) {}
+
+    void BeginObject() { Prefix(); out.push_back('{'); Push(); }
+    void EndObject()   { Pop(); out.push_back('}'); }
+    void BeginArray()  { Prefix(); out.push_back('['); Push(); }
+    void EndArray()    { Pop(); out.push_back(']'); }
+
+    void Key(std::string_view k)
+    {
+        Prefix();
+        Quoted(k);
+        out.append(pretty ? ": " : ":");
+        afterKey = true;
+    }
+
+    void String(std::string_view s) { Prefix(); Quoted(s); }
+    void Bool(bool b)               { Prefix(); out.append(b ? "true" : "false"); }
+    void Null()                     { Prefix(); out.append("null"); }
+
+    void Int(int64_t v)
+    {
+        Prefix();
+        char buf[24];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, r.ptr);
+    }
+
+    // Shortest round-trip form, always with a fraction like nlohmann ("0.0").
+    // JSON has no NaN or infinity; those are written as null, as nlohmann does.
+    void Float(double v)
+    {
+        Prefix();
+        if (!std::isfinite(v)) { out.append("null"); return; }
+        char buf[32];
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, r.ptr);
+        if (std::string_view(buf, r.ptr - buf).find_first_of(".eE") == std::string_view::npos)
+            out.append(".0");
+    }
+
+private:
+    std::string& out;
+    bool     pretty = false;
+    bool     afterKey = false;
+    int      depth = 0;
+    uint64_t hasItems = 0;   // bit per nesting level
+
+    void Newline()
+    {
+        out.push_back('\n');
+        out.append((size_t)depth * 2, ' ');
+    }
+
+    void Prefix()
+    {
+        if (afterKey) { afterKey = false; return; }
+        if (depth == 0) return;
+        const uint64_t bit = 1ull << (depth & 63);
+        if (hasItems & bit) out.push_back(',');
+        hasItems |= bit;
+        if (pretty) Newline();
+    }
+
+    void Push()
+    {
+        depth++;
+        hasItems &= ~(1ull << (depth & 63));
+    }
+
+    void Pop()
+    {
+        const bool had = (hasItems >> (depth & 63)) & 1;
+        depth--;
+        if (pretty && had) Newline();
+    }
+
+    void Quoted(std::string_view s)
+    {
+        static const char* HEX = "0123456789abcdef";
+        out.push_back('"');
+        size_t run = 0;
+        for (size_t i = 0; i < s.size(); i++) {
+            unsigned char c = (unsigned char)s[i];
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+            case '"':  out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            case '\b': out.append("\\b"); break;
+            case '\f': out.append("\\f"); break;
+            default:
+                out.append("\\u00");
+                out.push_back(HEX[c >> 4]);
+                out.push_back(HEX[c & 15]);
+            }
+        }
+        out.append(s.data() + run, s.size() - run);
+        out.push_back('"');
+    }
+};
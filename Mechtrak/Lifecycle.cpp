@@ -0,0 +1,111 @@
+#include "Lifecycle.h"
+#include "Scheduler.h"
+#include "Http.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <list>
+#include <algorithm>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Share of the shutdown deadline kept back from the flush for WinHTTP to
+// release the requests Http::Stop cancels
+constexpr std::chrono::milliseconds CLOSE_RESERVE{ 500 };
+
+struct Worker {
+    std::thread       thread;
+    std::atomic<bool> done{ false };
+};
+
+std::mutex                    mtx;
+std::list<Worker>             workers;
+std::atomic<bool>             cancelWorkers{ false };
+std::atomic<bool>             stopping{ false };
+
+// Caller holds mtx. Joins workers that already finished.
+void ReapLocked()
+{
+    for (auto it = workers.begin(); it != workers.end();) {
+        if (it->done) {
+            if (it->thread.joinable()) it->thread.join();
+            it = workers.erase(it);
+        }
+        else ++it;
+    }
+}
+
+} // namespace
+
+void Lifecycle::Start()
+{
+    stopping = false;
+    cancelWorkers = false;
+    Scheduler::Start();
+    Http::Start();
+}
+
+void Lifecycle::Spawn(std::function<void(const std::atomic<bool>& cancel)> fn)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stopping) return;
+    ReapLocked();
+    workers.emplace_back();
+    Worker& w = workers.back();
+    w.thread = std::thread([fn = std::move(fn), &w]() {
+        fn(cancelWorkers);
+        w.done = true;
+    });
+}
+
+Lifecycle::ShutdownReport Lifecycle::Shutdown(std::function<void(std::function<void()> done)> flush,
+    std::chrono::milliseconds deadline)
+{
+    ShutdownReport report;
+    auto start = Clock::now();
+    auto reserve = std::min(CLOSE_RESERVE, deadline / 4);
+
+    // Queue the flush behind whatever the scheduler is running now
+    auto state = std::make_shared<std::pair<std::mutex, std::condition_variable>>();
+    auto finished = std::make_shared<bool>(false);
+    bool armed = flush && Scheduler::After(std::chrono::milliseconds(0), [flush, state, finished]() {
+        flush([state, finished]() {
+            std::lock_guard<std::mutex> lock(state->first);
+            *finished = true;
+            state->second.notify_all();
+        });
+    }) != 0;
+    if (armed) {
+        std::unique_lock<std::mutex> lock(state->first);
+        report.flushed = state->second.wait_until(lock, start + deadline - reserve, [&] { return *finished; });
+    }
+
+    stopping = true;
+    cancelWorkers = true;
+    Http::StopResult http = Http::Stop(start + deadline);
+    report.requestsCancelled = http.cancelled;
+    report.requestsStuck = http.stillOpen;
+
+    // Completions of the cancelled requests still queued go with the timers
+    Scheduler::Stop();
+
+    std::list<Worker> remaining;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        remaining.splice(remaining.end(), workers);
+    }
+    for (auto& w : remaining) {
+        if (w.thread.joinable()) w.thread.join();
+        report.threadsJoined++;
+    }
+
+    report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+    return report;
+}
+
+bool Lifecycle::ShuttingDown()
+{
+    return stopping;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include <string>
+
+// Owns everything that can outlive a plugin callback: the Scheduler thread,
+// one-off worker threads and the Http transport. Shutdown() flushes what
+// it can within a deadline, aborts whatever is still on the network and
+// joins every thread, so nothing touches the plugin after onUnload returns.
+class Lifecycle {
+public:
+    struct ShutdownReport {
+        bool flushed = false;              // flush finished inside the deadline
+        int  requestsCancelled = 0;
+        // Requests WinHTTP still held at the deadline. Not 0 means WinHTTP
+        // may call into the plugin after it is gone.
+        int  requestsStuck = 0;
+        int  threadsJoined = 0;
+        std::chrono::milliseconds elapsed{ 0 };
+    };
+
+    // Clears a previous shutdown and starts the Scheduler and Http
+    static void Start();
+
+    // Runs fn on a tracked thread. fn should return soon after cancel is set.
+    static void Spawn(std::function<void(const std::atomic<bool>& cancel)> fn);
+
+    // 1. Starts flush on the Scheduler thread and waits for it to call done,
+    //    leaving part of deadline for 2
+    // 2. Stops Http, cancelling every request in flight and waiting, up to
+    //    deadline, for WinHTTP to release each one
+    // 3. Stops the Scheduler and joins every Spawned thread
+    static ShutdownReport Shutdown(std::function<void(std::function<void()> done)> flush,
+        std::chrono::milliseconds deadline);
+
+    static bool ShuttingDown();
+};
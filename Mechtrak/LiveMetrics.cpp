@@ -0,0 +1,337 @@
+#include "LiveMetrics.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float Share(int goals, size_t attempts)
+{
+    return attempts > 0 ? (float)goals / (float)attempts : 0.f;
+}
+
+// A shot's outcomes by index, sealed attempts included
+struct Outcomes {
+    const ShotStats& s;
+    bool operator[](size_t i) const { return s.Outcome(i); }
+};
+
+} // namespace
+
+// ─── Stream ───────────────────────────────────────────────────────────────────
+
+template<typename H>
+void LiveMetrics::Stream::Push(const H& h, size_t count)
+{
+    n = count;
+    bool goal = h[n - 1];
+    goals += goal;
+    for (int k = 0; k < 3; k++) {
+        size_t w = (size_t)WINDOWS[k];
+        windowGoals[k] += goal;
+        if (n > w && n - 1 - w >= first) windowGoals[k] -= h[n - 1 - w];
+    }
+
+    if (goal) {
+        DropRun(streak);
+        AddRun(++streak);
+    }
+    else streak = 0;
+
+    ewma = EWMA_ALPHA * goal + (1.0 - EWMA_ALPHA) * ewma;
+    drop.Add(goal);
+}
+
+template<typename H>
+void LiveMetrics::Stream::Pop(const H& h, size_t count, bool removed)
+{
+    n = count;
+    goals -= removed;
+    for (int k = 0; k < 3; k++) {
+        size_t w = (size_t)WINDOWS[k];
+        windowGoals[k] -= removed;
+        if (n >= w && n - w >= first) windowGoals[k] += h[n - w];
+    }
+
+    if (removed) {
+        DropRun(streak);
+        AddRun(--streak);
+    }
+    else {
+        // The run before the miss was already counted as a maximal run
+        streak = RunBefore(h, n);
+    }
+
+    ewma = n > 0 ? (ewma - EWMA_ALPHA * removed) / (1.0 - EWMA_ALPHA) : 0.0;
+    Replay(h);
+}
+
+template<typename H>
+void LiveMetrics::Stream::Set(const H& h, size_t count, size_t i)
+{
+    n = count;
+    bool goal = h[i];
+    int d = goal ? 1 : -1;
+    goals += d;
+    for (int k = 0; k < 3; k++)
+        if (i + (size_t)WINDOWS[k] >= n) windowGoals[k] += d;
+
+    // The goal runs on either side join, or the one through i splits
+    int left = RunBefore(h, i), right = 0;
+    for (size_t j = i + 1; j < n && h[j]; j++) right++;
+    if (goal) {
+        DropRun(left);
+        DropRun(right);
+        AddRun(left + 1 + right);
+    }
+    else {
+        DropRun(left + 1 + right);
+        AddRun(left);
+        AddRun(right);
+    }
+    if (i + 1 + right == n) streak = goal ? left + 1 + right : right;
+
+    ewma += EWMA_ALPHA * std::pow(1.0 - EWMA_ALPHA, (double)(n - 1 - i)) * d;
+    Replay(h);
+}
+
+RollingStats LiveMetrics::Stream::Read() const
+{
+    RollingStats r;
+    r.last10 = Share(windowGoals[0], std::min(n, (size_t)WINDOWS[0]));
+    r.last25 = Share(windowGoals[1], std::min(n, (size_t)WINDOWS[1]));
+    r.last50 = Share(windowGoals[2], std::min(n, (size_t)WINDOWS[2]));
+    r.streak = streak;
+    r.bestStreak = runs.empty() ? 0 : runs.rbegin()->first;
+    if (n == 0) return r;
+
+    r.ewma = (float)(ewma / (1.0 - std::pow(1.0 - EWMA_ALPHA, (double)n)));
+
+    const double z = 1.96;
+    double p = (double)goals / n;
+    double z2n = z * z / n;
+    double center = (p + z2n / 2.0) / (1.0 + z2n);
+    double half = z * std::sqrt(p * (1.0 - p) / n + z2n / (4.0 * n)) / (1.0 + z2n);
+    r.wilsonLow = (float)std::max(0.0, center - half);
+    r.wilsonHigh = (float)std::min(1.0, center + half);
+
+    if (drop.Dropped()) {
+        r.dropped = true;
+        r.dropFrom = drop.Before();
+        r.dropTo = drop.Since();
+        r.dropLength = drop.Length();
+    }
+    return r;
+}
+
+void LiveMetrics::Stream::Cut(const Stream& before)
+{
+    first = before.n;
+    lead = before.streak;
+    dropBefore = before.drop;
+}
+
+void LiveMetrics::Stream::SetBefore(bool goal)
+{
+    goals += goal ? 1 : -1;
+}
+
+void LiveMetrics::Stream::PopBefore(bool removed)
+{
+    n--;
+    goals -= removed;
+    if (first > 0) first--;
+}
+
+template<typename H>
+void LiveMetrics::Stream::Recount(const H& h)
+{
+    for (int k = 0; k < 3; k++) {
+        size_t w = (size_t)WINDOWS[k];
+        windowGoals[k] = 0;
+        for (size_t i = std::max(n > w ? n - w : 0, first); i < n; i++) windowGoals[k] += h[i];
+    }
+}
+
+void LiveMetrics::Stream::AddRun(int length)
+{
+    if (length > 0) runs[length]++;
+}
+
+void LiveMetrics::Stream::DropRun(int length)
+{
+    if (length <= 0) return;
+    auto it = runs.find(length);
+    if (it != runs.end() && --it->second == 0) runs.erase(it);
+}
+
+template<typename H>
+int LiveMetrics::Stream::RunBefore(const H& h, size_t i) const
+{
+    size_t j = i;
+    while (j > first && h[j - 1]) j--;
+    return (int)(i - j) + (j == first ? lead : 0);
+}
+
+template<typename H>
+void LiveMetrics::Stream::Replay(const H& h)
+{
+    drop = dropBefore;
+    for (size_t i = first; i < n; i++) drop.Add(h[i]);
+}
+
+// ─── LiveMetrics ──────────────────────────────────────────────────────────────
+
+void LiveMetrics::Rebuild(const ShotTable& table)
+{
+    shots.clear();
+    session = Stream();
+    base = Stream();
+    sequence.clear();
+    positions.clear();
+    lost = false;
+    for (const auto& [num, s] : table) {
+        Outcomes h{ s };
+        Stream& stream = shots[num];
+        for (size_t i = 1; i <= s.Count(); i++) {
+            stream.Push(h, i);
+            Push(num, h[i - 1]);
+        }
+    }
+}
+
+void LiveMetrics::Apply(const ShotEvent& e, const ShotTable& table)
+{
+    auto it = table.find(e.shot);
+    if (it == table.end()) return;
+    Outcomes h{ it->second };
+    size_t n = it->second.Count();
+
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt: shots[e.shot].Push(h, n); Push(e.shot, h[n - 1]); break;
+    case ShotEvent::Kind::Flip:    shots[e.shot].Set(h, n, (size_t)e.index); Flip(e.shot, (size_t)e.index, h[e.index]); break;
+    case ShotEvent::Kind::Remove:  shots[e.shot].Pop(h, n, e.goal); Pop(e.shot, e.goal); break;
+    }
+    // Only if the table changed without an event, which Rebuild should have
+    // seen, or the session lost its order
+    if (lost || shots[e.shot].Size() != n || positions[e.shot].Size() != n) Rebuild(table);
+}
+
+void LiveMetrics::Revert(const ShotEvent& e, const ShotTable& table)
+{
+    auto it = table.find(e.shot);
+    if (it == table.end()) return;
+    Outcomes h{ it->second };
+    size_t n = it->second.Count();
+
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt: shots[e.shot].Pop(h, n, e.goal); Pop(e.shot, e.goal); break;
+    case ShotEvent::Kind::Flip:    shots[e.shot].Set(h, n, (size_t)e.index); Flip(e.shot, (size_t)e.index, h[e.index]); break;
+    case ShotEvent::Kind::Remove:  shots[e.shot].Push(h, n); Push(e.shot, h[n - 1]); break;
+    }
+    if (lost || shots[e.shot].Size() != n || positions[e.shot].Size() != n) Rebuild(table);
+}
+
+RollingStats LiveMetrics::Shot(int shot) const
+{
+    auto it = shots.find(shot);
+    return it != shots.end() ? it->second.Read() : RollingStats();
+}
+
+MetricsReport LiveMetrics::Report() const
+{
+    MetricsReport report;
+    report.session = session.Read();
+    for (const auto& [num, stream] : shots) report.shots.emplace(num, stream.Read());
+    return report;
+}
+
+MetricsReport LiveMetrics::Of(const ShotTable& table)
+{
+    LiveMetrics metrics;
+    metrics.Rebuild(table);
+    return metrics.Report();
+}
+
+void LiveMetrics::Push(int shot, bool goal)
+{
+    positions[shot].at.push_back(First() + sequence.size());
+    sequence.push_back(goal);
+    session.Push(Tail(), First() + sequence.size());
+    if (sequence.size() >= 2 * ORDER) Forget();
+}
+
+void LiveMetrics::Pop(int shot, bool removed)
+{
+    auto& pos = positions[shot];
+    if (pos.at.empty()) {
+        if (pos.forgotten == 0) return;
+        // Its place was folded away: only the totals follow, and every
+        // attempt still in order moves down one
+        pos.forgotten--;
+        base.PopBefore(removed);
+        session.PopBefore(removed);
+        for (auto& [num, places] : positions)
+            for (size_t& at : places.at) at--;
+        return;
+    }
+    size_t p = pos.at.back();
+    pos.at.pop_back();
+
+    size_t first = First();
+    if (p + 1 == first + sequence.size()) {
+        sequence.pop_back();
+        session.Pop(Tail(), first + sequence.size(), removed);
+    }
+    else {
+        // Another shot has been played since; close the gap and start over
+        sequence.erase(sequence.begin() + (p - first));
+        for (auto& [num, places] : positions)
+            for (size_t i = places.at.size(); i-- > 0 && places.at[i] > p;) places.at[i]--;
+        Restart();
+    }
+    // The windows would reach into the folded attempts
+    if (first > 0 && sequence.size() < (size_t)WINDOWS[2]) lost = true;
+}
+
+void LiveMetrics::Flip(int shot, size_t index, bool goal)
+{
+    auto& pos = positions[shot];
+    if (index < pos.forgotten) {
+        base.SetBefore(goal);
+        session.SetBefore(goal);
+        return;
+    }
+    index -= pos.forgotten;
+    if (index >= pos.at.size()) return;
+    size_t p = pos.at[index];
+    sequence[p - First()] = goal;
+    session.Set(Tail(), First() + sequence.size(), p);
+}
+
+void LiveMetrics::Forget()
+{
+    size_t from = First();
+    Order h = Tail();
+    base.Cut(base);
+    for (size_t i = from; i < from + ORDER; i++) base.Push(h, i + 1);
+    sequence.erase(sequence.begin(), sequence.begin() + ORDER);
+    session.Cut(base);
+
+    size_t first = First();
+    for (auto& [num, places] : positions) {
+        auto kept = std::lower_bound(places.at.begin(), places.at.end(), first);
+        places.forgotten += (size_t)(kept - places.at.begin());
+        places.at.erase(places.at.begin(), kept);
+    }
+}
+
+void LiveMetrics::Restart()
+{
+    session = base;
+    session.Cut(base);
+    Order h = Tail();
+    size_t first = First();
+    for (size_t i = first; i < first + sequence.size(); i++) session.Push(h, i + 1);
+    // The first pushes could not drop what slid out of the windows
+    session.Recount(h);
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "ShotStats.h"
+#include "SessionLog.h"
+#include "DropDetector.h"
+#include <map>
+#include <vector>
+
+// Rolling figures for one shot or the whole session, as shown and exported
+struct RollingStats {
+    float last10 = 0.f;         // accuracy (0..1) over the last 10 attempts, or fewer
+    float last25 = 0.f;
+    float last50 = 0.f;
+    int   streak = 0;           // goals in a row up to the latest attempt
+    int   bestStreak = 0;
+    float ewma = 0.f;           // exponentially weighted accuracy, 0..1
+    float wilsonLow = 0.f;      // 95% Wilson score interval of lifetime accuracy
+    float wilsonHigh = 0.f;
+    bool  dropped = false;      // success rate has fallen from its earlier level
+    float dropFrom = 0.f;       // accuracy before the fall
+    float dropTo = 0.f;         // accuracy since it began
+    int   dropLength = 0;       // attempts since it began
+};
+
+// What a save writes: the session's figures and each shot's
+struct MetricsReport {
+    RollingStats session;
+    std::map<int, RollingStats> shots;
+};
+
+// Rolling-window analytics fed by the same events as the SessionLog. An
+// appended attempt updates every figure in constant time: windows add the new
+// outcome and drop the one that slid out, the EWMA takes one step and the
+// streak grows or resets, and the DropDetector takes one step. Undo and
+// edits cost the same for the windows and the EWMA; a flip or removed miss
+// walks the goal runs next to the attempt to fix streaks, and the detector,
+// which cannot step backwards, replays the stream.
+//
+// The session stream orders attempts as they were recorded. Attempts loaded
+// from a file or the server have no recorded order and are taken shot by
+// shot. Removing an attempt that is not the session's latest rebuilds the
+// session stream from the oldest attempt still in order.
+//
+// Only the newest ORDER to 2 * ORDER session attempts keep their order;
+// older ones are folded into the figures they left behind, so the session
+// side holds a bounded amount however long the session runs. A flip or
+// removal of a folded attempt only moves the session's totals (best streak
+// and the drop detector keep what they saw), and undoing or removing back
+// past the kept order lays the session out shot by shot again, as for a
+// loaded table. Shot figures are always exact. Game thread only.
+class LiveMetrics {
+public:
+    static constexpr int    WINDOWS[3] = { 10, 25, 50 };
+    static constexpr double EWMA_ALPHA = 0.1;      // half the weight on the last ~7 attempts
+    static constexpr size_t ORDER = 4096;          // session attempts kept in order, at least
+
+    // After the table was replaced or loaded
+    void Rebuild(const ShotTable& shots);
+    // After the SessionLog applied (or redid) e
+    void Apply(const ShotEvent& e, const ShotTable& shots);
+    // After the SessionLog undid e
+    void Revert(const ShotEvent& e, const ShotTable& shots);
+
+    // Zeros for a shot without attempts
+    RollingStats Shot(int shot) const;
+    RollingStats Session() const { return session.Read(); }
+    MetricsReport Report() const;
+
+    // Full rebuild, for code holding a copy of the table but no LiveMetrics
+    static MetricsReport Of(const ShotTable& shots);
+
+private:
+    // Figures over one sequence of outcomes. The sequence itself is owned by
+    // the caller and passed in with its current length n: the session's
+    // bits, or a shot's outcomes with sealed ones paged in as read.
+    class Stream {
+    public:
+        // h[n - 1] was just appended
+        template<typename H> void Push(const H& h, size_t n);
+        // The last outcome, `removed`, was just dropped, leaving n
+        template<typename H> void Pop(const H& h, size_t n, bool removed);
+        // h[i] was just flipped
+        template<typename H> void Set(const H& h, size_t n, size_t i);
+
+        // Stops reading h before before.Size(): walks and replays end there
+        // and take up the run and detector `before` had at that point
+        void Cut(const Stream& before);
+        // An attempt before the cut was flipped to `goal`, or removed; only
+        // the totals follow
+        void SetBefore(bool goal);
+        void PopBefore(bool removed);
+        // Windows counted again from h
+        template<typename H> void Recount(const H& h);
+
+        size_t Size() const { return n; }
+        RollingStats Read() const;
+
+    private:
+        size_t n = 0;
+        int    goals = 0;
+        int    windowGoals[3] = {};
+        int    streak = 0;
+        std::map<int, int> runs;    // goal-run length -> how many maximal runs have it
+        double ewma = 0.0;          // raw; Read() corrects the bias of starting at 0
+        DropDetector drop;
+        size_t first = 0;           // h is only read from here on
+        int    lead = 0;            // goals in a row just before first
+        DropDetector dropBefore;    // the detector as it was at first
+
+        void AddRun(int length);
+        void DropRun(int length);
+        // Goals in a row just before i
+        template<typename H> int RunBefore(const H& h, size_t i) const;
+        template<typename H> void Replay(const H& h);
+    };
+
+    // The session's outcomes from First() on, indexed from the session start
+    struct Order {
+        const std::vector<bool>& bits;
+        size_t first;
+        bool operator[](size_t i) const { return bits[i - first]; }
+    };
+
+    // Where a shot's attempts sit in the session order
+    struct Places {
+        size_t forgotten = 0;       // its oldest attempts, folded into base
+        std::vector<size_t> at;     // the rest, as session indices
+        size_t Size() const { return forgotten + at.size(); }
+    };
+
+    // The session side of a shot's change
+    void Push(int shot, bool goal);
+    void Pop(int shot, bool removed);
+    void Flip(int shot, size_t index, bool goal);
+    // Folds the oldest ORDER attempts in order into base
+    void Forget();
+    // The session stream again from base and the attempts in order
+    void Restart();
+
+    size_t First() const { return base.Size(); }
+    Order  Tail() const { return { sequence, First() }; }
+
+    std::map<int, Stream> shots;
+
+    Stream            session;
+    Stream            base;                 // the session up to First()
+    std::vector<bool> sequence;             // session outcomes from First() on
+    std::map<int, Places> positions;
+    bool              lost = false;         // an edit reached past the order; Rebuild
+};
@@ -1,8 +1,15 @@
 ﻿#pragma comment(lib, "pluginsdk.lib")
 #include "pch.h"
 #include "MechTrak.h"
+#include "Importer.h"
+#include "Analytics.h"
+#include "Outbox.h"
+#include "Rollups.h"
+#include "Scheduler.h"
+#include "Lifecycle.h"
 #include <filesystem>
 #include <fstream>
+#include <algorithm>
 
 BAKKESMOD_PLUGIN(MechTrak, "MechTrak", "1.0", PLUGINTYPE_FREEPLAY)
 
@@ -17,33 +24,58 @@ void MechTrak::SetImGuiContext(uintptr_t ctx)
 // ImGui::Begin/End and ImDrawList are fully valid here.
 void MechTrak::Render()
 {
+    if (!firstFrameLogged && !shotStats.empty()) {
+        firstFrameLogged = true;
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStarted).count();
+        char elapsed[32];
+        snprintf(elapsed, sizeof(elapsed), "%.1f", ms);
+        cvarManager->log(std::string("First HUD frame with stats ") + elapsed + " ms after load");
+    }
+
     HUD::RenderImGui(cvarManager, gameWrapper,
-        shotStats, shotTypes, currentShotNumber, sessionActive,
+        shotStats, shotTypes, Aggregates(), Metrics(), Trend(), grid, currentShotNumber, sessionActive,
         showEditPanel,
         [this]() {
             cvarManager->executeCommand("stats_end_session");
         },
         [this](int shotNum, int newGoals, int newAttempts) {
-            if (!shotStats.count(shotNum)) return;
-            shotStats[shotNum].goals = newGoals < 0 ? 0 : newGoals;
-            shotStats[shotNum].attempts = newAttempts < 0 ? 0 : newAttempts;
-            // Clamp goals <= attempts
-            if (shotStats[shotNum].goals > shotStats[shotNum].attempts)
-                shotStats[shotNum].goals = shotStats[shotNum].attempts;
-            if (!uploadInProgress) {
-                uploadInProgress = true;
-                std::thread([this]() {
-                    Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes);
-                    Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-                    uploadInProgress = false;
-                    }).detach();
+            auto it = shotStats.find(shotNum);
+            if (it == shotStats.end()) return;
+            const ShotStats& s = it->second;
+            // The panel steps one counter by one; express that as attempts so
+            // the history moves with it
+            bool changed = false;
+            if (newAttempts > s.attempts) changed = Record(ShotEvent::Attempt(shotNum, false));
+            else if (newAttempts < s.attempts) changed = Record(ShotEvent::Remove(shotNum));
+            else if (newGoals != s.goals) {
+                // Most recent attempt with the other outcome
+                bool toGoal = newGoals > s.goals;
+                for (size_t i = s.Count(); i-- > 0;)
+                    if (s.Outcome(i) != toGoal) { changed = Record(ShotEvent::Flip(shotNum, (int)i)); break; }
             }
+            if (changed) QueueSync(SyncWorker::Trigger::Edit);
+        },
+        [this](int shotNum) {
+            currentShotNumber = shotNum;
         }
     );
+
+    if (showAnalytics) {
+        std::shared_ptr<const AnalyticsReport> report;
+        {
+            std::lock_guard<std::mutex> lock(analyticsMtx);
+            report = analytics;
+        }
+        HUD::RenderAnalytics(report.get(), analyticsRunning, analyticsDone, analyticsTotal);
+    }
+
+    if (showTimeline) HUD::RenderTimeline(timeline, shotStats, SessionMs());
 }
 
 void MechTrak::onLoad()
 {
+    loadStarted = std::chrono::steady_clock::now();
+
     // ── Auto-add to plugins.cfg ──────────────────────────────────────────
     std::filesystem::path cfgPath = gameWrapper->GetBakkesModPath() / "cfg" / "plugins.cfg";
     std::ifstream cfgIn(cfgPath);
@@ -63,6 +95,21 @@ void MechTrak::onLoad()
 
     Settings::CreateFile(cvarManager);
     Settings::RegisterCvars(cvarManager);
+    Outbox::Open(Session::GetDataFolder());
+    AttemptSpill::Open(Session::GetDataFolder());
+    Rollups::Open(Session::GetDataFolder());
+
+    SyncWorker::SetMaxStaleness(std::chrono::milliseconds(
+        (int)(cvarManager->getCvar("mechtrak_sync_max_staleness").getFloatValue() * 1000.f)));
+    cvarManager->getCvar("mechtrak_sync_max_staleness").addOnValueChanged([](std::string, CVarWrapper cvar) {
+        SyncWorker::SetMaxStaleness(std::chrono::milliseconds((int)(cvar.getFloatValue() * 1000.f)));
+        });
+    AttemptSpill::SetBudget((size_t)cvarManager->getCvar("mechtrak_memory_cap_kb").getIntValue() * 1024);
+    cvarManager->getCvar("mechtrak_memory_cap_kb").addOnValueChanged([this](std::string, CVarWrapper cvar) {
+        AttemptSpill::SetBudget((size_t)cvar.getIntValue() * 1024);
+        Spill();
+        });
+    Lifecycle::Start();
 
     currentShotNumber = 1;
     shotTypes[currentShotNumber] = "Unknown";
@@ -71,6 +118,16 @@ void MechTrak::onLoad()
     sessionId = Session::GenerateId();
     sessionStartTime = std::chrono::system_clock::now();
 
+    // ── Warm start ───────────────────────────────────────────────────────
+    // A plugin reload hands back everything that was in memory; otherwise
+    // show the last saved session right away. Either way the server is
+    // reconciled in the background below.
+    if (TakeHandoff()) {}
+    else if (Session::LoadSnapshot(sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber))
+        cvarManager->log("Restored session " + sessionId + " from disk (" + std::to_string(shotStats.size()) + " shots)");
+    Retally();
+    Session::Publish(sessionId, sessionActive);
+
     // ── Game event hooks ─────────────────────────────────────────────────
     gameWrapper->HookEvent("Function TAGame.Ball_TA.Explode",
         std::bind(&MechTrak::OnBallExplode, this, std::placeholders::_1));
@@ -79,9 +136,15 @@ void MechTrak::onLoad()
     gameWrapper->HookEvent("Function TAGame.GameEvent_TrainingEditor_TA.StartNewRound",
         std::bind(&MechTrak::OnShotReset, this, std::placeholders::_1));
     gameWrapper->HookEvent("Function TAGame.Ball_TA.OnCarTouch",
-        [this](std::string) { roundActive = true; });
+        [this](std::string) {
+            roundActive = true;
+            if (firstTouchMs == 0) firstTouchMs = SessionMs();
+        });
     gameWrapper->HookEvent("Function TAGame.GameEvent_TrainingEditor_TA.OnInit",
         [this](std::string) {
+            // Entering training: heartbeat and pick up a dashboard session now
+            inCustomTraining = true;
+            SyncWorker::WakeIdle();
             auto compactCvar = cvarManager->getCvar("mechtrak_compact_hud");
             if (compactCvar && compactCvar.getBoolValue()) {
                 cvarManager->executeCommand("togglemenu mechtrak");
@@ -89,6 +152,7 @@ void MechTrak::onLoad()
         });
     // ── Canvas HUD drawable ───────────────────────────────────────────────
     gameWrapper->RegisterDrawable([this](CanvasWrapper canvas) {
+        inCustomTraining = gameWrapper->IsInCustomTraining();
         HUD::Render(canvas, cvarManager, gameWrapper,
             shotStats, shotTypes, currentShotNumber, sessionActive);
         });
@@ -108,32 +172,175 @@ void MechTrak::onLoad()
     // ── Other notifiers ───────────────────────────────────────────────────
     cvarManager->registerNotifier("stats_current", [this](std::vector<std::string>) {
         if (shotStats.count(currentShotNumber)) {
-            auto& s = shotStats[currentShotNumber];
+            const Tally& s = Aggregates().Shot(currentShotNumber);
             cvarManager->log("Shot " + std::to_string(currentShotNumber) + ": " + std::to_string(s.attempts) + " attempts, " + std::to_string(s.goals) + " goals");
+            RollingStats r = Metrics().Shot(currentShotNumber);
+            auto pct = [](float f) { return std::to_string((int)(f * 100.f + 0.5f)) + "%"; };
+            cvarManager->log("  last 10/25/50: " + pct(r.last10) + " / " + pct(r.last25) + " / " + pct(r.last50) +
+                ", trend " + pct(r.ewma) + ", 95% range " + pct(r.wilsonLow) + "-" + pct(r.wilsonHigh) +
+                ", streak " + std::to_string(r.streak) + " (best " + std::to_string(r.bestStreak) + ")");
+            if (r.dropped)
+                cvarManager->log("  dropping: " + pct(r.dropFrom) + " -> " + pct(r.dropTo) + " over the last " +
+                    std::to_string(r.dropLength) + " attempts");
         }
         }, "Shows current shot stats", PERMISSION_ALL);
 
     cvarManager->registerNotifier("stats_show", [this](std::vector<std::string>) {
-        for (auto& [id, s] : shotStats) {
-            float acc = s.attempts > 0 ? (float)s.goals / s.attempts * 100.f : 0.f;
-            cvarManager->log("Shot " + std::to_string(id) + ": " + std::to_string(s.attempts) + " attempts, " + std::to_string(s.goals) + " goals (" + std::to_string((int)acc) + "%)");
-        }
+        const SessionAggregates& agg = Aggregates();
+        auto line = [](const Tally& t) {
+            return std::to_string(t.attempts) + " attempts, " + std::to_string(t.goals) + " goals (" +
+                std::to_string((int)(t.Accuracy() * 100.f)) + "%)";
+        };
+        for (auto& [id, s] : shotStats)
+            cvarManager->log("Shot " + std::to_string(id) + ": " + line(agg.Shot(id)));
+        for (auto& [type, t] : agg.Types())
+            if (t.attempts > 0) cvarManager->log("Type " + type + ": " + line(t));
+        const SessionTotals& totals = agg.Totals();
+        cvarManager->log("Session: " + line(totals.all));
+        if (totals.bestShot != 0)
+            cvarManager->log("Best shot: " + std::to_string(totals.bestShot) + " (" +
+                std::to_string((int)(totals.bestShotPct * 100.f)) + "%)");
         }, "Shows all stats", PERMISSION_ALL);
 
     cvarManager->registerNotifier("stats_reset", [this](std::vector<std::string>) {
-        shotStats.clear(); currentShotNumber = 1; shotStats[currentShotNumber] = ShotStats();
+        // Names outlive a reset; keep them off the arena while it goes
+        ShotNames names(shotTypes.begin(), shotTypes.end());
+        SessionArena::Reset(shotStats, shotTypes);
+        shotTypes.insert(names.begin(), names.end());
+        currentShotNumber = 1; shotStats[currentShotNumber] = ShotStats();
+        sessionLog.Clear();
+        Retally();
         cvarManager->log("Stats reset!");
         }, "Reset all stats", PERMISSION_ALL);
 
     cvarManager->registerNotifier("stats_save", [this](std::vector<std::string>) {
-        Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes);
+        Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes,
+            Aggregates().Totals(), Metrics().Report());
         }, "Save stats", PERMISSION_ALL);
 
+    cvarManager->registerNotifier("stats_import", [this](std::vector<std::string> args) {
+        std::string folder = args.size() > 1 ? args[1] : Session::GetDataFolder();
+        if (folder.empty()) return;
+        Lifecycle::Spawn([this, folder](const std::atomic<bool>& cancel) {
+            auto progress = [this](const ImportProgress& p) {
+                cvarManager->log("Import: " + std::to_string(p.filesDone) + "/" + std::to_string(p.filesTotal) +
+                    " files (" + std::to_string((int)p.FilesPerSec()) + " files/s, " +
+                    std::to_string((int)p.MBPerSec()) + " MB/s)");
+            };
+            std::filesystem::path out = std::filesystem::path(folder) / "history.mtk";
+            ImportProgress r = Importer::Run(folder, out, 0, progress, &cancel);
+            if (cancel) return;
+            if (!r.written) {
+                cvarManager->log("Import failed: could not write " + out.string());
+                return;
+            }
+            cvarManager->log("Imported " + std::to_string(r.filesDone - r.filesSkipped) + " sessions, skipped " +
+                std::to_string(r.filesSkipped) + " -> " + out.string());
+            std::vector<ImportedSession> sessions;
+            if (Importer::ReadAggregate(out, sessions)) Rollups::Rebuild(sessions);
+            });
+        }, "Import saved session files into history.mtk", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_analytics", [this](std::vector<std::string>) {
+        showAnalytics = !showAnalytics;
+        if (!showAnalytics || analyticsRunning.exchange(true)) return;
+        std::string folder = Session::GetDataFolder();
+        Lifecycle::Spawn([this, folder](const std::atomic<bool>& cancel) {
+            auto progress = [this](const ImportProgress& p) {
+                analyticsDone = p.filesDone;
+                analyticsTotal = p.filesTotal;
+            };
+            // One core stays with the game
+            unsigned threads = std::max(2u, std::thread::hardware_concurrency()) - 1;
+            AnalyticsReport r = Analytics::Run(folder, threads, progress, &cancel);
+            if (!cancel) {
+                auto report = std::make_shared<const AnalyticsReport>(std::move(r));
+                std::lock_guard<std::mutex> lock(analyticsMtx);
+                analytics = report;
+            }
+            analyticsRunning = false;
+            });
+        }, "Toggle the all-time analytics panel; opening it re-reads the saved sessions", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_timeline", [this](std::vector<std::string>) {
+        showTimeline = !showTimeline;
+        }, "Toggle the session timeline panel", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_progress", [this](std::vector<std::string> args) {
+        static const char* names[Rollups::RESOLUTIONS] = { "hour", "day", "week", "month" };
+        int r = 2;
+        if (args.size() > 1)
+            for (int i = 0; i < Rollups::RESOLUTIONS; i++) if (args[1] == names[i]) r = i;
+        auto res = (Rollups::Resolution)r;
+        int count = args.size() > 2 ? std::clamp(std::atoi(args[2].c_str()), 1, 60) : 12;
+
+        int32_t last = Rollups::Latest(res);
+        if (last < 0) {
+            cvarManager->log("No finished sessions yet (stats_import fills in older ones)");
+            return;
+        }
+        int32_t first = last - count + 1;
+        cvarManager->log(std::string("Accuracy per ") + names[r] + ", " + Rollups::Label(first, res) +
+            " to " + Rollups::Label(last, res) + ":");
+        std::vector<std::string> types = Rollups::Types();
+        types.insert(types.begin(), Rollups::ALL);
+        for (const auto& type : types) {
+            char cell[16];
+            std::string line = type == Rollups::ALL ? "All" : type;
+            line.resize(std::max<size_t>(line.size(), 16), ' ');
+            for (const auto& b : Rollups::Series(type, res, first, (size_t)count)) {
+                if (b.attempts > 0) snprintf(cell, sizeof(cell), " %3d%%", (int)(b.Accuracy() * 100.f + 0.5f));
+                else snprintf(cell, sizeof(cell), "   --");
+                line += cell;
+            }
+            cvarManager->log(line);
+        }
+        }, "Show accuracy per shot type over time: [hour|day|week|month] [count]", PERMISSION_ALL);
+
     cvarManager->registerNotifier("stats_upload", [this](std::vector<std::string>) {
-        Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
+        QueueSync(SyncWorker::Trigger::Edit);
         }, "Upload session", PERMISSION_ALL);
 
 
+    cvarManager->registerNotifier("mechtrak_outbox", [this](std::vector<std::string>) {
+        auto st = Outbox::GetStatus();
+        cvarManager->log("Outbox: " + std::to_string(st.pending) + " pending, " +
+            std::to_string(st.sent) + " sent, " + std::to_string(st.failed) + " failed, " +
+            std::to_string(st.rejected) + " rejected" +
+            (st.rejected > 0 ? " (last for session " + st.lastRejected + ")" : "") +
+            (st.retryIn.count() > 0 ? ", retry in " + std::to_string(st.retryIn.count() / 1000) + "s" : ""));
+        }, "Show unsent uploads", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_sync_stats", [this](std::vector<std::string>) {
+        auto st = SyncWorker::GetStats();
+        char rate[32];
+        snprintf(rate, sizeof(rate), "%.2f", st.requestsPerMinute);
+        cvarManager->log("Sync: " + std::to_string(st.requests) + " requests for " +
+            std::to_string(st.submitted) + " updates, " + rate + " req/min (last 10 min)");
+        cvarManager->log("  staleness p50 <" + std::to_string(st.staleness.Percentile(50).count()) +
+            "ms, p95 <" + std::to_string(st.staleness.Percentile(95).count()) + "ms: " + st.staleness.Format());
+        cvarManager->log("  request gap: " + st.requestGap.Format());
+        if (st.uptimeHours > 0.0) {
+            char perHour[64];
+            snprintf(perHour, sizeof(perHour), "%.0f uploads/h, %.0f heartbeats/h",
+                st.requests / st.uptimeHours, st.idleRuns / st.uptimeHours);
+            cvarManager->log(std::string("  ") + perHour + " since load");
+        }
+        }, "Show upload batching stats", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_memory", [this](std::vector<std::string>) {
+        auto u = AttemptSpill::Measure(shotStats);
+        cvarManager->log("Attempts: " + std::to_string(u.hotAttempts) + " in memory (" +
+            std::to_string(u.hotBytes / 1024) + " KB), " + std::to_string(u.sealedAttempts) + " on disk in " +
+            std::to_string(u.blocks) + " blocks (" + std::to_string(u.diskBytes / 1024) + " KB)");
+        cvarManager->log("  resident " + std::to_string(u.residentBytes / 1024) + " KB of " +
+            std::to_string(AttemptSpill::Budget() / 1024) + " KB");
+        auto a = arena.GetStats();
+        cvarManager->log("Session arena: " + std::to_string(a.sessionBytes / 1024) + " KB this session, " +
+            std::to_string(a.allocations) + " allocations and " + std::to_string(a.chunks) + " heap blocks over " +
+            std::to_string(a.resets) + " resets");
+        }, "Show how much of the attempt history is in memory and on disk, and the session arena", PERMISSION_ALL);
+
     cvarManager->registerNotifier("mechtrak_toggle_edit", [this](std::vector<std::string>) {
         showEditPanel = !showEditPanel;
         }, "Toggle edit panel", PERMISSION_ALL);
@@ -161,35 +368,41 @@ void MechTrak::onLoad()
         }, "Next shot", PERMISSION_ALL);
 
 
-    // Flip last attempt
-    cvarManager->registerNotifier("mechtrak_flip_last", [this](std::vector<std::string>) {
+    // Flip last attempt, or the one n attempts back
+    cvarManager->registerNotifier("mechtrak_flip_last", [this](std::vector<std::string> args) {
         if (!shotStats.count(currentShotNumber)) return;
-        auto& s = shotStats[currentShotNumber];
-        if (s.attemptHistory.empty()) return;
-
-        bool lastWasGoal = s.attemptHistory.back();
-        if (lastWasGoal) {
-            s.goals--;
-            s.attemptHistory.back() = false;
-            cvarManager->log("Corrected: goal -> miss");
-        }
-        else {
-            s.goals++;
-            s.attemptHistory.back() = true;
-            cvarManager->log("Corrected: miss -> goal");
-        }
-        if (s.goals < 0) s.goals = 0;
-        if (s.goals > s.attempts) s.goals = s.attempts;
-
-        if (!uploadInProgress) {
-            uploadInProgress = true;
-            std::thread([this]() {
-                Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes);
-                Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-                uploadInProgress = false;
-                }).detach();
+        const ShotStats& s = shotStats[currentShotNumber];
+        int back = 1;
+        if (args.size() > 1) {
+            try { back = std::stoi(args[1]); }
+            catch (...) { return; }
         }
-        }, "Flip last attempt goal/miss", PERMISSION_ALL);
+        if (back < 1 || back > (int)s.Count()) return;
+
+        int index = (int)s.Count() - back;
+        bool wasGoal = s.Outcome(index);
+        if (!Record(ShotEvent::Flip(currentShotNumber, index))) return;
+        cvarManager->log(wasGoal ? "Corrected: goal -> miss" : "Corrected: miss -> goal");
+        QueueSync(SyncWorker::Trigger::Edit);
+        }, "Flip last attempt goal/miss (or the one n attempts back)", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_undo", [this](std::vector<std::string>) {
+        sessionLog.Bind(sessionId);
+        const ShotEvent* e = sessionLog.Undo(shotStats);
+        if (!e) { cvarManager->log("Nothing to undo"); return; }
+        Retally(*e, true);
+        cvarManager->log("Undid " + SessionLog::Describe(*e));
+        QueueSync(SyncWorker::Trigger::Edit);
+        }, "Undo the last attempt or correction", PERMISSION_ALL);
+
+    cvarManager->registerNotifier("mechtrak_redo", [this](std::vector<std::string>) {
+        sessionLog.Bind(sessionId);
+        const ShotEvent* e = sessionLog.Redo(shotStats);
+        if (!e) { cvarManager->log("Nothing to redo"); return; }
+        Retally(*e, false);
+        cvarManager->log("Redid " + SessionLog::Describe(*e));
+        QueueSync(SyncWorker::Trigger::Edit);
+        }, "Redo the last undone attempt or correction", PERMISSION_ALL);
 
 
  
@@ -218,11 +431,40 @@ void MechTrak::onLoad()
         cvarManager->getCvar("mechtrak_key_flip_last").getStringValue() + " mechtrak_flip_last");
 
     cvarManager->registerNotifier("stats_end_session", [this](std::vector<std::string>) {
+        // The final snapshot replaces any batched attempts and goes out on the
+        // SyncWorker while the session is still live on the server; the game
+        // thread only resets its own state
+        auto sc = shotStats; auto tc = shotTypes; auto ic = sessionId; auto tm = sessionStartTime;
+        SessionTotals tt = Aggregates().Totals(); MetricsReport mr = Metrics().Report();
+        bool live = sessionActive;
+        SyncWorker::Submit([this, sc, tc, ic, tm, tt, mr, live](SyncWorker::Done done) mutable {
+            // Enqueue reads the live save before returning, so the ended
+            // save below never replaces it; the job ends with the drain
+            if (live) {
+                Session::SaveToFile(cvarManager, ic, true, tm, sc, tc, tt, mr);
+                Session::Enqueue(cvarManager, ic, done);
+            }
+            Session::SaveToFile(cvarManager, ic, false, tm, sc, tc, tt, mr);
+
+            ImportedSession ended;
+            ended.sessionId = ic;
+            ended.startTime = (int64_t)std::chrono::system_clock::to_time_t(tm);
+            ended.durationMinutes = (int)std::chrono::duration_cast<std::chrono::minutes>(
+                std::chrono::system_clock::now() - tm).count();
+            for (auto& [num, s] : sc) {
+                auto type = tc.find(num);
+                s.Thaw();
+                ended.shots.push_back({ num, type != tc.end() && !type->second.empty() ? std::string(type->second) : "Unknown",
+                    s.attempts, s.goals, s.attemptHistory, s.attemptTimes });
+            }
+            if (!ended.shots.empty()) Rollups::Add(ended);
+            if (!live) done();
+            }, SyncWorker::Trigger::Edit);
         sessionActive = false;
-        Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes);
-        Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-        shotStats.clear();
-        shotTypes.clear();
+        Session::Publish(sessionId, sessionActive);
+        SessionArena::Reset(shotStats, shotTypes);
+        sessionLog.Clear();
+        Retally();
         currentShotNumber = 1;
         cvarManager->log("Session ended.");
         }, "End session", PERMISSION_ALL);
@@ -230,31 +472,255 @@ void MechTrak::onLoad()
     cvarManager->executeCommand("bind F8 stats_key_prev");
     cvarManager->executeCommand("bind F9 stats_key_next");
 
-    // ── Delayed init ──────────────────────────────────────────────────────
-    gameWrapper->SetTimeout([this](GameWrapper*) {
-        Session::LoadActive(cvarManager, sessionId, sessionActive, shotStats, shotTypes, currentShotNumber);
-          
+    // ── Background init ───────────────────────────────────────────────────
+    // Open the HUD on the next tick, once the window is registered; it has
+    // the snapshot to draw without waiting on the network
+    gameWrapper->Execute([this](GameWrapper*) {
         if (gameWrapper->IsInCustomTraining()) {
             cvarManager->executeCommand("togglemenu mechtrak");
         }
+        });
 
-        std::thread([this]() {
-            std::string token = Session::GetPluginToken(cvarManager);
+    // Token and active session are fetched here; the result is applied on
+    // the game thread (PostActive)
+    Scheduler::After(std::chrono::milliseconds(0), [this]() {
+        Session::GetPluginToken(cvarManager, [this](std::string token) {
             if (!token.empty())
                 cvarManager->log("MechTrak: token ready (" + std::to_string(token.length()) + " chars)");
-            }).detach();
 
-        Heartbeat::Start(cvarManager, gameWrapper, sessionId, sessionActive, shotStats, shotTypes, currentShotNumber);
-        }, 2.0f);
+            Session::FetchActive(cvarManager, [this](Session::ActiveSession fetched) {
+                PostActive(std::move(fetched));
+
+                Heartbeat::Start(cvarManager, gameWrapper, inCustomTraining,
+                    [this](Session::ActiveSession fetched) { PostActive(std::move(fetched)); });
+                });
+            });
+        });
+
+    Scheduler::Every(Session::TOKEN_REFRESH, [this]() {
+        Session::GetPluginToken(cvarManager);
+        });
 }
 
 void MechTrak::onUnload()
 {
-    cvarManager->log("Mech Trak plugin unloaded!");
+    // Last upload gets a bounded window; after that in-flight requests are
+    // aborted and every thread is joined before the DLL goes away
+    auto timeout = std::chrono::milliseconds(
+        (int)(cvarManager->getCvar("mechtrak_shutdown_timeout").getFloatValue() * 1000.f));
+    unloading = true;
+    auto report = Lifecycle::Shutdown([](std::function<void()> done) { SyncWorker::Stop(done); }, timeout);
+
+    cvarManager->log(std::string("Mech Trak plugin unloaded! (") +
+        (report.flushed ? "flushed" : "flush timed out") + ", " +
+        std::to_string(report.requestsCancelled) + " requests cancelled, " +
+        std::to_string(report.threadsJoined) + " threads joined, " +
+        std::to_string(report.elapsed.count()) + " ms)");
+    if (report.requestsStuck > 0)
+        cvarManager->log("MechTrak: ERROR: WinHTTP still holds " + std::to_string(report.requestsStuck) +
+            " requests after the shutdown deadline; the game may crash if it calls back into the unloaded plugin");
+
+    // Nothing else touches the session now
+    SaveHandoff();
+}
+
+// ─── Reload handoff ───────────────────────────────────────────────────────────
+
+void MechTrak::SaveHandoff()
+{
+    std::string folder = Session::GetDataFolder();
+    if (folder.empty()) return;
+
+    // Points current_session at this session so TakeHandoff will accept it
+    if (sessionActive)
+        Session::SaveToFile(cvarManager, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes,
+            Aggregates().Totals(), Metrics().Report());
+
+    using namespace std::chrono;
+    RuntimeState state;
+    state.savedAtMs = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+    state.sessionId = sessionId;
+    state.sessionActive = sessionActive;
+    state.sessionStartMs = duration_cast<milliseconds>(sessionStartTime.time_since_epoch()).count();
+    state.currentShotNumber = currentShotNumber;
+    state.roundActive = roundActive;
+    state.justRecordedAttempt = justRecordedAttempt;
+    state.roundStartMs = roundStartMs;
+    state.firstTouchMs = firstTouchMs;
+    state.lastKnownScore = lastKnownScore;
+    state.lastGoalAgoMs = lastGoalTime == steady_clock::time_point() ? -1 :
+        duration_cast<milliseconds>(steady_clock::now() - lastGoalTime).count();
+    state.showEditPanel = showEditPanel;
+    state.shotStats = shotStats;
+    // The journals go with this run
+    for (auto& [num, s] : state.shotStats) s.Thaw();
+    state.shotTypes = shotTypes;
+
+    if (!Handoff::Write(folder + "\\handoff.mtk", state))
+        cvarManager->log("Could not write reload handoff");
+}
+
+bool MechTrak::TakeHandoff()
+{
+    std::string folder = Session::GetDataFolder();
+    if (folder.empty()) return false;
+
+    using namespace std::chrono;
+    auto start = steady_clock::now();
+    RuntimeState state;
+    Handoff::Result result = Handoff::Take(folder + "\\handoff.mtk", Session::CurrentId(), state);
+    if (result != Handoff::Result::Restored) {
+        if (result != Handoff::Result::Missing)
+            cvarManager->log(std::string("Ignoring reload handoff: ") + Handoff::Describe(result));
+        return false;
+    }
+
+    sessionId = std::move(state.sessionId);
+    sessionActive = state.sessionActive;
+    sessionStartTime = system_clock::time_point(milliseconds(state.sessionStartMs));
+    currentShotNumber = state.currentShotNumber;
+    roundActive = state.roundActive;
+    justRecordedAttempt = state.justRecordedAttempt;
+    roundStartMs = state.roundStartMs;
+    firstTouchMs = state.firstTouchMs;
+    lastKnownScore = state.lastKnownScore;
+    lastGoalTime = state.lastGoalAgoMs < 0 ? steady_clock::time_point() :
+        steady_clock::now() - milliseconds(state.lastGoalAgoMs);
+    showEditPanel = state.showEditPanel;
+    SessionArena::Reset(shotStats, shotTypes);
+    shotStats = std::move(state.shotStats);
+    shotTypes = std::move(state.shotTypes);
+
+    cvarManager->log("Restored session " + sessionId + " from reload handoff in " +
+        std::to_string(duration_cast<microseconds>(steady_clock::now() - start).count()) + " us (" +
+        std::to_string(shotStats.size()) + " shots)");
+    return true;
 }
 
 // ─── Game event handlers ──────────────────────────────────────────────────────
 
+void MechTrak::QueueSync(SyncWorker::Trigger trigger)
+{
+    // The job only sees this snapshot; what the upload learns about the
+    // server comes back to the game thread
+    auto sc = shotStats; auto tc = shotTypes; auto ic = sessionId; auto tm = sessionStartTime;
+    SessionTotals tt = Aggregates().Totals(); MetricsReport mr = Metrics().Report();
+    bool live = sessionActive;
+    SyncWorker::Submit([this, sc, tc, ic, tm, tt, mr, live](SyncWorker::Done done) mutable {
+        Session::SaveToFile(cvarManager, ic, live, tm, sc, tc, tt, mr);
+        Session::Upload(cvarManager, ic, live, tm, std::move(sc), std::move(tc),
+            [this, ic, done](Session::UploadResult result, Session::ActiveSession next) {
+                switch (result) {
+                case Session::UploadResult::Switched:
+                    PostActive(std::move(next), ic);
+                    break;
+                case Session::UploadResult::Deleted:
+                    if (unloading) break;
+                    gameWrapper->Execute([this, ic](GameWrapper*) {
+                        if (sessionId != ic) return;
+                        sessionActive = false;
+                        sessionId = "";
+                        Session::Publish(sessionId, sessionActive);
+                        });
+                    break;
+                default:
+                    break;
+                }
+                done();
+            });
+        }, trigger);
+}
+
+void MechTrak::PostActive(Session::ActiveSession fetched, std::string replacing)
+{
+    if (!fetched.answered || unloading) return;
+    // Execute wants a copyable callable; the tables are moved, not copied
+    auto staged = std::make_shared<Session::ActiveSession>(std::move(fetched));
+    gameWrapper->Execute([this, staged, replacing](GameWrapper*) {
+        if (!replacing.empty()) {
+            // The player may have moved on since the upload saw the switch
+            if (sessionId != replacing) return;
+            sessionActive = false;
+        }
+        // Events on a replaced shot would undo against a history they
+        // never saw
+        std::vector<int> replaced;
+        Session::ApplyActive(cvarManager, *staged, sessionId, sessionActive, shotStats, shotTypes, currentShotNumber, replaced);
+        sessionLog.Drop(replaced);
+        Session::Publish(sessionId, sessionActive);
+        });
+}
+
+bool MechTrak::Record(const ShotEvent& e)
+{
+    sessionLog.Bind(sessionId);
+    if (!sessionLog.Apply(shotStats, e)) return false;
+    // The logged copy, which knows what a Remove took away
+    Retally(*(sessionLog.end() - 1), false);
+    return true;
+}
+
+const SessionAggregates& MechTrak::Aggregates()
+{
+    if (aggregates.Version() != Session::TableVersion()) Retally();
+    return aggregates;
+}
+
+const LiveMetrics& MechTrak::Metrics()
+{
+    Aggregates();
+    return metrics;
+}
+
+const TrendGraph& MechTrak::Trend()
+{
+    Aggregates();
+    return trend;
+}
+
+void MechTrak::Retally(const ShotEvent& e, bool undone)
+{
+    // A rebuild already includes e
+    if (aggregates.Version() != Session::TableVersion()) { Retally(); return; }
+    auto it = shotStats.find(e.shot);
+    if (it != shotStats.end()) aggregates.Refresh(e.shot, it->second, shotTypes);
+    grid.Invalidate();
+    if (undone) {
+        metrics.Revert(e, shotStats);
+        trend.Revert(e, shotStats);
+        timeline.Revert(e, shotStats);
+    }
+    else {
+        metrics.Apply(e, shotStats);
+        trend.Apply(e, shotStats);
+        timeline.Apply(e, SessionMs(), shotStats);
+    }
+    Spill();
+}
+
+void MechTrak::Retally()
+{
+    aggregates.Rebuild(shotStats, shotTypes, Session::TableVersion());
+    metrics.Rebuild(shotStats);
+    trend.Rebuild(shotStats);
+    grid.Invalidate();
+    timeline.Rebuild(shotStats);
+    Spill();
+}
+
+void MechTrak::Spill()
+{
+    AttemptSpill::Enforce(shotStats, sessionId);
+    if (AttemptSpill::Pending())
+        Scheduler::After(std::chrono::milliseconds(0), []() { AttemptSpill::Flush(); });
+}
+
+uint32_t MechTrak::SessionMs() const
+{
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - sessionStartTime).count();
+    return ms > 0 ? (uint32_t)ms : 0;
+}
+
 void MechTrak::OnBallExplode(std::string)
 {
     if (!gameWrapper->IsInCustomTraining()) return;
@@ -262,38 +728,20 @@ void MechTrak::OnBallExplode(std::string)
     if (std::chrono::duration_cast<std::chrono::seconds>(now - lastGoalTime).count() < 12) {
         lastGoalTime = std::chrono::steady_clock::time_point(); return;
     }
-    if (!shotStats.count(currentShotNumber))shotStats[currentShotNumber] = ShotStats();
-    shotStats[currentShotNumber].attempts++;
-    shotStats[currentShotNumber].attemptHistory.push_back(false);
+    Record(ShotEvent::Attempt(currentShotNumber, false, RoundTime()));
     justRecordedAttempt = true;
-    if (!uploadInProgress) {
-        uploadInProgress = true;
-        auto sc = shotStats; auto tc = shotTypes; auto ic = sessionId; auto tm = sessionStartTime;
-        std::thread([this, sc, tc, ic, tm]()mutable {
-            Session::SaveToFile(cvarManager, ic, sessionActive, tm, sc, tc);
-            Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-            uploadInProgress = false; }).detach();
-    }
+    QueueSync(SyncWorker::Trigger::Attempt);
 }
 
 void MechTrak::OnShotReset(std::string)
 {
     if (!gameWrapper->IsInCustomTraining()) return;
     lastGoalTime = std::chrono::steady_clock::time_point();
-    if (roundActive && !justRecordedAttempt) {
-        if (!shotStats.count(currentShotNumber))shotStats[currentShotNumber] = ShotStats();
-        shotStats[currentShotNumber].attempts++;
-        shotStats[currentShotNumber].attemptHistory.push_back(false);
-    }
+    if (roundActive && !justRecordedAttempt)
+        Record(ShotEvent::Attempt(currentShotNumber, false, RoundTime()));
     roundActive = false; justRecordedAttempt = false;
-    if (!uploadInProgress) {
-        uploadInProgress = true;
-        auto sc = shotStats; auto tc = shotTypes; auto ic = sessionId; auto tm = sessionStartTime;
-        std::thread([this, sc, tc, ic, tm]()mutable {
-            Session::SaveToFile(cvarManager, ic, sessionActive, tm, sc, tc);
-            Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-            uploadInProgress = false; }).detach();
-    }
+    roundStartMs = SessionMs(); firstTouchMs = 0;
+    QueueSync(SyncWorker::Trigger::Attempt);
 }
 
 void MechTrak::OnGoalScored(std::string)
@@ -306,24 +754,17 @@ void MechTrak::OnGoalScored(std::string)
     int currentScore = teams.Get(0).GetScore();
     if (currentScore <= lastKnownScore) { lastKnownScore = currentScore; return; }
     lastKnownScore = currentScore;
-    auto now = std::chrono::steady_clock::now();
-    auto timeSince = std::chrono::duration_cast<std::chrono::seconds>(now - lastGoalTime).count();
-    if (timeSince >= 2 && timeSince < 12 && shotStats.count(currentShotNumber)) {
-        shotStats[currentShotNumber].attempts++;
-        shotStats[currentShotNumber].attemptHistory.push_back(true);
-    }
     lastGoalTime = std::chrono::steady_clock::now();
-    if (shotStats.count(currentShotNumber)) {
-        shotStats[currentShotNumber].goals++;
-        shotStats[currentShotNumber].attemptHistory.push_back(true);
+    auto it = shotStats.find(currentShotNumber);
+    if (it != shotStats.end()) {
+        // If the explosion already logged this round as a miss, it was a goal;
+        // otherwise the goal is the attempt
+        size_t n = it->second.Count();
+        if (justRecordedAttempt && n > 0 && !it->second.Outcome(n - 1))
+            Record(ShotEvent::Flip(currentShotNumber, (int)n - 1));
+        else
+            Record(ShotEvent::Attempt(currentShotNumber, true, RoundTime()));
         justRecordedAttempt = true;
     }
-    if (!uploadInProgress) {
-        uploadInProgress = true;
-        auto sc = shotStats; auto tc = shotTypes; auto ic = sessionId; auto tm = sessionStartTime;
-        std::thread([this, sc, tc, ic, tm]()mutable {
-            Session::SaveToFile(cvarManager, ic, sessionActive, tm, sc, tc);
-            Session::Upload(cvarManager, gameWrapper, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, currentShotNumber);
-            uploadInProgress = false; }).detach();
-    }
+    QueueSync(SyncWorker::Trigger::Attempt);
 }
\ No newline at end of file
@@ -8,13 +8,21 @@
 #include "Session.h"
 #include "Heartbeat.h"
 #include "Settings.h"
+#include "SyncWorker.h"
+#include "Handoff.h"
+#include "SessionLog.h"
+#include "SessionAggregates.h"
+#include "LiveMetrics.h"
+#include "TrendGraph.h"
+#include "ShotGrid.h"
+#include "SessionTimeline.h"
 #include <map>
 #include <string>
 #include <chrono>
 #include <thread>
 #include <atomic>
-
-std::atomic<bool> uploadInProgress{ false };
+#include <memory>
+#include <mutex>
 
 constexpr auto plugin_version = stringify(VERSION_MAJOR) "." stringify(VERSION_MINOR) "." stringify(VERSION_PATCH) "." stringify(VERSION_BUILD);
 
@@ -22,23 +30,91 @@ class MechTrak : public BakkesMod::Plugin::BakkesModPlugin,
     public BakkesMod::Plugin::PluginWindow
 {
 private:
-    std::map<int, ShotStats> shotStats;
-    std::map<int, std::string> shotTypes;
+    // Shot table and names live in the session's arena; see SessionArena
+    SessionArena arena;
+    ShotTable shotStats{ &arena };
+    ShotNames shotTypes{ &arena };
     int currentShotNumber = 1;
 
+    // Attempts and edits reach shotStats through this log; see Record()
+    SessionLog sessionLog;
+    // Totals, rolling figures and the HUD trend line over shotStats; read
+    // through Aggregates(), Metrics() and Trend()
+    SessionAggregates aggregates;
+    LiveMetrics metrics;
+    TrendGraph trend;
+    // Cached tiles for the pack grid; dropped whenever the figures change
+    ShotGrid grid;
+    // Attempts against time for the timeline panel (mechtrak_timeline)
+    SessionTimeline timeline;
+    bool showTimeline = false;
+
     std::chrono::steady_clock::time_point lastGoalTime;
     int lastKnownScore = 0;
     bool roundActive = false;
     bool justRecordedAttempt = false;
+    // SessionMs() of the last shot reset and of the first touch after it, 0
+    // while unknown; each recorded attempt carries them
+    uint32_t roundStartMs = 0;
+    uint32_t firstTouchMs = 0;
 
     std::string sessionId;
     std::chrono::system_clock::time_point sessionStartTime;
     bool sessionActive = false;
 
+    // onLoad -> first HUD frame with stats, logged once
+    std::chrono::steady_clock::time_point loadStarted;
+    bool firstFrameLogged = false;
+
+    // Written each frame on the game thread, read by the SyncWorker
+    std::atomic<bool> inCustomTraining{ false };
+    // Set once onUnload starts; background work stops posting to the game
+    // thread, since the plugin may be gone by the next tick
+    std::atomic<bool> unloading{ false };
+
+    // All-time analytics panel (mechtrak_analytics). A run on a Lifecycle
+    // thread swaps in a new report under analyticsMtx; Render draws it.
+    bool showAnalytics = false;
+    std::mutex analyticsMtx;
+    std::shared_ptr<const AnalyticsReport> analytics;
+    std::atomic<bool>   analyticsRunning{ false };
+    std::atomic<size_t> analyticsDone{ 0 };
+    std::atomic<size_t> analyticsTotal{ 0 };
+
     void OnBallExplode(std::string eventName);
     void OnGoalScored(std::string eventName);
     void OnShotReset(std::string eventName);
 
+    // Hands a snapshot of the session to the SyncWorker for save + upload
+    void QueueSync(SyncWorker::Trigger trigger);
+    // Applies a session fetched on another thread on the next game tick.
+    // With replacing set, only if that is still the live session; it is
+    // then marked ended first.
+    void PostActive(Session::ActiveSession fetched, std::string replacing = "");
+
+    // Applies e to shotStats through the session log
+    bool Record(const ShotEvent& e);
+
+    // Rebuilt first if a background load changed the tables
+    const SessionAggregates& Aggregates();
+    const LiveMetrics& Metrics();
+    const TrendGraph& Trend();
+    // After the session log applied, or undid, e
+    void Retally(const ShotEvent& e, bool undone);
+    // After shotStats was replaced on the game thread
+    void Retally();
+    // Seals what the memory budget asks for; the journal writes it leaves
+    // run on the Scheduler, never on the game thread
+    void Spill();
+    // Milliseconds since sessionStartTime, 0 before it
+    uint32_t SessionMs() const;
+    // Times of the round in play, ending now
+    AttemptTime RoundTime() const { return { roundStartMs, firstTouchMs, SessionMs() }; }
+
+    // Plugin reload: onUnload writes the members above, onLoad takes them back
+    void SaveHandoff();
+    bool TakeHandoff();
+
 public:
     void onLoad()   override;
     void onUnload() override;
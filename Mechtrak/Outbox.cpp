@@ -0,0 +1,232 @@
+#include "Outbox.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <random>
+#include <cstdio>
+#include <cctype>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto BACKOFF_BASE = std::chrono::seconds(2);
+constexpr auto BACKOFF_MAX = std::chrono::minutes(5);
+constexpr auto MIN_SEND_GAP = std::chrono::milliseconds(250);   // caps drain rate at 4 req/s
+
+struct Entry {
+    uint64_t seq = 0;
+    std::string key;
+    std::filesystem::path path;
+};
+
+std::mutex                                mtx;
+std::filesystem::path                     dir;
+std::map<uint64_t, Entry>                 queue;       // oldest first
+std::unordered_map<std::string, uint64_t> bySession;   // key -> pending seq
+uint64_t           nextSeq = 1;
+int                failures = 0;
+uint64_t           sentCount = 0;
+uint64_t           failedCount = 0;
+uint64_t           rejectedCount = 0;
+std::string        lastRejected;
+Clock::time_point  retryAt{};
+Clock::time_point  lastSend{};
+std::mt19937       rng{ std::random_device{}() };
+
+// Session ids come from the server; keep filenames boring
+std::string SanitizeKey(const std::string& sessionId)
+{
+    std::string key = sessionId;
+    for (auto& c : key)
+        if (!isalnum((unsigned char)c) && c != '_' && c != '-') c = '_';
+    return key.empty() ? "unknown" : key;
+}
+
+std::filesystem::path EntryPath(uint64_t seq, const std::string& key)
+{
+    char num[24];
+    std::snprintf(num, sizeof(num), "%012llu", (unsigned long long)seq);
+    return dir / (std::string(num) + "_" + key + ".json");
+}
+
+// Exponential backoff with "equal jitter": half fixed, half random, so a
+// fleet of clients coming back online doesn't retry in lockstep
+Clock::duration Backoff(int failureCount)
+{
+    auto delay = std::chrono::duration_cast<Clock::duration>(BACKOFF_BASE);
+    for (int i = 1; i < failureCount && delay < BACKOFF_MAX; i++) delay *= 2;
+    if (delay > BACKOFF_MAX) delay = std::chrono::duration_cast<Clock::duration>(BACKOFF_MAX);
+    std::uniform_int_distribution<long long> jitter(0, delay.count() / 2);
+    return Clock::duration(delay.count() / 2 + jitter(rng));
+}
+
+// Caller holds mtx
+void RemoveLocked(std::map<uint64_t, Entry>::iterator it)
+{
+    std::error_code ec;
+    std::filesystem::remove(it->second.path, ec);
+    auto s = bySession.find(it->second.key);
+    if (s != bySession.end() && s->second == it->first) bySession.erase(s);
+    queue.erase(it);
+}
+
+} // namespace
+
+void Outbox::Open(const std::string& folder)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (folder.empty()) return;
+    dir = std::filesystem::path(folder) / "outbox";
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    for (const auto& file : std::filesystem::directory_iterator(dir, ec)) {
+        const auto& p = file.path();
+        if (p.extension() == ".tmp") { std::filesystem::remove(p, ec); continue; }
+        if (p.extension() != ".json") continue;
+
+        std::string stem = p.stem().string();
+        size_t us = stem.find('_');
+        if (us == std::string::npos || us == 0) continue;
+        uint64_t seq;
+        try { seq = std::stoull(stem.substr(0, us)); }
+        catch (...) { continue; }
+        if (queue.count(seq)) continue;
+
+        queue[seq] = Entry{ seq, stem.substr(us + 1), p };
+        if (seq >= nextSeq) nextSeq = seq + 1;
+    }
+
+    // Collapse duplicates a crash may have left: newest snapshot wins
+    bySession.clear();
+    for (auto it = queue.rbegin(); it != queue.rend();) {
+        auto [s, inserted] = bySession.emplace(it->second.key, it->first);
+        if (inserted) { ++it; continue; }
+        std::filesystem::remove(it->second.path, ec);
+        it = std::make_reverse_iterator(queue.erase(std::next(it).base()));
+    }
+}
+
+void Outbox::Enqueue(const std::string& sessionId, const std::string& body)
+{
+    uint64_t seq;
+    std::string key = SanitizeKey(sessionId);
+    std::filesystem::path path;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (dir.empty()) return;
+        seq = nextSeq++;
+        path = EntryPath(seq, key);
+    }
+
+    // Write outside the lock, then publish with an atomic rename
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return;
+        file.write(body.data(), (std::streamsize)body.size());
+        if (!file) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) return;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto existing = bySession.find(key);
+    if (existing != bySession.end()) {
+        if (existing->second > seq) {
+            // An even newer snapshot landed while we were writing
+            std::filesystem::remove(path, ec);
+            return;
+        }
+        auto old = queue.find(existing->second);
+        if (old != queue.end()) RemoveLocked(old);
+    }
+    queue[seq] = Entry{ seq, key, path };
+    bySession[key] = seq;
+}
+
+bool Outbox::Take(Next& next)
+{
+    next.wait = std::chrono::milliseconds(0);
+    for (;;) {
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            auto now = Clock::now();
+            if (queue.empty() || now < retryAt) return false;
+            if (now < lastSend + MIN_SEND_GAP) {
+                next.wait = std::chrono::ceil<std::chrono::milliseconds>(lastSend + MIN_SEND_GAP - now);
+                return false;
+            }
+            entry = queue.begin()->second;
+        }
+
+        std::string body;
+        {
+            std::ifstream file(entry.path, std::ios::binary);
+            if (file.is_open())
+                body.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        if (body.empty()) {
+            // Replaced or deleted underneath us
+            std::lock_guard<std::mutex> lock(mtx);
+            auto it = queue.find(entry.seq);
+            if (it != queue.end()) RemoveLocked(it);
+            continue;
+        }
+        next.seq = entry.seq;
+        next.key = entry.key;
+        next.body = std::move(body);
+        return true;
+    }
+}
+
+void Outbox::Settle(const Next& next, Result result)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    lastSend = Clock::now();
+    if (result == Result::Failed) {
+        failedCount++;
+        failures++;
+        retryAt = lastSend + Backoff(failures);
+        return;
+    }
+    // A rejection still means the server is up
+    failures = 0;
+    retryAt = {};
+    if (result == Result::Sent) sentCount++;
+    else {
+        rejectedCount++;
+        lastRejected = next.key;
+    }
+    auto it = queue.find(next.seq);
+    if (it != queue.end()) RemoveLocked(it);
+}
+
+void Outbox::NotifyOnline()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    retryAt = {};
+}
+
+Outbox::Status Outbox::GetStatus()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Status s;
+    s.pending = queue.size();
+    s.consecutiveFailures = failures;
+    s.sent = sentCount;
+    s.failed = failedCount;
+    s.rejected = rejectedCount;
+    s.lastRejected = lastRejected;
+    auto now = Clock::now();
+    if (retryAt > now)
+        s.retryIn = std::chrono::duration_cast<std::chrono::milliseconds>(retryAt - now);
+    return s;
+}
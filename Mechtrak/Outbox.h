@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// Persistent queue of session uploads the backend has not acknowledged yet.
+// Each entry is a full session snapshot stored as its own file under
+// rl_best_stats\outbox, named <seq>_<sessionId>.json so the queue survives a
+// game restart and drains in order. A newer snapshot of the same session
+// replaces the pending one instead of queueing behind it.
+class Outbox {
+public:
+    struct Status {
+        size_t   pending = 0;
+        int      consecutiveFailures = 0;
+        uint64_t sent = 0;
+        uint64_t failed = 0;
+        uint64_t rejected = 0;
+        std::string lastRejected;   // session of the newest one, "" if none
+        std::chrono::milliseconds retryIn{ 0 };
+    };
+
+    // What became of one send
+    enum class Result {
+        Sent,       // the backend accepted the body
+        Rejected,   // it answered that it never will (a 4xx); the entry is dropped
+        Failed      // no answer, or one worth retrying; the entry stays, with backoff
+    };
+
+    // The entry to send next, handed out by Take and given back to Settle
+    struct Next {
+        uint64_t    seq = 0;
+        std::string key;
+        std::string body;
+        std::chrono::milliseconds wait{ 0 };   // when Take declines: until the gap ends
+    };
+
+    // Loads entries left over from a previous run. Safe to call again.
+    static void Open(const std::string& folder);
+
+    static void Enqueue(const std::string& sessionId, const std::string& body);
+
+    // The oldest entry and its body, so a drain sends entries in order one
+    // at a time and settles each before taking the next. False while the
+    // queue is empty or backing off, or until the gap since the last send
+    // has passed; wait then says how long that is, 0 in the other cases.
+    static bool Take(Next& next);
+    // Records what became of the entry Take handed out. Sent and Rejected
+    // remove it; Failed keeps it first and starts the backoff.
+    static void Settle(const Next& next, Result result);
+
+    // Clears the backoff so the next Take hands out an entry immediately (e.g. after any
+    // other request to the server succeeded).
+    static void NotifyOnline();
+
+    static Status GetStatus();
+};
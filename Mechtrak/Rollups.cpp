@@ -0,0 +1,350 @@
+#include "Rollups.h"
+#include "Codec.h"
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <ctime>
+#include <cstdio>
+
+namespace {
+
+constexpr char    MAGIC[4] = { 'M', 'T', 'K', 'U' };
+constexpr uint8_t VERSION = 1;
+
+using Resolution = Rollups::Resolution;
+using Bucket = Rollups::Bucket;
+
+// One type at one resolution, dense from origin
+struct Track {
+    int32_t origin = 0;
+    std::vector<Bucket> buckets;
+
+    void Add(int32_t b, int attempts, int goals)
+    {
+        if (buckets.empty()) origin = b;
+        if (b < origin) {
+            buckets.insert(buckets.begin(), (size_t)(origin - b), Bucket());
+            origin = b;
+        }
+        size_t i = (size_t)(b - origin);
+        if (i >= buckets.size()) buckets.resize(i + 1);
+        buckets[i].attempts += attempts;
+        buckets[i].goals += goals;
+    }
+
+    Bucket Get(int32_t b) const
+    {
+        if (b < origin || (size_t)(b - origin) >= buckets.size()) return Bucket();
+        return buckets[(size_t)(b - origin)];
+    }
+};
+
+struct Table {
+    Track by[Rollups::RESOLUTIONS];
+};
+
+// What rollups.mtk holds, one entry per type and resolution
+struct Stored {
+    std::string type;
+    int resolution = 0;
+    int32_t origin = 0;
+    std::vector<Bucket> buckets;
+};
+
+std::mutex                             mtx;
+std::mutex                             saveMtx;    // keeps saves in the order they were made
+std::filesystem::path                  file;
+std::unordered_map<std::string, Table> tables;     // ALL ("") holds the sum over types
+
+// ── Calendar — proleptic Gregorian, days since 1970-01-01 ───────────────────
+
+int64_t FloorDiv(int64_t a, int64_t b)
+{
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+int64_t DaysFromCivil(int64_t y, int m, int d)
+{
+    y -= m <= 2;
+    int64_t era = FloorDiv(y, 400);
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void CivilFromDays(int64_t z, int64_t& y, int& m, int& d)
+{
+    z += 719468;
+    int64_t era = FloorDiv(z, 146097);
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    y = yoe + era * 400 + (m <= 2);
+}
+
+// Local hours since 1970-01-01 00:00, and the seconds t is into that hour.
+// Callers hold mtx: localtime shares a buffer.
+int64_t LocalHour(int64_t t, int64_t* into = nullptr)
+{
+    std::time_t tt = (std::time_t)t;
+    std::tm* lt = std::localtime(&tt);
+    if (!lt) {
+        if (into) *into = t - FloorDiv(t, 3600) * 3600;
+        return FloorDiv(t, 3600);
+    }
+    if (into) *into = lt->tm_min * 60 + std::min(lt->tm_sec, 59);
+    return DaysFromCivil(lt->tm_year + 1900LL, lt->tm_mon + 1, lt->tm_mday) * 24 + lt->tm_hour;
+}
+
+int32_t FromHour(int64_t hour, Resolution res)
+{
+    int64_t day = FloorDiv(hour, 24);
+    switch (res) {
+    case Resolution::Hour:  return (int32_t)hour;
+    case Resolution::Day:   return (int32_t)day;
+    case Resolution::Week:  return (int32_t)FloorDiv(day + 3, 7);    // 1970-01-05 was a Monday
+    case Resolution::Month: {
+        int64_t y; int m, d;
+        CivilFromDays(day, y, m, d);
+        return (int32_t)(y * 12 + m - 1);
+    }
+    }
+    return 0;
+}
+
+void AddHour(const std::string& type, int64_t hour, int attempts, int goals)
+{
+    Table& one = tables[type];
+    Table& all = tables[Rollups::ALL];
+    for (int r = 0; r < Rollups::RESOLUTIONS; r++) {
+        int32_t b = FromHour(hour, (Resolution)r);
+        one.by[r].Add(b, attempts, goals);
+        all.by[r].Add(b, attempts, goals);
+    }
+}
+
+// Places a timed attempt at its end time and any other attempt i of n at the
+// middle of its share of the session, and folds each run of attempts that
+// land in the same local hour in one go
+void AddSession(const ImportedSession& s)
+{
+    if (!s.completed || s.startTime <= 0) return;
+    int64_t span = std::max(0, s.durationMinutes) * 60LL;
+
+    int64_t hourFrom = 1, hourTo = 0, hour = 0;   // unix range the cached local hour covers
+    for (const auto& shot : s.shots) {
+        const auto& h = shot.attemptHistory;
+        std::string type = shot.shotType.empty() ? std::string("Unknown") : shot.shotType;
+        if (h.empty()) {
+            // Older files may have counters without a history
+            if (shot.attempts > 0) AddHour(type, LocalHour(s.startTime), shot.attempts, shot.goals);
+            continue;
+        }
+
+        // Times cover the newest attempts
+        size_t untimed = h.size() - std::min(h.size(), timing::Count(shot.attemptTimes));
+        int64_t runHour = 0;
+        int runAttempts = 0, runGoals = 0;
+        for (size_t i = 0; i < h.size(); i++) {
+            uint32_t end = i >= untimed ? timing::At(shot.attemptTimes, i - untimed).end : 0;
+            int64_t t = end != 0 ? s.startTime + end / 1000 :
+                s.startTime + (int64_t)((2 * i + 1) * span / (2 * h.size()));
+            if (t < hourFrom || t >= hourTo) {
+                int64_t into = 0;
+                hour = LocalHour(t, &into);
+                hourFrom = t - into;
+                hourTo = hourFrom + 3600;
+            }
+            if (runAttempts > 0 && hour != runHour) {
+                AddHour(type, runHour, runAttempts, runGoals);
+                runAttempts = runGoals = 0;
+            }
+            runHour = hour;
+            runAttempts++;
+            runGoals += h[i];
+        }
+        if (runAttempts > 0) AddHour(type, runHour, runAttempts, runGoals);
+    }
+}
+
+} // namespace
+
+template<>
+struct codec::Schema<Rollups::Bucket> {
+    static constexpr auto fields = std::make_tuple(
+        Member<Rollups::Bucket, int>{ "attempts", &Rollups::Bucket::attempts },
+        Member<Rollups::Bucket, int>{ "goals", &Rollups::Bucket::goals }
+    );
+};
+
+template<>
+struct codec::Schema<Stored> {
+    static constexpr auto fields = std::make_tuple(
+        Member<Stored, std::string>{ "type", &Stored::type },
+        Member<Stored, int>{ "resolution", &Stored::resolution },
+        Member<Stored, int32_t>{ "origin", &Stored::origin },
+        Member<Stored, std::vector<Rollups::Bucket>>{ "buckets", &Stored::buckets }
+    );
+};
+
+namespace {
+
+std::string Encode()
+{
+    std::vector<Stored> list;
+    for (const auto& [type, table] : tables)
+        for (int r = 0; r < Rollups::RESOLUTIONS; r++)
+            list.push_back({ type, r, table.by[r].origin, table.by[r].buckets });
+
+    std::string out(MAGIC, sizeof(MAGIC));
+    out.push_back((char)VERSION);
+    codec::Encode(out, list);
+    return out;
+}
+
+void Save()
+{
+    std::lock_guard<std::mutex> order(saveMtx);
+    std::string out;
+    std::filesystem::path target;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (file.empty()) return;
+        out = Encode();
+        target = file;
+    }
+
+    // Write beside the target and rename so a crash never leaves half a file
+    std::filesystem::path tmp = target;
+    tmp += ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) return;
+        f.write(out.data(), (std::streamsize)out.size());
+        if (!f) return;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, target, ec);
+}
+
+} // namespace
+
+void Rollups::Open(const std::string& folder)
+{
+    std::filesystem::path path = std::filesystem::path(folder) / "rollups.mtk";
+    std::ifstream f(path, std::ios::binary);
+    std::string in;
+    if (f.is_open()) in.assign((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    std::vector<Stored> list;
+    size_t pos = 5;
+    bool ok = in.size() >= 5 && in.compare(0, 4, MAGIC, 4) == 0 && (uint8_t)in[4] == VERSION &&
+        codec::Decode(in, pos, list);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    file = path;
+    tables.clear();
+    if (!ok) return;
+    for (auto& s : list) {
+        if (s.resolution < 0 || s.resolution >= RESOLUTIONS) continue;
+        Track& series = tables[s.type].by[s.resolution];
+        series.origin = s.origin;
+        series.buckets = std::move(s.buckets);
+    }
+}
+
+void Rollups::Add(const ImportedSession& session)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        AddSession(session);
+    }
+    Save();
+}
+
+void Rollups::Rebuild(const std::vector<ImportedSession>& sessions)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        tables.clear();
+        for (const auto& s : sessions) AddSession(s);
+    }
+    Save();
+}
+
+int32_t Rollups::BucketOf(int64_t t, Resolution res)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return FromHour(LocalHour(t), res);
+}
+
+std::string Rollups::Label(int32_t bucket, Resolution res)
+{
+    int64_t y; int m, d;
+    char buf[32];
+    switch (res) {
+    case Resolution::Hour:
+        CivilFromDays(FloorDiv(bucket, 24), y, m, d);
+        std::snprintf(buf, sizeof(buf), "%04lld-%02d-%02d %02dh", (long long)y, m, d, (int)(bucket - FloorDiv(bucket, 24) * 24));
+        break;
+    case Resolution::Day:
+        CivilFromDays(bucket, y, m, d);
+        std::snprintf(buf, sizeof(buf), "%04lld-%02d-%02d", (long long)y, m, d);
+        break;
+    case Resolution::Week:
+        CivilFromDays((int64_t)bucket * 7 - 3, y, m, d);
+        std::snprintf(buf, sizeof(buf), "%04lld-%02d-%02d", (long long)y, m, d);
+        break;
+    case Resolution::Month:
+        std::snprintf(buf, sizeof(buf), "%04lld-%02d", (long long)FloorDiv(bucket, 12), (int)(bucket - FloorDiv(bucket, 12) * 12) + 1);
+        break;
+    default:
+        return "";
+    }
+    return buf;
+}
+
+Rollups::Bucket Rollups::Get(const std::string& type, Resolution res, int32_t bucket)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = tables.find(type);
+    return it != tables.end() ? it->second.by[(int)res].Get(bucket) : Bucket();
+}
+
+std::vector<Rollups::Bucket> Rollups::Series(const std::string& type, Resolution res, int32_t first, size_t count)
+{
+    std::vector<Bucket> out(count);
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = tables.find(type);
+    if (it == tables.end()) return out;
+    const Track& s = it->second.by[(int)res];
+    for (size_t i = 0; i < count; i++) out[i] = s.Get(first + (int32_t)i);
+    return out;
+}
+
+int32_t Rollups::Latest(Resolution res)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = tables.find(ALL);
+    if (it == tables.end() || it->second.by[(int)res].buckets.empty()) return -1;
+    const Track& s = it->second.by[(int)res];
+    return s.origin + (int32_t)s.buckets.size() - 1;
+}
+
+std::vector<std::string> Rollups::Types()
+{
+    std::vector<std::string> out;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& [type, table] : tables)
+            if (type != ALL) out.push_back(type);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
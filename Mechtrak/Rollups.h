@@ -0,0 +1,56 @@
+#pragma once
+#include "Importer.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Long-term progress store: attempts and goals per shot type in hourly, daily,
+// weekly and monthly buckets, kept in rl_best_stats\rollups.mtk. Completed
+// sessions are folded in once, on session end, so a graph of accuracy over
+// months reads a few hundred buckets instead of every saved session.
+// stats_import rebuilds it from history.mtk.
+//
+// Buckets are numbered in local calendar time: hours and days since
+// 1970-01-01, weeks since the Monday before it, months since year 0. Every
+// series is dense from its first bucket to its last, so a bucket read is an
+// index. Attempts carry no time of their own; a session's attempts are spread
+// evenly over its duration. Kept free of BakkesMod like the Importer.
+// Thread safe.
+class Rollups {
+public:
+    enum class Resolution { Hour, Day, Week, Month };
+    static constexpr int RESOLUTIONS = 4;
+
+    struct Bucket {
+        int attempts = 0;
+        int goals = 0;
+
+        // 0..1, 0 with no attempts
+        float Accuracy() const { return attempts > 0 ? (float)goals / attempts : 0.f; }
+    };
+
+    // Shot type name that reads the total over every type
+    static constexpr const char* ALL = "";
+
+    // Loads rollups.mtk from folder; later saves go back there. Safe to call again.
+    static void Open(const std::string& folder);
+
+    // Folds in one finished session and saves. Incomplete sessions are skipped.
+    static void Add(const ImportedSession& session);
+    // Replaces every bucket with the completed sessions in the list and saves
+    static void Rebuild(const std::vector<ImportedSession>& sessions);
+
+    // Bucket holding unix time t
+    static int32_t BucketOf(int64_t t, Resolution res);
+    // "2026-10-19 14h", "2026-10-19", "2026-10-19" (the Monday), "2026-10"
+    static std::string Label(int32_t bucket, Resolution res);
+
+    // Zero bucket for an unknown type or a bucket with nothing played
+    static Bucket Get(const std::string& type, Resolution res, int32_t bucket);
+    // count buckets starting at first, oldest first
+    static std::vector<Bucket> Series(const std::string& type, Resolution res, int32_t first, size_t count);
+    // Last bucket anything was played in, across types; -1 when empty
+    static int32_t Latest(Resolution res);
+    // Shot types seen so far, sorted, without ALL
+    static std::vector<std::string> Types();
+};
@@ -0,0 +1,226 @@
+#include "Scheduler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <array>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ms = std::chrono::milliseconds;
+
+constexpr ms       TICK = ms(10);
+constexpr uint64_t SLOTS = 512;
+
+struct Timer {
+    Scheduler::TimerId id = 0;
+    uint64_t           due = 0;      // absolute tick
+    ms                 period{ 0 };  // 0 = one-shot
+    Scheduler::Task    task;
+};
+
+using Slot = std::list<Timer>;
+
+std::mutex              mtx;
+std::condition_variable cv;
+std::thread             worker;
+std::thread::id         threadId;
+bool                    running = false;
+bool                    stopping = false;
+
+std::array<Slot, SLOTS> wheel;
+std::unordered_map<Scheduler::TimerId, Slot::iterator> byId;
+Clock::time_point epoch{};
+uint64_t          processed = 0;     // every tick up to here has been dispatched
+Scheduler::TimerId nextId = 1;
+
+// Timers collected for the current dispatch pass; Cancel zeroes an id here
+// to stop a task that is due but has not started yet
+std::vector<Timer> batch;
+
+// Set while a timer's task runs so Cancel can stop a periodic re-arm
+Scheduler::TimerId runningId = 0;
+bool               runningPeriodic = false;
+bool               runningCancelled = false;
+
+uint64_t TickAt(Clock::time_point t)
+{
+    return (uint64_t)std::chrono::duration_cast<ms>(t - epoch).count() / TICK.count();
+}
+
+// Caller holds mtx. Rounds up so a timer never fires early.
+void InsertLocked(Timer timer, ms delay)
+{
+    auto at = std::chrono::ceil<ms>(Clock::now() - epoch) + std::max(ms(0), delay);
+    uint64_t due = (uint64_t)((at.count() + TICK.count() - 1) / TICK.count());
+    timer.due = std::max(due, processed + 1);
+    Slot& slot = wheel[timer.due % SLOTS];
+    slot.push_back(std::move(timer));
+    byId[slot.back().id] = std::prev(slot.end());
+}
+
+// Caller holds mtx. Moves everything due at or before `tick` out of its slot.
+void CollectLocked(uint64_t tick, std::vector<Timer>& out)
+{
+    Slot& slot = wheel[tick % SLOTS];
+    for (auto it = slot.begin(); it != slot.end();) {
+        if (it->due <= tick) {
+            byId.erase(it->id);
+            out.push_back(std::move(*it));
+            it = slot.erase(it);
+        }
+        else ++it;
+    }
+}
+
+// Caller holds mtx. Earliest tick with something due, scanning at most one
+// revolution; UINT64_MAX if the wheel is empty.
+uint64_t NextDueLocked()
+{
+    if (byId.empty()) return UINT64_MAX;
+    uint64_t best = UINT64_MAX;
+    for (uint64_t t = processed + 1; t <= processed + SLOTS; t++) {
+        for (const auto& timer : wheel[t % SLOTS])
+            if (timer.due < best) best = timer.due;
+        if (best <= t) return best;
+    }
+    return best;
+}
+
+void Loop()
+{
+    std::vector<Timer>& due = batch;
+    std::unique_lock<std::mutex> lock(mtx);
+    while (!stopping) {
+        uint64_t now = TickAt(Clock::now());
+
+        if (processed < now) {
+            // After a long stall one pass over the wheel covers every slot
+            uint64_t from = now - processed > SLOTS ? now - SLOTS + 1 : processed + 1;
+            for (uint64_t t = from; t <= now; t++) CollectLocked(t, due);
+            processed = now;
+        }
+
+        if (due.empty()) {
+            uint64_t next = NextDueLocked();
+            if (next == UINT64_MAX) cv.wait(lock);
+            else cv.wait_until(lock, epoch + TICK * (int64_t)next);
+            continue;
+        }
+
+        for (auto& timer : due) {
+            if (stopping) break;
+            if (timer.id == 0) continue;
+            runningId = timer.id;
+            runningPeriodic = timer.period.count() > 0;
+            runningCancelled = false;
+            lock.unlock();
+            timer.task();
+            lock.lock();
+            if (timer.period.count() > 0 && !runningCancelled && !stopping) {
+                ms period = timer.period;
+                InsertLocked(std::move(timer), period);
+            }
+            runningId = 0;
+        }
+        due.clear();
+    }
+    due.clear();
+}
+
+Scheduler::TimerId Arm(ms delay, ms period, Scheduler::Task task)
+{
+    Scheduler::TimerId id;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return 0;
+        id = nextId++;
+        InsertLocked(Timer{ id, 0, period, std::move(task) }, delay);
+    }
+    cv.notify_all();
+    return id;
+}
+
+} // namespace
+
+void Scheduler::Start()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) return;
+    running = true;
+    stopping = false;
+    epoch = Clock::now();
+    processed = 0;
+    worker = std::thread(Loop);
+    threadId = worker.get_id();
+}
+
+void Scheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        if (std::this_thread::get_id() == threadId) worker.detach();
+        else worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& slot : wheel) slot.clear();
+    byId.clear();
+    running = false;
+    threadId = std::thread::id();
+}
+
+Scheduler::TimerId Scheduler::After(std::chrono::milliseconds delay, Task task)
+{
+    return Arm(delay, ms(0), std::move(task));
+}
+
+Scheduler::TimerId Scheduler::Every(std::chrono::milliseconds period, Task task)
+{
+    return Arm(period, std::max(TICK, period), std::move(task));
+}
+
+bool Scheduler::Cancel(TimerId id)
+{
+    if (id == 0) return false;
+    std::lock_guard<std::mutex> lock(mtx);
+    if (id == runningId) {
+        runningCancelled = runningPeriodic;
+        return runningPeriodic;
+    }
+    auto it = byId.find(id);
+    if (it == byId.end()) {
+        for (auto& timer : batch)
+            if (timer.id == id) { timer.id = 0; return true; }
+        return false;
+    }
+    wheel[it->second->due % SLOTS].erase(it->second);
+    byId.erase(it);
+    return true;
+}
+
+Scheduler::TimerId Scheduler::Reset(TimerId id, std::chrono::milliseconds delay, Task task)
+{
+    Cancel(id);
+    return After(delay, std::move(task));
+}
+
+size_t Scheduler::Pending()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return byId.size();
+}
+
+bool Scheduler::OnSchedulerThread()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return std::this_thread::get_id() == threadId;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <functional>
+#include <chrono>
+#include <cstdint>
+
+// The plugin's one background thread. Timers live in a hashed timing wheel
+// (10 ms ticks, 512 slots) so arming and cancelling are O(1) however many
+// are pending; the thread sleeps until the next due slot rather than
+// waking every tick. Tasks run on the scheduler thread one at a time, so
+// anything scheduled here (uploads, heartbeat, token refresh) never
+// overlaps with anything else scheduled here.
+class Scheduler {
+public:
+    using TimerId = uint64_t;   // 0 is never a valid id
+    using Task = std::function<void()>;
+
+    static void Start();
+    // Drops every pending timer and joins the thread once the running task
+    // (if any) returns. Safe to call more than once.
+    static void Stop();
+
+    static TimerId After(std::chrono::milliseconds delay, Task task);
+    // Runs task every period until cancelled; the next run is armed after
+    // the current one returns, so a slow task never stacks up
+    static TimerId Every(std::chrono::milliseconds period, Task task);
+
+    // Returns false if the timer already fired or never existed. A periodic
+    // timer cancelled from inside its own task is not re-armed.
+    static bool Cancel(TimerId id);
+
+    // Cancels id (if set) and arms a new one-shot in its place
+    static TimerId Reset(TimerId id, std::chrono::milliseconds delay, Task task);
+
+    static size_t Pending();
+    static bool OnSchedulerThread();
+};
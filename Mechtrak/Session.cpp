@@ -1,15 +1,199 @@
 #include "pch.h"
 #include "Session.h"
-#include "Config.h"
-#include <winhttp.h>
+#include "Http.h"
+#include "JsonReader.h"
+#include "SessionJson.h"
+#include "SessionLog.h"
+#include "Outbox.h"
+#include "SyncWorker.h"
+#include "Scheduler.h"
 #include <fstream>
 #include <filesystem>
 #include <chrono>
+#include <charconv>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
 
 
 std::string Session::cachedToken = "";
 
 
+namespace {
+
+std::mutex                            tokenMutex;
+std::chrono::steady_clock::time_point tokenFetched{};
+
+std::atomic<Scheduler::TimerId> outboxRetry{ 0 };
+
+// One drain runs at a time, sending at most DRAIN_MAX entries; DrainOutbox
+// calls that arrive meanwhile wait for it to stop
+constexpr size_t DRAIN_MAX = 16;
+std::mutex       drainMutex;
+bool             draining = false;
+std::vector<std::function<void()>> drainWaiters;
+
+std::atomic<uint64_t> tableVersion{ 0 };
+
+std::mutex    liveMutex;
+Session::Live live;
+
+// Names the session LoadSnapshot warm-starts from; rewritten only when the
+// active session changes
+constexpr const char* CURRENT_FILE = "current_session";
+std::mutex  currentMutex;
+std::string currentId;
+
+void WriteCurrent(const std::string& folderPath, const std::string& sessionId)
+{
+    std::lock_guard<std::mutex> lock(currentMutex);
+    if (currentId == sessionId) return;
+    std::ofstream out(folderPath + "\\" + CURRENT_FILE, std::ios::binary | std::ios::trunc);
+    if (out.is_open()) {
+        out << sessionId;
+        currentId = sessionId;
+    }
+}
+
+// A handler and the parser feeding it, kept alive by the request reading into them
+template<typename Handler>
+struct JsonCall {
+    Handler          handler;
+    JsonStreamParser parser{ handler };
+
+    template<typename... Args>
+    explicit JsonCall(Args&&... args) : handler(std::forward<Args>(args)...) {}
+};
+
+// Sends request with the body fed to call's parser chunk by chunk as it
+// arrives, so it is never buffered whole. done runs on the Scheduler after
+// the last chunk; call parser.Finish() there.
+template<typename Handler>
+void FetchJson(HttpRequest request, std::shared_ptr<JsonCall<Handler>> call, Http::Completion done)
+{
+    request.onChunk = [call](std::string_view chunk) { call->parser.Feed(chunk); };
+    Http::SendScheduled(std::move(request), std::move(done));
+}
+
+std::wstring JsonHeaders(const std::string& token)
+{
+    std::wstring headers = L"Content-Type: application/json\r\n";
+    if (!token.empty())
+        headers += L"Authorization: Bearer " + std::wstring(token.begin(), token.end()) + L"\r\n";
+    return headers;
+}
+
+// POST /api/sessions
+HttpRequest PostSession(std::string body)
+{
+    HttpRequest request;
+    request.method = L"POST";
+    request.path = L"/api/sessions";
+    request.headers = JsonHeaders("");
+    request.body = std::move(body);
+    request.timeout = std::chrono::seconds(20);
+    return request;
+}
+
+// What the outbox makes of the answer to PostSession
+Outbox::Result Judge(std::shared_ptr<CVarManagerWrapper> cvarManager, const HttpResponse& response)
+{
+    // A status read before a timeout or cancel is no answer
+    uint32_t status = response.Answered() ? response.status : 0;
+    if (status == 200) {
+        cvarManager->log("Session uploaded successfully!");
+        SyncWorker::NoteContact();   // doubles as a heartbeat
+        return Outbox::Result::Sent;
+    }
+    // The server will never take this body; don't let it block the queue
+    if (status >= 400 && status < 500 && status != 408 && status != 429) {
+        cvarManager->log("MechTrak: upload rejected with " + std::to_string(status) + ", dropped from the outbox");
+        return Outbox::Result::Rejected;
+    }
+    cvarManager->log("Upload failed: " + std::to_string(status));
+    return Outbox::Result::Failed;
+}
+
+void EndDrain(std::shared_ptr<CVarManagerWrapper> cvarManager)
+{
+    // Come back when the backoff ends instead of waiting for the next upload
+    // or heartbeat to notice
+    auto st = Outbox::GetStatus();
+    Scheduler::Cancel(outboxRetry.exchange(0));
+    if (st.pending > 0) {
+        auto delay = std::max<std::chrono::milliseconds>(st.retryIn, std::chrono::seconds(1));
+        outboxRetry = Scheduler::After(delay, [cvarManager]() { Session::DrainOutbox(cvarManager); });
+    }
+
+    std::vector<std::function<void()>> waiting;
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        draining = false;
+        waiting.swap(drainWaiters);
+    }
+    for (auto& done : waiting)
+        if (done) done();
+}
+
+// Sends the oldest entry and settles it from the completion, which goes on
+// to the next; the send gap is a timer, so nothing waits on the scheduler
+void DrainStep(std::shared_ptr<CVarManagerWrapper> cvarManager, size_t left)
+{
+    Outbox::Next next;
+    if (left == 0 || !Outbox::Take(next)) {
+        if (left > 0 && next.wait.count() > 0 &&
+            Scheduler::After(next.wait, [cvarManager, left]() { DrainStep(cvarManager, left); }))
+            return;
+        EndDrain(cvarManager);
+        return;
+    }
+    HttpRequest request = PostSession(std::move(next.body));
+    next.body.clear();
+    Http::SendScheduled(std::move(request), [cvarManager, next, left](HttpResponse&& response) {
+        Outbox::Result result = Judge(cvarManager, response);
+        Outbox::Settle(next, result);
+        if (result == Outbox::Result::Failed) EndDrain(cvarManager);
+        else DrainStep(cvarManager, left - 1);
+    });
+}
+
+// Folds the server's copy of the session we already hold into the live
+// tables. Shot types come from the server, since the dashboard owns names.
+// For stats the copy with more attempts wins: a local snapshot can be ahead
+// of the server while uploads wait in the outbox. Returns shots changed;
+// those whose stats the server's copy replaced go to `replaced`.
+int ApplyServerShots(
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
+    ShotTable& serverShots,
+    const ShotNames& serverTypes,
+    std::vector<int>& replaced)
+{
+    int changed = 0;
+    for (auto& [num, stats] : serverShots) {
+        auto it = shotStats.find(num);
+        bool differs = it == shotStats.end() || stats.attempts > it->second.attempts;
+        auto type = serverTypes.find(num);
+        if (type != serverTypes.end() && shotTypes[num] != type->second) {
+            shotTypes[num] = type->second;
+            differs = true;
+        }
+        if (it == shotStats.end()) shotStats.emplace(num, std::move(stats));
+        else if (stats.attempts > it->second.attempts) {
+            it->second = std::move(stats);
+            replaced.push_back(num);
+        }
+        if (differs) changed++;
+    }
+    return changed;
+}
+
+} // namespace
+
 std::string Session::GenerateId()
 {
     auto now = std::chrono::system_clock::now();
@@ -18,67 +202,32 @@ std::string Session::GenerateId()
     return "session_" + std::to_string(timestamp);
 }
 
+std::string Session::GetDataFolder()
+{
+    char* appdata = getenv("APPDATA");
+    if (!appdata) return "";
+    return std::string(appdata) + "\\bakkesmod\\bakkesmod\\data\\rl_best_stats";
+}
+
 void Session::SaveToFile(
     std::shared_ptr<CVarManagerWrapper> cvarManager,
     const std::string& sessionId,
     bool sessionActive,
     std::chrono::system_clock::time_point sessionStartTime,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes)
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
+    const SessionTotals& totals,
+    const MetricsReport& metrics)
 {
-    json sessionData;
-    sessionData["sessionId"] = sessionId;
-    sessionData["status"] = sessionActive ? "active" : "completed";
-
-    auto startTime_t = std::chrono::system_clock::to_time_t(sessionStartTime);
-    char timeBuffer[100];
-    std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%dT%H:%M:%S",
-        std::localtime(&startTime_t));
-    sessionData["startTime"] = timeBuffer;
+    auto prettyCvar = cvarManager->getCvar("mechtrak_debug_pretty_json");
+    bool pretty = prettyCvar && prettyCvar.getBoolValue();
 
-    auto now = std::chrono::system_clock::now();
-    auto now_t = std::chrono::system_clock::to_time_t(now);
-    std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%dT%H:%M:%S",
-        std::localtime(&now_t));
-    sessionData["lastUpdated"] = timeBuffer;
-
-    auto duration = std::chrono::duration_cast<std::chrono::minutes>(
-        now - sessionStartTime).count();
-    sessionData["durationMinutes"] = duration;
-
-    int totalAttempts = 0, totalGoals = 0;
-    for (const auto& shot : shotStats) {
-        totalAttempts += shot.second.attempts;
-        totalGoals += shot.second.goals;
-    }
-    sessionData["totalAttempts"] = totalAttempts;
-    sessionData["totalGoals"] = totalGoals;
-    sessionData["totalAccuracy"] = totalAttempts > 0
-        ? (float)totalGoals / totalAttempts * 100.0f : 0.0f;
-
-    json shotsData;
-    for (const auto& shot : shotStats) {
-        int shotNum = shot.first;
-        const auto& stats = shot.second;
-        json shotData;
-        shotData["attempts"] = stats.attempts;
-        shotData["goals"] = stats.goals;
-        shotData["attemptHistory"] = stats.attemptHistory;
-        shotData["shotType"] = (shotTypes.find(shotNum) != shotTypes.end())
-            ? shotTypes[shotNum] : "Unknown";
-        shotData["accuracy"] = stats.attempts > 0
-            ? (float)stats.goals / stats.attempts * 100.0f : 0.0f;
-        shotsData[std::to_string(shotNum)] = shotData;
-    }
-
-    sessionData["shots"] = shotsData;
-    sessionData["totalShots"] = shotStats.size();
-
-    char* appdata = getenv("APPDATA");
-    if (!appdata) return;
+    // One buffer per saving thread, reused across saves
+    static thread_local std::string buffer;
+    SessionJson::Write(buffer, pretty, sessionId, sessionActive, sessionStartTime, shotStats, shotTypes, totals, metrics);
 
-    std::string folderPath = std::string(appdata) +
-        "\\bakkesmod\\bakkesmod\\data\\rl_best_stats";
+    std::string folderPath = GetDataFolder();
+    if (folderPath.empty()) return;
     std::string filepath = folderPath + "\\session_" + sessionId + ".json";
 
     try {
@@ -86,334 +235,264 @@ void Session::SaveToFile(
     }
     catch (...) {}
 
-    std::ofstream file(filepath);
+    std::ofstream file(filepath, std::ios::binary);
     if (file.is_open()) {
-        file << sessionData.dump(2);
+        file.write(buffer.data(), (std::streamsize)buffer.size());
         file.close();
+        if (sessionActive) WriteCurrent(folderPath, sessionId);
     }
 }
 
-void Session::Upload(
-    std::shared_ptr<CVarManagerWrapper> cvarManager,
-    std::shared_ptr<GameWrapper> gameWrapper,
+uint64_t Session::TableVersion()
+{
+    return tableVersion.load();
+}
+
+void Session::Publish(const std::string& sessionId, bool sessionActive)
+{
+    std::lock_guard<std::mutex> lock(liveMutex);
+    live.sessionId = sessionId;
+    live.active = sessionActive;
+}
+
+Session::Live Session::Published()
+{
+    std::lock_guard<std::mutex> lock(liveMutex);
+    return live;
+}
+
+std::string Session::CurrentId()
+{
+    std::string folderPath = GetDataFolder();
+    if (folderPath.empty()) return "";
+    std::string id;
+    std::ifstream current(folderPath + "\\" + CURRENT_FILE);
+    if (current.is_open()) std::getline(current, id);
+    return id;
+}
+
+bool Session::LoadSnapshot(
     std::string& sessionId,
     bool& sessionActive,
-    std::chrono::system_clock::time_point sessionStartTime,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes,
+    std::chrono::system_clock::time_point& sessionStartTime,
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
     int& currentShotNumber)
+{
+    std::string folderPath = GetDataFolder();
+    if (folderPath.empty()) return false;
+
+    std::string id = CurrentId();
+    if (id.empty()) return false;
+
+    SessionFileHandler snapshot;
+    if (!SessionJson::Read(folderPath + "\\session_" + id + ".json", snapshot)) return false;
+
+    // An ended session is not worth showing; wait for the server instead
+    if (snapshot.meta.status != "active" || snapshot.meta.sessionId != id) return false;
+
+    sessionId = id;
+    sessionActive = true;
+    std::tm tm = {};
+    std::istringstream startTime(snapshot.meta.startTime);
+    startTime >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+    if (!startTime.fail()) {
+        tm.tm_isdst = -1;
+        sessionStartTime = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+    }
+    // The live tables sit in the session arena, so the staged ones are
+    // moved in node by node rather than swapped
+    SessionArena::Reset(shotStats, shotTypes);
+    shotStats = std::move(snapshot.table.shots);
+    shotTypes = std::move(snapshot.table.types);
+    currentShotNumber = shotStats.empty() ? 1 : shotStats.begin()->first;
+    tableVersion++;
+
+    std::lock_guard<std::mutex> lock(currentMutex);
+    currentId = id;
+    return true;
+}
+
+void Session::Upload(
+    std::shared_ptr<CVarManagerWrapper> cvarManager,
+    const std::string& sessionId,
+    bool sessionActive,
+    std::chrono::system_clock::time_point sessionStartTime,
+    ShotTable shotStats,
+    ShotNames shotTypes,
+    std::function<void(UploadResult, ActiveSession)> done)
 {
     // Don't upload if no active session
     if (!sessionActive || sessionId.empty()) {
         cvarManager->log("No active session, skipping upload");
+        done(UploadResult::Skipped, ActiveSession());
         return;
     }
 
-    // Check if session is still active on server
-    HINTERNET hCheckSession = WinHttpOpen(L"RLStatsPlugin/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-
-    if (hCheckSession) {
-        HINTERNET hCheckConnect = WinHttpConnect(hCheckSession,
-            SERVER_HOST.c_str(), SERVER_PORT, 0);
-        if (hCheckConnect) {
-            HINTERNET hCheckRequest = WinHttpOpenRequest(hCheckConnect,
-                L"GET", L"/api/sessions/active", NULL, WINHTTP_NO_REFERER,
-                WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE);
-
-            if (hCheckRequest) {
-                // Add auth header
-                std::string pluginToken = GetPluginToken(cvarManager);
-                std::wstring checkHeaders = L"Content-Type: application/json\r\n";
-                if (!pluginToken.empty()) {
-                    std::wstring wtoken(pluginToken.begin(), pluginToken.end());
-                    checkHeaders += L"Authorization: Bearer " + wtoken + L"\r\n";
-                }
-                WinHttpAddRequestHeaders(hCheckRequest, checkHeaders.c_str(), -1, WINHTTP_ADDREQ_FLAG_ADD);
-
-                if (WinHttpSendRequest(hCheckRequest, WINHTTP_NO_ADDITIONAL_HEADERS,
-                    0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0)) {
-                    WinHttpReceiveResponse(hCheckRequest, NULL);
-
-                    DWORD dwSize = 0;
-                    std::string checkResponse;
-
-                    do {
-                        dwSize = 0;
-                        if (!WinHttpQueryDataAvailable(hCheckRequest, &dwSize)) break;
-                        if (dwSize == 0) break;
-
-                        char* buf = new char[dwSize + 1];
-                        ZeroMemory(buf, dwSize + 1);
-                        DWORD dwDownloaded = 0;
-                        if (WinHttpReadData(hCheckRequest, buf, dwSize, &dwDownloaded)) {
-                            checkResponse.append(buf, dwDownloaded);
-                        }
-                        delete[] buf;
-                    } while (dwSize > 0);
-
-                    try {
-                        auto checkJson = nlohmann::json::parse(checkResponse);
-                        if (checkJson["success"] == true && !checkJson["session"].is_null()) {
-                            std::string activeSessionId = checkJson["session"]["session_id"];
-                            if (activeSessionId != sessionId) {
-                                cvarManager->log("New session detected, switching...");
-                                sessionActive = false;
-                                SaveToFile(cvarManager, sessionId, sessionActive,
-                                    sessionStartTime, shotStats, shotTypes);
-
-                                WinHttpCloseHandle(hCheckRequest);
-                                WinHttpCloseHandle(hCheckConnect);
-                                WinHttpCloseHandle(hCheckSession);
-
-                                LoadActive(cvarManager, sessionId, sessionActive,
-                                    shotStats, shotTypes, currentShotNumber);
-                                return;
-                            }
-                        }
-                        else {
-                            // No active session on server - session was deleted
-                            cvarManager->log("Session deleted from dashboard, stopping uploads");
-                            sessionActive = false;
-                            sessionId = "";
-
-                            WinHttpCloseHandle(hCheckRequest);
-                            WinHttpCloseHandle(hCheckConnect);
-                            WinHttpCloseHandle(hCheckSession);
+    auto snapshot = std::make_shared<std::pair<ShotTable, ShotNames>>(std::move(shotStats), std::move(shotTypes));
+    CurrentToken(cvarManager, [cvarManager, sessionId, sessionStartTime, snapshot, done](std::string token) {
+        // Check if session is still active on server
+        HttpRequest request;
+        request.path = L"/api/sessions/active";
+        request.headers = JsonHeaders(token);
+        auto check = std::make_shared<JsonCall<ActiveSessionHandler>>(false);
+        FetchJson(std::move(request), check, [cvarManager, sessionId, sessionStartTime, snapshot, check, done](HttpResponse&& response) {
+            if (response.Answered()) {
+                if (check->parser.Finish()) {
+                    if (check->handler.success && check->handler.hasSession) {
+                        if (check->handler.sessionId != sessionId) {
+                            cvarManager->log("New session detected, switching...");
+                            SaveToFile(cvarManager, sessionId, false,
+                                sessionStartTime, snapshot->first, snapshot->second,
+                                SessionTotals::Of(snapshot->first), LiveMetrics::Of(snapshot->first));
+
+                            FetchActive(cvarManager, [done](ActiveSession next) {
+                                done(UploadResult::Switched, std::move(next));
+                                });
                             return;
                         }
                     }
-                    catch (...) {}
+                    else {
+                        // No active session on server - session was deleted
+                        cvarManager->log("Session deleted from dashboard, stopping uploads");
+                        done(UploadResult::Deleted, ActiveSession());
+                        return;
+                    }
                 }
-                WinHttpCloseHandle(hCheckRequest);
             }
-            WinHttpCloseHandle(hCheckConnect);
-        }
-        WinHttpCloseHandle(hCheckSession);
-    }
-
-    // Upload session file
-     
-
-    // Don't upload if no active session
-    if (!sessionActive || sessionId.empty()) {
-        cvarManager->log("No active session, skipping upload");
-        return;
-    }
-
-    char* appdata = getenv("APPDATA");
-    if (!appdata) return;
-
-    std::string folderPath = std::string(appdata) +
-        "\\bakkesmod\\bakkesmod\\data\\rl_best_stats";
-    std::string filepath = folderPath + "\\session_" + sessionId + ".json";
 
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        cvarManager->log("Error: Could not open session file");
-        return;
-    }
-
-    std::string jsonContent((std::istreambuf_iterator<char>(file)),
-        std::istreambuf_iterator<char>());
-    file.close();
-
-    HINTERNET hSession = WinHttpOpen(L"RL Stats Plugin/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hSession) return;
-
-    HINTERNET hConnect = WinHttpConnect(hSession, SERVER_HOST.c_str(), SERVER_PORT, 0);
-    if (!hConnect) { WinHttpCloseHandle(hSession); return; }
+            Enqueue(cvarManager, sessionId, [done]() { done(UploadResult::Sent, ActiveSession()); });
+            });
+        });
+}
 
-    HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"POST", L"/api/sessions",
-        NULL, WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
-        WINHTTP_FLAG_SECURE);
-    if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return;
+void Session::Enqueue(std::shared_ptr<CVarManagerWrapper> cvarManager, const std::string& sessionId,
+    std::function<void()> done)
+{
+    std::string folderPath = GetDataFolder();
+    if (!folderPath.empty()) {
+        std::string filepath = folderPath + "\\session_" + sessionId + ".json";
+
+        std::ifstream file(filepath);
+        if (file.is_open()) {
+            std::string jsonContent((std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+            file.close();
+
+            // Queue first so the snapshot survives an unreachable server or a
+            // game restart; the drain sends it (and anything older) right away
+            Outbox::Enqueue(sessionId, jsonContent);
+        }
+        else cvarManager->log("Error: Could not open session file");
     }
+    // Older entries still go out when this one could not be read
+    DrainOutbox(cvarManager, std::move(done));
+}
 
-    std::wstring headers = L"Content-Type: application/json\r\n";
-    WinHttpAddRequestHeaders(hRequest, headers.c_str(), -1, WINHTTP_ADDREQ_FLAG_ADD);
-
-    BOOL bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-        (LPVOID)jsonContent.c_str(), jsonContent.length(), jsonContent.length(), 0);
-
-    if (bResults) bResults = WinHttpReceiveResponse(hRequest, NULL);
-
-    if (bResults) {
-        DWORD dwStatusCode = 0;
-        DWORD dwSize = sizeof(dwStatusCode);
-        WinHttpQueryHeaders(hRequest,
-            WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
-            WINHTTP_HEADER_NAME_BY_INDEX, &dwStatusCode, &dwSize,
-            WINHTTP_NO_HEADER_INDEX);
-        cvarManager->log(dwStatusCode == 200
-            ? "Session uploaded successfully!"
-            : "Upload failed: " + std::to_string(dwStatusCode));
+void Session::DrainOutbox(std::shared_ptr<CVarManagerWrapper> cvarManager, std::function<void()> done)
+{
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        drainWaiters.push_back(std::move(done));
+        if (draining) return;
+        draining = true;
     }
-
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
+    // A task of its own, so done never runs inside this call
+    if (!Scheduler::After(std::chrono::milliseconds(0), [cvarManager]() { DrainStep(cvarManager, DRAIN_MAX); }))
+        EndDrain(cvarManager);
 }
 
-void Session::LoadActive(
-    std::shared_ptr<CVarManagerWrapper> cvarManager,
-    std::string& sessionId,
-    bool& sessionActive,
-    std::map<int, ShotStats>& shotStats,
-    std::map<int, std::string>& shotTypes,
-    int& currentShotNumber)
+void Session::FetchActive(std::shared_ptr<CVarManagerWrapper> cvarManager, std::function<void(ActiveSession)> done)
 {
     cvarManager->log("Loading active session...");
 
-    HINTERNET hSession = WinHttpOpen(L"RLStatsPlugin/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hSession) return;
-
-    HINTERNET hConnect = WinHttpConnect(hSession, SERVER_HOST.c_str(), SERVER_PORT, 0);
-    if (!hConnect) { WinHttpCloseHandle(hSession); return; }
-
-    HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"GET",
-        L"/api/sessions/active", NULL, WINHTTP_NO_REFERER,
-        WINHTTP_DEFAULT_ACCEPT_TYPES,
-        WINHTTP_FLAG_SECURE);
-    if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return;
-    }
-
     // Get token first
-    std::string pluginToken = GetPluginToken(cvarManager);
-    cvarManager->log("Plugin token length: " + std::to_string(pluginToken.length()));
-
-    // Add auth header if we have a token
-    std::wstring authHeaders = L"Content-Type: application/json\r\n";
-    if (!pluginToken.empty()) {
-        std::wstring wtoken(pluginToken.begin(), pluginToken.end());
-        authHeaders += L"Authorization: Bearer " + wtoken + L"\r\n";
-    }
-    WinHttpAddRequestHeaders(hRequest, authHeaders.c_str(), -1, WINHTTP_ADDREQ_FLAG_ADD);
-
-   
-    BOOL bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS,
-        0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0);
-    if (bResults) bResults = WinHttpReceiveResponse(hRequest, NULL);
-
-    if (bResults) {
-        DWORD dwSize = 0;
-        std::string responseData;
-
-        do {
-            dwSize = 0;
-            if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
-            if (dwSize == 0) break;
-
-            char* buf = new char[dwSize + 1];
-            ZeroMemory(buf, dwSize + 1);
-            DWORD dwDownloaded = 0;
-            if (WinHttpReadData(hRequest, (LPVOID)buf, dwSize, &dwDownloaded)) {
-                responseData.append(buf, dwDownloaded);
-            }
-            delete[] buf;
-        } while (dwSize > 0);
-
-        try {
-            auto response = nlohmann::json::parse(responseData);
-            if (response["success"] == true && !response["session"].is_null()) {
-                auto session = response["session"];
-                sessionId = session["session_id"];
-                sessionActive = true;
-
-                shotStats.clear();
-                shotTypes.clear();
-
-                for (auto& [shotNumStr, shotData] : session["shots_data"].items()) {
-                    int shotNum = std::stoi(shotNumStr);
-                    ShotStats stats;
-                    stats.attempts = shotData["attempts"];
-                    stats.goals = shotData["goals"];
-                    for (bool result : shotData["attemptHistory"]) {
-                        stats.attemptHistory.push_back(result);
-                    }
-                    shotStats[shotNum] = stats;
-                    shotTypes[shotNum] = shotData["shotType"];
+    CurrentToken(cvarManager, [cvarManager, done](std::string pluginToken) {
+        cvarManager->log("Plugin token length: " + std::to_string(pluginToken.length()));
+
+        HttpRequest request;
+        request.path = L"/api/sessions/active";
+        request.headers = JsonHeaders(pluginToken);
+        auto active = std::make_shared<JsonCall<ActiveSessionHandler>>(true);
+        FetchJson(std::move(request), active, [cvarManager, active, done](HttpResponse&& response) {
+            ActiveSession fetched;
+            if (response.Answered()) {
+                if (!active->parser.Finish()) {
+                    cvarManager->log("Error parsing session: " + active->parser.Error());
                 }
-
-                if (!shotStats.empty()) {
-                    currentShotNumber = shotStats.begin()->first;
+                else {
+                    fetched.answered = true;
+                    fetched.found = active->handler.success && active->handler.hasSession;
+                    fetched.sessionId = std::move(active->handler.sessionId);
+                    fetched.shots = std::move(active->handler.table.shots);
+                    fetched.types = std::move(active->handler.table.types);
                 }
-
-                cvarManager->log("Loaded " + std::to_string(shotStats.size()) + " shots");
-            }
-            else {
-                cvarManager->log("No active session found");
             }
-        }
-        catch (const std::exception& e) {
-            cvarManager->log("Error parsing session: " + std::string(e.what()));
-        }
-    }
-
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
+            done(std::move(fetched));
+            });
+        });
 }
 
-std::string Session::GetPluginToken(std::shared_ptr<CVarManagerWrapper> cvarManager)
+bool Session::ApplyActive(
+    std::shared_ptr<CVarManagerWrapper> cvarManager,
+    ActiveSession& fetched,
+    std::string& sessionId,
+    bool& sessionActive,
+    ShotTable& shotStats,
+    ShotNames& shotTypes,
+    int& currentShotNumber,
+    std::vector<int>& replaced)
 {
-    HINTERNET hSession = WinHttpOpen(L"RLStatsPlugin/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-    if (!hSession) return "";
-
-    HINTERNET hConnect = WinHttpConnect(hSession, SERVER_HOST.c_str(), SERVER_PORT, 0);
-    if (!hConnect) { WinHttpCloseHandle(hSession); return ""; }
-
-    HINTERNET hRequest = WinHttpOpenRequest(hConnect, L"GET",
-        L"/api/plugin/token", NULL, WINHTTP_NO_REFERER,
-        WINHTTP_DEFAULT_ACCEPT_TYPES, WINHTTP_FLAG_SECURE);
-    if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return "";
+    if (!fetched.answered) return false;
+
+    if (fetched.found && sessionActive && fetched.sessionId == sessionId && !shotStats.empty()) {
+        // Warm-started from the snapshot; only apply what the server changed
+        int changed = ApplyServerShots(shotStats, shotTypes, fetched.shots, fetched.types, replaced);
+        if (changed > 0) tableVersion++;
+        cvarManager->log("Reconciled with server, " + std::to_string(changed) + " shots updated");
+        return changed > 0;
+    }
+    if (!fetched.found) {
+        cvarManager->log("No active session found");
+        return false;
     }
 
-    BOOL bResults = WinHttpSendRequest(hRequest, WINHTTP_NO_ADDITIONAL_HEADERS,
-        0, WINHTTP_NO_REQUEST_DATA, 0, 0, 0);
-    if (bResults) bResults = WinHttpReceiveResponse(hRequest, NULL);
-
-    std::string token = "";
+    sessionId = fetched.sessionId;
+    sessionActive = true;
 
+    for (const auto& [num, stats] : shotStats) replaced.push_back(num);
+    SessionArena::Reset(shotStats, shotTypes);
+    shotStats = std::move(fetched.shots);
+    shotTypes = std::move(fetched.types);
+    tableVersion++;
 
-    if (bResults) {
-        DWORD dwSize = 0;
-        std::string responseData;
+    if (!shotStats.empty()) {
+        currentShotNumber = shotStats.begin()->first;
+    }
 
-        do {
-            dwSize = 0;
-            if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) break;
-            if (dwSize == 0) break;
+    cvarManager->log("Loaded " + std::to_string(shotStats.size()) + " shots");
+    return true;
+}
 
-            char* buf = new char[dwSize + 1];
-            ZeroMemory(buf, dwSize + 1);
-            DWORD dwDownloaded = 0;
-            if (WinHttpReadData(hRequest, (LPVOID)buf, dwSize, &dwDownloaded)) {
-                responseData.append(buf, dwDownloaded);
+void Session::GetPluginToken(std::shared_ptr<CVarManagerWrapper> cvarManager,
+    std::function<void(std::string)> done)
+{
+    HttpRequest request;
+    request.path = L"/api/plugin/token";
+    auto call = std::make_shared<JsonCall<TokenHandler>>();
+    FetchJson(std::move(request), call, [cvarManager, call, done](HttpResponse&& reply) {
+        TokenHandler& response = call->handler;
+        std::string token = "";
+
+        if (reply.Answered()) {
+            bool read = call->parser.Finish();
+            std::lock_guard<std::mutex> lock(tokenMutex);
+            tokenFetched = std::chrono::steady_clock::now();
+            if (!read) {
+                cachedToken = "";
             }
-            delete[] buf;
-        } while (dwSize > 0);
-
-        try {
-            auto response = nlohmann::json::parse(responseData);
-            if (response["success"] == true && !response["token"].is_null()) {
-                token = response["token"].get<std::string>();
+            else if (response.success && !response.token.empty()) {
+                token = response.token;
                 cachedToken = token; // Keep this to store latest
                 cvarManager->log("Token fetched, length: " + std::to_string(token.length()));
             }
@@ -422,14 +501,21 @@ std::string Session::GetPluginToken(std::shared_ptr<CVarManagerWrapper> cvarMana
                 cvarManager->log("No token available");
             }
         }
-        catch (...) {
-            cachedToken = "";
-        }
-    }
 
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
+        if (done) done(token);
+        });
+}
 
-    return token;
+void Session::CurrentToken(std::shared_ptr<CVarManagerWrapper> cvarManager,
+    std::function<void(std::string)> done)
+{
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex);
+        if (!cachedToken.empty() &&
+            std::chrono::steady_clock::now() - tokenFetched < TOKEN_REFRESH + std::chrono::minutes(5))
+            token = cachedToken;
+    }
+    if (!token.empty()) done(token);
+    else GetPluginToken(cvarManager, std::move(done));
 }
\ No newline at end of file
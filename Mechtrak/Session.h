@@ -2,44 +2,134 @@
 #include "bakkesmod/plugin/bakkesmodplugin.h"
 #include "json.hpp"
 #include "HUD.h"
+#include "SessionAggregates.h"
+#include "LiveMetrics.h"
 #include <map>
 #include <string>
 #include <chrono>
+#include <functional>
 
 using json = nlohmann::json;
 
 class Session {
 public:
     static std::string GenerateId();
-    static std::string GetPluginToken(std::shared_ptr<CVarManagerWrapper> cvarManager);
+    static std::string GetDataFolder();   // ...\rl_best_stats, "" if APPDATA unset
+    // Fetches a fresh token into cachedToken; done gets it, "" if none,
+    // on the Scheduler thread
+    static void GetPluginToken(std::shared_ptr<CVarManagerWrapper> cvarManager,
+        std::function<void(std::string token)> done = nullptr);
     static std::string cachedToken;
 
+    // The Scheduler refetches the token this often; requests reuse the
+    // cached one until it is a little older than that, and only fetch one
+    // (calling done later) when it is stale. Otherwise done runs at once.
+    static constexpr auto TOKEN_REFRESH = std::chrono::minutes(10);
+    static void CurrentToken(std::shared_ptr<CVarManagerWrapper> cvarManager,
+        std::function<void(std::string token)> done);
+
     static void SaveToFile(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
         const std::string& sessionId,
         bool sessionActive,
         std::chrono::system_clock::time_point sessionStartTime,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes
+        ShotTable& shotStats,
+        ShotNames& shotTypes,
+        const SessionTotals& totals,
+        const MetricsReport& metrics
     );
 
+    struct ActiveSession;
+
+    enum class UploadResult {
+        Sent,       // queued and the outbox drained
+        Skipped,    // no active session to send
+        Switched,   // the server moved to another session; see next
+        Deleted     // the session was deleted on the dashboard
+    };
+
+    // Runs on the SyncWorker with a snapshot of the session and never touches
+    // the live one; done gets the result on the Scheduler thread once the
+    // last request is answered. On Switched the snapshot has been saved as
+    // ended and next holds the new session for ApplyActive; the caller
+    // applies either change on the game thread.
     static void Upload(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
-        std::shared_ptr<GameWrapper> gameWrapper,
+        const std::string& sessionId,
+        bool sessionActive,
+        std::chrono::system_clock::time_point sessionStartTime,
+        ShotTable shotStats,
+        ShotNames shotTypes,
+        std::function<void(UploadResult result, ActiveSession next)> done
+    );
+
+    // Queues the saved file of sessionId for upload, without asking the
+    // server whether it is still the active session, and drains the outbox.
+    // The file is read before this returns.
+    static void Enqueue(std::shared_ptr<CVarManagerWrapper> cvarManager, const std::string& sessionId,
+        std::function<void()> done = nullptr);
+
+    // Sends queued uploads one request at a time; see Outbox for ordering
+    // and backoff. A call while a drain is under way joins it. done runs on
+    // the Scheduler thread once the drain stops, never before this returns.
+    static void DrainOutbox(std::shared_ptr<CVarManagerWrapper> cvarManager,
+        std::function<void()> done = nullptr);
+
+    // Bumped whenever LoadSnapshot or ApplyActive replaces or merges into the
+    // tables they were given, so caches over the live tables can rebuild
+    static uint64_t TableVersion();
+
+    // Id of the active session this machine last saved, "" if none
+    static std::string CurrentId();
+
+    // The live session's id and state as the game thread last published
+    // them, for threads that may not read the plugin's own members
+    struct Live {
+        std::string sessionId;
+        bool active = false;
+    };
+    static void Publish(const std::string& sessionId, bool sessionActive);
+    static Live Published();
+
+    // Restores the session this machine last saved, if it is still active,
+    // straight from rl_best_stats. No network; ApplyActive reconciles later.
+    static bool LoadSnapshot(
         std::string& sessionId,
         bool& sessionActive,
-        std::chrono::system_clock::time_point sessionStartTime,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes,
+        std::chrono::system_clock::time_point& sessionStartTime,
+        ShotTable& shotStats,
+        ShotNames& shotTypes,
         int& currentShotNumber
     );
 
-    static void LoadActive(
+    // The server's active session, parsed into heap tables off the game thread
+    struct ActiveSession {
+        bool answered = false;    // the server replied and the body parsed
+        bool found = false;       // it has an active session
+        std::string sessionId;
+        ShotTable shots;
+        ShotNames types;
+    };
+
+    // GET /api/sessions/active. Network and parsing only, so any thread may
+    // call it; done gets the result on the Scheduler thread, to be handed
+    // to ApplyActive on the game thread.
+    static void FetchActive(std::shared_ptr<CVarManagerWrapper> cvarManager,
+        std::function<void(ActiveSession fetched)> done);
+
+    // Game thread only: the live tables sit in the session arena. Reconciles
+    // with the session already loaded if it is the same one, otherwise moves
+    // the fetched tables in. Returns true if anything changed. Shots whose
+    // stats were replaced rather than kept go to `replaced`, so the caller
+    // can drop their undo history.
+    static bool ApplyActive(
         std::shared_ptr<CVarManagerWrapper> cvarManager,
+        ActiveSession& fetched,
         std::string& sessionId,
         bool& sessionActive,
-        std::map<int, ShotStats>& shotStats,
-        std::map<int, std::string>& shotTypes,
-        int& currentShotNumber
+        ShotTable& shotStats,
+        ShotNames& shotTypes,
+        int& currentShotNumber,
+        std::vector<int>& replaced
     );
 }; 
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "SessionAggregates.h"
+
+SessionTotals SessionTotals::Of(const ShotTable& shots)
+{
+    SessionTotals t;
+    Tally best;
+    for (const auto& [num, s] : shots) {
+        t.all.attempts += s.attempts;
+        t.all.goals += s.goals;
+        t.timing.Add(s.Timing());
+        if (s.attempts <= 0) continue;
+        // Same order as SessionAggregates::Rank; the map visits lower numbers first
+        int64_t l = (int64_t)s.goals * best.attempts, r = (int64_t)best.goals * s.attempts;
+        if (t.bestShot == 0 || l > r || (l == r && s.attempts > best.attempts)) {
+            t.bestShot = num;
+            best = { s.attempts, s.goals };
+        }
+    }
+    t.bestShotPct = best.Accuracy();
+    return t;
+}
+
+void SessionAggregates::Rebuild(const ShotTable& table,
+    const ShotNames& typeNames, uint64_t tableVersion)
+{
+    shots.clear();
+    types.clear();
+    ranked.clear();
+    totals = SessionTotals();
+    version = tableVersion;
+    for (const auto& [num, s] : table) Refresh(num, s, typeNames);
+}
+
+void SessionAggregates::Refresh(int shot, const ShotStats& stats, const ShotNames& typeNames)
+{
+    auto it = shots.find(shot);
+    Entry& e = it != shots.end() ? it->second : Add(shot, typeNames);
+    Tally before = e.tally;
+    if (before.attempts == stats.attempts && before.goals == stats.goals) return;
+
+    int dAttempts = stats.attempts - before.attempts;
+    int dGoals = stats.goals - before.goals;
+    e.tally = { stats.attempts, stats.goals };
+    e.type->attempts += dAttempts;
+    e.type->goals += dGoals;
+    totals.all.attempts += dAttempts;
+    totals.all.goals += dGoals;
+
+    if (before.attempts > 0) ranked.erase({ before.goals, before.attempts, shot });
+    if (stats.attempts > 0) ranked.insert({ stats.goals, stats.attempts, shot });
+    UpdateBest();
+    if (dAttempts != 0) UpdateTiming(e, stats, dAttempts);
+}
+
+const Tally& SessionAggregates::Shot(int shot) const
+{
+    static const Tally none;
+    auto it = shots.find(shot);
+    return it != shots.end() ? it->second.tally : none;
+}
+
+const TimingStats& SessionAggregates::ShotTiming(int shot) const
+{
+    static const TimingStats none;
+    auto it = shots.find(shot);
+    return it != shots.end() ? it->second.timing : none;
+}
+
+SessionAggregates::Entry& SessionAggregates::Add(int shot, const ShotNames& typeNames)
+{
+    auto name = typeNames.find(shot);
+    Entry& e = shots[shot];
+    e.type = &types[name != typeNames.end() && !name->second.empty() ? std::string(name->second) : "Unknown"];
+    return e;
+}
+
+void SessionAggregates::UpdateBest()
+{
+    if (ranked.empty()) {
+        totals.bestShot = 0;
+        totals.bestShotPct = 0.f;
+        return;
+    }
+    const Rank& best = *ranked.rbegin();
+    totals.bestShot = best.shot;
+    totals.bestShotPct = (float)best.goals / best.attempts;
+}
+
+void SessionAggregates::UpdateTiming(Entry& e, const ShotStats& stats, int dAttempts)
+{
+    // Sealing moves times without changing Timed(), and sealed blocks keep
+    // their figures, so a refold never reads the journal
+    size_t count = stats.Timed();
+    if (dAttempts == 1 && count == e.timedCount + 1) e.timing.Add(stats.Time(stats.Count() - 1));
+    else if (count != e.timedCount) e.timing = stats.Timing();
+    e.timedCount = count;
+
+    // A pack holds tens of shots, so refolding them is cheaper than keeping
+    // a removable min/max of the session's first start and last end
+    totals.timing = TimingStats();
+    for (const auto& [num, entry] : shots) totals.timing.Add(entry.timing);
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "ShotStats.h"
+#include <map>
+#include <set>
+#include <string>
+#include <cstdint>
+
+// Attempts and goals of one shot, one shot type or the whole session
+struct Tally {
+    int attempts = 0;
+    int goals = 0;
+
+    // 0..1, 0 with no attempts
+    float Accuracy() const { return attempts > 0 ? (float)goals / attempts : 0.f; }
+};
+
+// Session-wide figures a save writes next to the shots
+struct SessionTotals {
+    Tally all;
+    int   bestShot = 0;         // 0 while no shot has an attempt
+    float bestShotPct = 0.f;    // 0..1, what the HTML overlay shows
+    TimingStats timing;         // over every timed attempt of the session
+
+    // Full scan, for code holding a copy of the table but no aggregates
+    static SessionTotals Of(const ShotTable& shots);
+};
+
+// Running totals over the live shot table. Refresh() is called with the one
+// shot an event touched and moves every figure by that shot's difference, so
+// the cost of an attempt or edit does not grow with the session. Rebuild()
+// is for when the table is replaced as a whole: load, reset, end, or a
+// background merge (see Session::TableVersion). Game thread only.
+class SessionAggregates {
+public:
+    // version is Session::TableVersion() read before the table was scanned
+    void Rebuild(const ShotTable& shots, const ShotNames& types,
+        uint64_t version);
+    // After an event changed the counters of shot
+    void Refresh(int shot, const ShotStats& stats, const ShotNames& types);
+
+    uint64_t Version() const { return version; }
+
+    const SessionTotals& Totals() const { return totals; }
+    // Zero tally for a shot with no attempts or not in the table
+    const Tally& Shot(int shot) const;
+    const TimingStats& ShotTiming(int shot) const;
+    // By shot type name; shots without a type count as "Unknown"
+    const std::map<std::string, Tally>& Types() const { return types; }
+
+private:
+    struct Entry {
+        Tally  tally;
+        Tally* type = nullptr;     // points into `types`, which never drops keys
+        TimingStats timing;
+        size_t timedCount = 0;     // attempts in the shot's times when last read
+    };
+
+    // Orders shots by accuracy, compared exactly, then by attempts, then by
+    // lower shot number, so the best shot is always the last key
+    struct Rank {
+        int goals;
+        int attempts;
+        int shot;
+        bool operator<(const Rank& o) const
+        {
+            int64_t l = (int64_t)goals * o.attempts, r = (int64_t)o.goals * attempts;
+            if (l != r) return l < r;
+            if (attempts != o.attempts) return attempts < o.attempts;
+            return shot > o.shot;
+        }
+    };
+
+    Entry& Add(int shot, const ShotNames& types);
+    void UpdateBest();
+    // Extends e.timing by the attempt just added where it can, else rescans
+    void UpdateTiming(Entry& e, const ShotStats& stats, int dAttempts);
+
+    std::map<int, Entry>         shots;
+    std::map<std::string, Tally> types;
+    std::set<Rank>               ranked;   // shots with at least one attempt
+    SessionTotals                totals;
+    uint64_t                     version = 0;
+};
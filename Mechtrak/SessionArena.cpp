@@ -0,0 +1,67 @@
+#include "SessionArena.h"
+#include "ShotStats.h"
+#include <cassert>
+#include <new>
+
+void* SessionArena::Upstream::do_allocate(size_t bytes, size_t align)
+{
+    chunks++;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+}
+
+void SessionArena::Upstream::do_deallocate(void* p, size_t bytes, size_t align)
+{
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+}
+
+SessionArena::SessionArena()
+    : buffer(initial, sizeof(initial), &upstream)
+{
+}
+
+void SessionArena::CheckOwner()
+{
+    if (owner == std::thread::id()) owner = std::this_thread::get_id();
+    assert(owner == std::this_thread::get_id() && "session arena used off the game thread");
+}
+
+void* SessionArena::do_allocate(size_t bytes, size_t align)
+{
+    CheckOwner();
+    stats.allocations++;
+    stats.bytes += bytes;
+    stats.sessionBytes += bytes;
+    return buffer.allocate(bytes, align);
+}
+
+void SessionArena::Reset(ShotTable& shots, ShotNames& names)
+{
+    auto* arena = dynamic_cast<SessionArena*>(shots.get_allocator().resource());
+    if (arena) arena->CheckOwner();
+    // Deallocation is a no-op here, so clearing only runs the destructors
+    if (!arena || names.get_allocator().resource() != arena) {
+        shots.clear();
+        names.clear();
+        return;
+    }
+    // MSVC's map takes its head node (and, in debug builds, its iterator
+    // proxy) from the allocator when it is built, so releasing under a live
+    // map would hand that memory to the next insert. Both maps go first and
+    // are built again in place once the buffer is back to the inline part,
+    // which has room for them, so rebuilding cannot throw.
+    shots.~ShotTable();
+    names.~ShotNames();
+    // Back to the inline buffer; the chunks past it go to the heap
+    arena->buffer.release();
+    new (&shots) ShotTable(arena);
+    new (&names) ShotNames(arena);
+    arena->stats.sessionBytes = 0;
+    arena->stats.resets++;
+}
+
+SessionArena::Stats SessionArena::GetStats() const
+{
+    Stats s = stats;
+    s.chunks = upstream.chunks;
+    return s;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <memory_resource>
+#include <map>
+#include <string>
+#include <cstddef>
+#include <thread>
+
+struct ShotStats;
+
+// The live session's shot table and shot names. MechTrak allocates both from
+// its SessionArena; copies of them (the snapshots handed to the SyncWorker,
+// the reload handoff, tables being loaded) use the heap and can outlive the
+// session.
+using ShotTable = std::pmr::map<int, ShotStats>;
+using ShotNames = std::pmr::map<int, std::pmr::string>;
+
+// Per-session memory for the tables above. Their nodes and the names' text
+// come from a monotonic buffer that starts inside the arena itself, so a
+// usual pack never asks the heap for them and dropping one frees nothing;
+// the whole session goes back in one step when it ends (Reset). What a shot
+// owns itself, its hot history and sealed blocks, stays on the heap, since
+// the memory budget has to be able to give that back mid-session (see
+// AttemptSpill).
+//
+// The buffer has no lock: only the thread that first uses the arena (the
+// game thread) may insert into, reset or replace tables that draw from it.
+// Work on other threads parses into heap tables and posts the move-in to
+// the game thread (see Session::FetchActive / ApplyActive). Debug builds
+// assert this.
+class SessionArena : public std::pmr::memory_resource {
+public:
+    static constexpr size_t INITIAL = 16 * 1024;   // bytes held inline
+
+    struct Stats {
+        size_t allocations = 0;     // nodes handed out, all sessions
+        size_t bytes = 0;           // their size
+        size_t sessionBytes = 0;    // handed out since the last reset
+        size_t chunks = 0;          // heap blocks taken once INITIAL ran out
+        size_t resets = 0;
+    };
+
+    SessionArena();
+    SessionArena(const SessionArena&) = delete;
+    SessionArena& operator=(const SessionArena&) = delete;
+
+    // Empties shots and names and, if both come from the same arena,
+    // releases it; the two maps are then rebuilt on it in place, so
+    // references to them stay good but iterators do not. Only what the
+    // shots own on the heap is freed one by one.
+    // Owner thread only, like any other change to the tables.
+    static void Reset(ShotTable& shots, ShotNames& names);
+
+    Stats GetStats() const;
+
+private:
+    // Counts the blocks the buffer takes from the heap
+    struct Upstream : std::pmr::memory_resource {
+        size_t chunks = 0;
+        void* do_allocate(size_t bytes, size_t align) override;
+        void  do_deallocate(void* p, size_t bytes, size_t align) override;
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    };
+
+    // Binds the arena to the calling thread on first use, then checks it
+    void CheckOwner();
+
+    void* do_allocate(size_t bytes, size_t align) override;
+    void  do_deallocate(void*, size_t, size_t) override {}
+    bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    alignas(std::max_align_t) std::byte initial[INITIAL];
+    Upstream upstream;
+    std::pmr::monotonic_buffer_resource buffer;
+    Stats stats;
+    std::thread::id owner;
+};
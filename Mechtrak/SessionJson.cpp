@@ -0,0 +1,98 @@
+#include "SessionJson.h"
+#include "JsonWriter.h"
+#include <charconv>
+#include <ctime>
+#include <fstream>
+
+void SessionJson::Write(
+    std::string& out,
+    bool pretty,
+    const std::string& sessionId,
+    bool sessionActive,
+    std::chrono::system_clock::time_point sessionStartTime,
+    const ShotTable& shotStats,
+    const ShotNames& shotTypes,
+    const SessionTotals& totals,
+    const MetricsReport& metrics)
+{
+    auto now = std::chrono::system_clock::now();
+    char timeBuffer[32];
+
+    SessionMeta meta;
+    meta.sessionId = sessionId;
+    meta.status = sessionActive ? "active" : "completed";
+    auto startTime_t = std::chrono::system_clock::to_time_t(sessionStartTime);
+    std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&startTime_t));
+    meta.startTime = timeBuffer;
+    auto now_t = std::chrono::system_clock::to_time_t(now);
+    std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&now_t));
+    meta.lastUpdated = timeBuffer;
+    meta.durationMinutes = std::chrono::duration_cast<std::chrono::minutes>(now - sessionStartTime).count();
+    meta.totalAttempts = totals.all.attempts;
+    meta.totalGoals = totals.all.goals;
+    meta.bestShotPct = totals.bestShotPct;
+    meta.attemptsPerMinute = totals.timing.PerMinute();
+    meta.avgTouchSec = totals.timing.TouchSec();
+    meta.avgAttemptSec = totals.timing.AttemptSec();
+    meta.totalShots = (int64_t)shotStats.size();
+
+    out.clear();
+    JsonWriter w(out, pretty);
+    w.BeginObject();
+    codec::WriteFields(w, meta);
+    w.Key(wire::Metrics);
+    w.BeginObject();
+    codec::WriteFields(w, metrics.session);
+    w.EndObject();
+
+    w.Key(wire::Shots);
+    if (shotStats.empty()) {
+        w.Null();   // an empty json() dumped as null
+    }
+    else {
+        // Both maps are ordered by shot number, so walk them together
+        // instead of looking up each shot's type
+        w.BeginObject();
+        auto typeIt = shotTypes.begin();
+        for (const auto& [shotNum, stats] : shotStats) {
+            while (typeIt != shotTypes.end() && typeIt->first < shotNum) ++typeIt;
+            bool hasType = typeIt != shotTypes.end() && typeIt->first == shotNum;
+
+            char numBuf[16];
+            auto r = std::to_chars(numBuf, numBuf + sizeof(numBuf), shotNum);
+            w.Key(std::string_view(numBuf, r.ptr - numBuf));
+            w.BeginObject();
+            // Files always carry every attempt; sealed ones are read back
+            // into a copy (see AttemptSpill)
+            if (stats.sealed.Empty()) codec::WriteFields(w, stats);
+            else {
+                ShotStats whole = stats;
+                whole.Thaw();
+                codec::WriteFields(w, whole);
+            }
+            w.Key(wire::ShotType);
+            w.String(hasType ? typeIt->second : "Unknown");
+            auto rolling = metrics.shots.find(shotNum);
+            if (rolling != metrics.shots.end()) {
+                w.Key(wire::Metrics);
+                w.BeginObject();
+                codec::WriteFields(w, rolling->second);
+                w.EndObject();
+            }
+            w.EndObject();
+        }
+        w.EndObject();
+    }
+    w.EndObject();
+}
+
+bool SessionJson::Read(const std::string& path, SessionFileHandler& into)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    JsonStreamParser parser(into);
+    char buf[16384];
+    while (file.read(buf, sizeof(buf)) || file.gcount() > 0)
+        if (!parser.Feed(buf, (size_t)file.gcount())) return false;
+    return parser.Finish();
+}
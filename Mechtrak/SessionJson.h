@@ -0,0 +1,270 @@
+#pragma once
+#include "JsonReader.h"
+#include "SessionSchema.h"
+#include "SessionLog.h"
+#include "SessionAggregates.h"
+#include "LiveMetrics.h"
+#include <chrono>
+#include <string>
+#include <string_view>
+
+class SessionFileHandler;
+
+// The session JSON the plugin saves and the server sends: the writer for
+// session files and the handlers Session parses responses and snapshots
+// with. Kept free of BakkesMod so the tools/ programs can build it.
+class SessionJson {
+public:
+    // Writes the session file schema into out (cleared first). totals and
+    // metrics are written as given; they must describe shotStats.
+    static void Write(
+        std::string& out,
+        bool pretty,
+        const std::string& sessionId,
+        bool sessionActive,
+        std::chrono::system_clock::time_point sessionStartTime,
+        const ShotTable& shotStats,
+        const ShotNames& shotTypes,
+        const SessionTotals& totals,
+        const MetricsReport& metrics
+    );
+
+    // Streams the session file at path into `into`. False if it cannot be
+    // opened or is not valid JSON.
+    static bool Read(const std::string& path, SessionFileHandler& into);
+};
+
+// Shot table shared by saved session files ("shots") and the server's active
+// session ("shots_data"): { "<n>": { <ShotStats fields>, "shotType": str } }.
+// The owning handler forwards every event from the table's opening brace up to
+// and including its closing one.
+class ShotTableReader {
+public:
+    ShotTable shots;
+    ShotNames types;
+
+    void StartObject()
+    {
+        depth++;
+        if (depth == 2) {
+            cur = nullptr;
+            try { curShot = std::stoi(key); cur = &shots[curShot]; }
+            catch (...) {}
+        }
+    }
+
+    // True once the table itself has closed
+    bool EndObject() { return Leave(); }
+
+    void StartArray()
+    {
+        depth++;
+        if (depth == 3 && cur) reader.BeginArray(*cur);
+    }
+
+    void EndArray()
+    {
+        if (depth == 3) reader.EndArray();
+        Leave();
+    }
+
+    void Key(std::string_view k)
+    {
+        if (depth == 1) key.assign(k);
+        else if (depth == 2 && cur) {
+            isShotType = k == wire::ShotType;
+            reader.Key(k);
+        }
+    }
+
+    void Bool(bool v) { if (Value()) reader.Bool(*cur, v); }
+    void Int(int64_t v) { if (Value()) reader.Int(*cur, v); }
+    void Float(double v) { if (Value()) reader.Float(*cur, v); }
+
+    void String(std::string_view v)
+    {
+        if (depth == 2 && cur && isShotType) types[curShot].assign(v);
+    }
+
+private:
+    std::string key;
+    int depth = 0;
+    bool isShotType = false;
+    int curShot = 0;
+    ShotStats* cur = nullptr;
+    codec::FieldReader<ShotStats> reader;
+
+    // Scalars directly inside a shot object, or elements of its history array
+    bool Value() const { return cur && (depth == 2 || (depth == 3 && reader.InArray())); }
+
+    bool Leave()
+    {
+        if (depth == 2 && cur) {
+            SessionLog::Normalize(*cur);
+            cur = nullptr;
+        }
+        return --depth == 0;
+    }
+};
+
+// GET /api/sessions/active:
+// { "success": bool, "session": null | { "session_id": str, "shots_data": <shot table> } }
+// Shots are staged here and moved into the live tables once the whole
+// response has parsed, so a truncated body never clobbers current stats.
+class ActiveSessionHandler : public JsonHandler {
+public:
+    explicit ActiveSessionHandler(bool wantShots) : wantShots(wantShots) {}
+
+    bool success = false;
+    bool hasSession = false;
+    std::string sessionId;
+    ShotTableReader table;
+
+    bool StartObject() override
+    {
+        depth++;
+        if (inShots) table.StartObject();
+        else if (depth == 2 && key1 == wire::Session) { inSession = true; hasSession = true; }
+        else if (depth == 3 && inSession && key2 == wire::ShotsData && wantShots) {
+            inShots = true;
+            table.StartObject();
+        }
+        return true;
+    }
+
+    bool EndObject() override
+    {
+        if (inShots && table.EndObject()) inShots = false;
+        else if (depth == 2) inSession = false;
+        depth--;
+        return true;
+    }
+
+    bool StartArray() override
+    {
+        depth++;
+        if (inShots) table.StartArray();
+        return true;
+    }
+
+    bool EndArray() override
+    {
+        if (inShots) table.EndArray();
+        depth--;
+        return true;
+    }
+
+    bool Key(std::string_view k) override
+    {
+        if (inShots) table.Key(k);
+        else if (depth == 1) key1.assign(k);
+        else if (depth == 2) key2.assign(k);
+        return true;
+    }
+
+    bool Bool(bool v) override
+    {
+        if (inShots) table.Bool(v);
+        else if (depth == 1 && key1 == wire::Success) success = v;
+        return true;
+    }
+
+    bool Int(int64_t v) override { if (inShots) table.Int(v); return true; }
+    bool Float(double v) override { if (inShots) table.Float(v); return true; }
+
+    bool String(std::string_view v) override
+    {
+        if (inShots) table.String(v);
+        else if (depth == 2 && inSession && key2 == wire::ServerSessionId) sessionId.assign(v);
+        return true;
+    }
+
+    bool Null() override
+    {
+        if (!inShots && depth == 1 && key1 == wire::Session) hasSession = false;
+        return true;
+    }
+
+private:
+    const bool wantShots;
+    std::string key1, key2;
+    int depth = 0;
+    bool inSession = false;
+    bool inShots = false;
+};
+
+// Saved session file (SessionJson::Write): SessionMeta fields plus "shots"
+class SessionFileHandler : public JsonHandler {
+public:
+    SessionMeta meta;
+    ShotTableReader table;
+
+    bool StartObject() override
+    {
+        depth++;
+        if (inShots) table.StartObject();
+        else if (depth == 2 && key == wire::Shots) {
+            inShots = true;
+            table.StartObject();
+        }
+        return true;
+    }
+
+    bool EndObject() override
+    {
+        if (inShots && table.EndObject()) inShots = false;
+        depth--;
+        return true;
+    }
+
+    bool StartArray() override
+    {
+        depth++;
+        if (inShots) table.StartArray();
+        return true;
+    }
+
+    bool EndArray() override
+    {
+        if (inShots) table.EndArray();
+        depth--;
+        return true;
+    }
+
+    bool Key(std::string_view k) override
+    {
+        if (inShots) table.Key(k);
+        else if (depth == 1) { key.assign(k); metaReader.Key(k); }
+        return true;
+    }
+
+    bool Bool(bool v) override { if (inShots) table.Bool(v); else if (depth == 1) metaReader.Bool(meta, v); return true; }
+    bool Int(int64_t v) override { if (inShots) table.Int(v); else if (depth == 1) metaReader.Int(meta, v); return true; }
+    bool Float(double v) override { if (inShots) table.Float(v); else if (depth == 1) metaReader.Float(meta, v); return true; }
+    bool String(std::string_view v) override { if (inShots) table.String(v); else if (depth == 1) metaReader.String(meta, v); return true; }
+
+private:
+    std::string key;
+    int depth = 0;
+    bool inShots = false;
+    codec::FieldReader<SessionMeta> metaReader;
+};
+
+// GET /api/plugin/token: { "success": bool, "token": null | str }
+class TokenHandler : public JsonHandler {
+public:
+    bool success = false;
+    std::string token;
+
+    bool StartObject() override { depth++; return true; }
+    bool EndObject() override { depth--; return true; }
+    bool StartArray() override { depth++; return true; }
+    bool EndArray() override { depth--; return true; }
+    bool Key(std::string_view k) override { if (depth == 1) key.assign(k); return true; }
+    bool Bool(bool v) override { if (depth == 1 && key == wire::Success) success = v; return true; }
+    bool String(std::string_view v) override { if (depth == 1 && key == wire::Token) token.assign(v); return true; }
+
+private:
+    int depth = 0;
+    std::string key;
+};
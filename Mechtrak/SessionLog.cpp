@@ -0,0 +1,270 @@
+#include "SessionLog.h"
+#include "AttemptSpill.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// An event as the undo file holds it. The file is only ever read by the run
+// that wrote it, so the layout is whatever this build gives it.
+struct SpilledEvent {
+    uint8_t  kind;
+    uint8_t  goal;
+    int32_t  shot;
+    int32_t  index;
+    uint32_t start, touch, end;
+};
+
+bool Forward(ShotTable& shots, ShotEvent& e)
+{
+    if (e.kind == ShotEvent::Kind::Attempt) {
+        ShotStats& s = shots[e.shot];
+        s.attempts++;
+        if (e.goal) s.goals++;
+        s.attemptHistory.push_back(e.goal);
+        // A shot that was never timed stays empty rather than filling with zeros
+        if (!s.attemptTimes.empty() || e.time.start || e.time.touch || e.time.end)
+            timing::Push(s.attemptTimes, e.time);
+        return true;
+    }
+
+    auto it = shots.find(e.shot);
+    if (it == shots.end()) return false;
+    ShotStats& s = it->second;
+    auto& h = s.attemptHistory;
+
+    if (e.kind == ShotEvent::Kind::Flip) {
+        if (e.index < 0 || (size_t)e.index >= s.Count()) return false;
+        s.goals += s.Flip((size_t)e.index) ? -1 : 1;
+        return true;
+    }
+
+    // Remove
+    if (s.Count() == 0) return false;
+    s.Thaw(s.Count() - 1);
+    e.goal = h.back();
+    h.pop_back();
+    e.time = {};
+    if (!s.attemptTimes.empty()) {
+        e.time = timing::At(s.attemptTimes, timing::Count(s.attemptTimes) - 1);
+        s.attemptTimes.resize(s.attemptTimes.size() - timing::STRIDE);
+    }
+    s.attempts--;
+    if (e.goal) s.goals--;
+    return true;
+}
+
+bool Backward(ShotTable& shots, const ShotEvent& e)
+{
+    auto it = shots.find(e.shot);
+    if (it == shots.end()) return false;
+    ShotStats& s = it->second;
+    auto& h = s.attemptHistory;
+
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt:
+        if (s.Count() == 0) return false;
+        s.Thaw(s.Count() - 1);
+        if (h.back() != e.goal) return false;
+        h.pop_back();
+        s.attempts--;
+        if (e.goal) s.goals--;
+        if (!s.attemptTimes.empty()) s.attemptTimes.resize(s.attemptTimes.size() - timing::STRIDE);
+        return true;
+
+    case ShotEvent::Kind::Flip: {
+        if (e.index < 0 || (size_t)e.index >= s.Count()) return false;
+        s.goals += s.Flip((size_t)e.index) ? -1 : 1;
+        return true;
+    }
+
+    case ShotEvent::Kind::Remove:
+        h.push_back(e.goal);
+        s.attempts++;
+        if (e.goal) s.goals++;
+        if (!s.attemptTimes.empty() || e.time.start || e.time.touch || e.time.end)
+            timing::Push(s.attemptTimes, e.time);
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+SessionLog::~SessionLog()
+{
+    Clear();
+}
+
+void SessionLog::Bind(const std::string& sessionId)
+{
+    if (sessionId == boundId) return;
+    Clear();
+    boundId = sessionId;
+}
+
+void SessionLog::Clear()
+{
+    events.clear();
+    cursor = 0;
+    spilled = 0;
+    trimAt = 2 * DEPTH;
+    if (spillPath.empty()) return;
+    std::error_code ec;
+    std::filesystem::remove(spillPath, ec);
+    spillPath.clear();
+}
+
+bool SessionLog::Apply(ShotTable& shots, ShotEvent e)
+{
+    if (!Forward(shots, e)) return false;
+    events.resize(cursor);
+    events.push_back(e);
+    cursor++;
+    // Moved out a DEPTH at a time, so appends stay cheap; if the file
+    // won't take them, try again a DEPTH later
+    if (cursor >= trimAt)
+        trimAt = Spill(DEPTH) ? 2 * DEPTH : cursor + DEPTH;
+    return true;
+}
+
+void SessionLog::Drop(const std::vector<int>& shots)
+{
+    if (shots.empty()) return;
+    auto on = [&](int shot) { return std::find(shots.begin(), shots.end(), shot) != shots.end(); };
+    auto dropped = [&](const ShotEvent& e) { return on(e.shot); };
+
+    // Applied and undone events apart, so the cursor stays between them
+    auto applied = std::remove_if(events.begin(), events.begin() + (long)cursor, dropped);
+    auto undone = std::remove_if(events.begin() + (long)cursor, events.end(), dropped);
+    size_t kept = (size_t)(applied - events.begin());
+    events.erase(std::move(events.begin() + (long)cursor, undone, applied), events.end());
+    cursor = kept;
+
+    if (spilled == 0) return;
+    std::vector<SpilledEvent> all(spilled);
+    bool read;
+    {
+        std::ifstream file(spillPath, std::ios::binary);
+        file.read((char*)all.data(), (std::streamsize)(spilled * sizeof(SpilledEvent)));
+        read = (bool)file;
+    }
+    if (read) {
+        all.erase(std::remove_if(all.begin(), all.end(), [&](const SpilledEvent& r) { return on(r.shot); }), all.end());
+        std::ofstream file(spillPath, std::ios::binary | std::ios::trunc);
+        file.write((const char*)all.data(), (std::streamsize)(all.size() * sizeof(SpilledEvent)));
+        file.flush();
+        if (file) { spilled = all.size(); return; }
+    }
+    // Unreadable or unwritable, the older events go, as they would on undo
+    std::error_code ec;
+    std::filesystem::remove(spillPath, ec);
+    spilled = 0;
+}
+
+bool SessionLog::Spill(size_t count)
+{
+    if (spillPath.empty()) spillPath = AttemptSpill::UndoPath(boundId);
+    if (spillPath.empty()) return false;
+
+    std::vector<SpilledEvent> out(count);
+    for (size_t i = 0; i < count; i++) {
+        const ShotEvent& e = events[i];
+        out[i] = { (uint8_t)e.kind, (uint8_t)e.goal, e.shot, e.index, e.time.start, e.time.touch, e.time.end };
+    }
+    std::ofstream file(spillPath, std::ios::binary | std::ios::app);
+    file.write((const char*)out.data(), (std::streamsize)(count * sizeof(SpilledEvent)));
+    file.flush();
+    if (!file) {
+        // Cut off whatever half got written so the records stay aligned
+        file.close();
+        std::error_code ec;
+        std::filesystem::resize_file(spillPath, spilled * sizeof(SpilledEvent), ec);
+        return false;
+    }
+
+    events.erase(events.begin(), events.begin() + count);
+    cursor -= count;
+    spilled += count;
+    return true;
+}
+
+bool SessionLog::Unspill()
+{
+    size_t count = std::min(DEPTH, spilled);
+    std::vector<SpilledEvent> in(count);
+    {
+        std::ifstream file(spillPath, std::ios::binary);
+        file.seekg((std::streamoff)((spilled - count) * sizeof(SpilledEvent)));
+        file.read((char*)in.data(), (std::streamsize)(count * sizeof(SpilledEvent)));
+        if (!file) return false;
+    }
+    std::error_code ec;
+    std::filesystem::resize_file(spillPath, (spilled - count) * sizeof(SpilledEvent), ec);
+    if (ec) return false;
+
+    std::vector<ShotEvent> back(count);
+    for (size_t i = 0; i < count; i++) {
+        const SpilledEvent& r = in[i];
+        back[i] = { (ShotEvent::Kind)r.kind, r.shot, r.index, r.goal != 0, { r.start, r.touch, r.end } };
+    }
+    events.insert(events.begin(), back.begin(), back.end());
+    cursor += count;
+    spilled -= count;
+    return true;
+}
+
+const ShotEvent* SessionLog::Undo(ShotTable& shots)
+{
+    // Older events are only lost if their file can't be read back
+    if (cursor == 0 && spilled > 0 && !Unspill()) {
+        std::error_code ec;
+        std::filesystem::remove(spillPath, ec);
+        spilled = 0;
+    }
+    if (cursor == 0) return nullptr;
+    // Only fails if the table was replaced underneath the log
+    if (!Backward(shots, events[cursor - 1])) { Clear(); return nullptr; }
+    return &events[--cursor];
+}
+
+const ShotEvent* SessionLog::Redo(ShotTable& shots)
+{
+    if (cursor == events.size()) return nullptr;
+    if (!Forward(shots, events[cursor])) { Clear(); return nullptr; }
+    return &events[cursor++];
+}
+
+std::string SessionLog::Describe(const ShotEvent& e)
+{
+    std::string shot = "shot " + std::to_string(e.shot);
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt: return std::string(e.goal ? "goal" : "miss") + " on " + shot;
+    case ShotEvent::Kind::Flip:    return "flip of attempt " + std::to_string(e.index + 1) + " on " + shot;
+    case ShotEvent::Kind::Remove:  return "removal of the last attempt on " + shot;
+    }
+    return shot;
+}
+
+void SessionLog::Normalize(ShotStats& s)
+{
+    s.Thaw();
+    s.attempts = std::max(0, s.attempts);
+    s.goals = std::clamp(s.goals, 0, s.attempts);
+
+    auto& h = s.attemptHistory;
+    size_t want = (size_t)s.attempts;
+    if (h.size() > want) h.erase(h.begin(), h.begin() + (h.size() - want));
+    else if (h.size() < want) h.insert(h.begin(), want - h.size(), false);
+
+    int inHistory = (int)std::count(h.begin(), h.end(), true);
+    for (size_t i = 0; i < h.size() && inHistory != s.goals; i++) {
+        if (inHistory < s.goals && !h[i]) { h[i] = true; inHistory++; }
+        else if (inHistory > s.goals && h[i]) { h[i] = false; inHistory--; }
+    }
+
+    auto& t = s.attemptTimes;
+    size_t keep = std::min(timing::Count(t), want) * timing::STRIDE;
+    if (t.size() > keep) t.erase(t.begin(), t.begin() + (t.size() - keep));
+}
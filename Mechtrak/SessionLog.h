@@ -0,0 +1,91 @@
+#pragma once
+#include "ShotStats.h"
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// One change to the shot table. Each kind has an O(1) inverse, so undo and
+// redo are a cursor move plus a single update.
+struct ShotEvent {
+    enum class Kind : uint8_t {
+        Attempt,   // appends an attempt that ended as `goal`
+        Flip,      // turns attempt `index` from goal to miss or back
+        Remove     // drops the last attempt (`goal` and `time` record what it was)
+    };
+
+    Kind kind = Kind::Attempt;
+    int  shot = 0;
+    int  index = 0;
+    bool goal = false;
+    AttemptTime time;
+
+    static ShotEvent Attempt(int shot, bool goal, AttemptTime time = {}) { return { Kind::Attempt, shot, 0, goal, time }; }
+    static ShotEvent Flip(int shot, int index) { return { Kind::Flip, shot, index, false, {} }; }
+    static ShotEvent Remove(int shot) { return { Kind::Remove, shot, 0, false, {} }; }
+};
+
+// Append-only log of the changes made to the live shot table. Counters are
+// only ever moved together with attemptHistory, one event at a time, so
+// attempts == Count() and goals == goals in history after every Apply, Undo
+// and Redo. attemptTimes moves along with the history and never covers more
+// attempts than it has. Indices count sealed attempts too, and a flip of one
+// rewrites its block (see AttemptSpill). Undo/Redo move a cursor over the
+// log; applying a new event drops whatever had been undone. The newest
+// DEPTH to 2 * DEPTH events stay in memory; older ones move to a file next
+// to the spill journals a DEPTH at a time and are read back as undo reaches
+// them, so undo goes back to the start of the session. If that file can't be
+// written they stay in memory instead. Game thread only.
+class SessionLog {
+public:
+    static constexpr size_t DEPTH = 1000;
+
+    SessionLog() = default;
+    SessionLog(const SessionLog&) = delete;
+    SessionLog& operator=(const SessionLog&) = delete;
+    ~SessionLog();
+
+    // Starts a fresh log when the table now belongs to another session
+    void Bind(const std::string& sessionId);
+    void Clear();
+
+    // Applies and appends e; false, with nothing logged, if it does not fit
+    // the table (a Flip past the end, a Remove from an empty shot)
+    bool Apply(ShotTable& shots, ShotEvent e);
+    // Forgets every event on these shots, the undo file's included, for
+    // when their stats were replaced underneath the log (see
+    // Session::ApplyActive). Events on other shots undo and redo as before.
+    void Drop(const std::vector<int>& shots);
+    // The event undone or redone, nullptr if there is none
+    const ShotEvent* Undo(ShotTable& shots);
+    const ShotEvent* Redo(ShotTable& shots);
+
+    size_t Undoable() const { return spilled + cursor; }
+    size_t Redoable() const { return events.size() - cursor; }
+    // Applied events still in memory, oldest first; the redo tail is not
+    // included
+    const ShotEvent* begin() const { return events.data(); }
+    const ShotEvent* end() const { return events.data() + cursor; }
+
+    static std::string Describe(const ShotEvent& e);
+
+    // Brings a loaded shot in line with the invariant. Counters win, since
+    // they are what the dashboard shows: history keeps its most recent
+    // attempts, older unknown ones count as misses, and outcomes are
+    // corrected from the oldest end. Times keep their most recent attempts.
+    static void Normalize(ShotStats& s);
+
+private:
+    // Moves the oldest `count` events to the file; false, with nothing
+    // moved, if it can't take them
+    bool Spill(size_t count);
+    // Reads the newest DEPTH spilled events back in front of events
+    bool Unspill();
+
+    std::vector<ShotEvent> events;
+    size_t cursor = 0;
+    std::string boundId;
+    std::string spillPath;      // set on the first spill
+    size_t spilled = 0;         // events in the file, all older than events[0]
+    size_t trimAt = 2 * DEPTH;  // cursor that triggers the next spill
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "Codec.h"
+#include "ShotStats.h"
+#include "LiveMetrics.h"
+#include <string>
+#include <string_view>
+#include <tuple>
+
+// Wire shape of the session types. Every JSON key the plugin reads or writes
+// for a session is spelled here and nowhere else.
+
+// Session-level fields of a saved / uploaded session file
+struct SessionMeta {
+    std::string sessionId;
+    std::string status;
+    std::string startTime;
+    std::string lastUpdated;
+    int64_t     durationMinutes = 0;
+    int         totalAttempts = 0;
+    int         totalGoals = 0;
+    int64_t     totalShots = 0;
+    float       bestShotPct = 0.f;  // 0..1, best accuracy of any shot
+    // Over the attempts that have times; 0 when none do
+    float       attemptsPerMinute = 0.f;
+    float       avgTouchSec = 0.f;      // round start -> first touch
+    float       avgAttemptSec = 0.f;    // round start -> goal or reset
+
+    static float TotalAccuracy(const SessionMeta& m)
+    {
+        return m.totalAttempts > 0 ? (float)m.totalGoals / m.totalAttempts * 100.0f : 0.0f;
+    }
+};
+
+namespace wire {
+    // Per-shot key that lives in the shotTypes table rather than ShotStats
+    inline constexpr std::string_view ShotType = "shotType";
+    inline constexpr std::string_view Shots = "shots";
+    // RollingStats of the session, and of each shot next to its counters
+    inline constexpr std::string_view Metrics = "metrics";
+
+    // Server envelopes (/api/sessions/active, /api/plugin/token)
+    inline constexpr std::string_view Success = "success";
+    inline constexpr std::string_view Session = "session";
+    inline constexpr std::string_view ServerSessionId = "session_id";
+    inline constexpr std::string_view ShotsData = "shots_data";
+    inline constexpr std::string_view Token = "token";
+
+    inline float ShotAccuracy(const ShotStats& s)
+    {
+        return s.attempts > 0 ? (float)s.goals / s.attempts * 100.0f : 0.0f;
+    }
+}
+
+template<>
+struct codec::Schema<ShotStats> {
+    static constexpr auto fields = std::make_tuple(
+        Member<ShotStats, int>{ "attempts", &ShotStats::attempts },
+        Member<ShotStats, int>{ "goals", &ShotStats::goals },
+        Member<ShotStats, std::vector<bool>>{ "attemptHistory", &ShotStats::attemptHistory },
+        Member<ShotStats, std::vector<uint32_t>>{ "attemptTimes", &ShotStats::attemptTimes },
+        Computed<ShotStats, float>{ "accuracy", &wire::ShotAccuracy }
+    );
+};
+
+template<>
+struct codec::Schema<RollingStats> {
+    static constexpr auto fields = std::make_tuple(
+        Member<RollingStats, float>{ "last10", &RollingStats::last10 },
+        Member<RollingStats, float>{ "last25", &RollingStats::last25 },
+        Member<RollingStats, float>{ "last50", &RollingStats::last50 },
+        Member<RollingStats, int>{ "streak", &RollingStats::streak },
+        Member<RollingStats, int>{ "bestStreak", &RollingStats::bestStreak },
+        Member<RollingStats, float>{ "ewma", &RollingStats::ewma },
+        Member<RollingStats, float>{ "wilsonLow", &RollingStats::wilsonLow },
+        Member<RollingStats, float>{ "wilsonHigh", &RollingStats::wilsonHigh },
+        Member<RollingStats, bool>{ "dropped", &RollingStats::dropped },
+        Member<RollingStats, float>{ "dropFrom", &RollingStats::dropFrom },
+        Member<RollingStats, float>{ "dropTo", &RollingStats::dropTo },
+        Member<RollingStats, int>{ "dropLength", &RollingStats::dropLength }
+    );
+};
+
+template<>
+struct codec::Schema<SessionMeta> {
+    static constexpr auto fields = std::make_tuple(
+        Member<SessionMeta, std::string>{ "sessionId", &SessionMeta::sessionId },
+        Member<SessionMeta, std::string>{ "status", &SessionMeta::status },
+        Member<SessionMeta, std::string>{ "startTime", &SessionMeta::startTime },
+        Member<SessionMeta, std::string>{ "lastUpdated", &SessionMeta::lastUpdated },
+        Member<SessionMeta, int64_t>{ "durationMinutes", &SessionMeta::durationMinutes },
+        Member<SessionMeta, int>{ "totalAttempts", &SessionMeta::totalAttempts },
+        Member<SessionMeta, int>{ "totalGoals", &SessionMeta::totalGoals },
+        Member<SessionMeta, int64_t>{ "totalShots", &SessionMeta::totalShots },
+        Member<SessionMeta, float>{ "bestShotPct", &SessionMeta::bestShotPct },
+        Member<SessionMeta, float>{ "attemptsPerMinute", &SessionMeta::attemptsPerMinute },
+        Member<SessionMeta, float>{ "avgTouchSec", &SessionMeta::avgTouchSec },
+        Member<SessionMeta, float>{ "avgAttemptSec", &SessionMeta::avgAttemptSec },
+        Computed<SessionMeta, float>{ "totalAccuracy", &SessionMeta::TotalAccuracy }
+    );
+};
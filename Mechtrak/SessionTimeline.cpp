@@ -0,0 +1,202 @@
+#include "SessionTimeline.h"
+#include <algorithm>
+
+void SessionTimeline::Clear()
+{
+    marks.clear();
+    live.clear();
+    removed.clear();
+    view = View();
+}
+
+void SessionTimeline::Rebuild(const ShotTable& shots)
+{
+    Clear();
+    // Only the run of timed attempts at the end of each shot, so that lanes
+    // still line up with MarkOf's untimed-first counting
+    struct Timed { uint32_t ms; int shot; bool goal; };
+    std::vector<Timed> all;
+    for (const auto& [num, s] : shots) {
+        size_t n = s.Count(), first = n;
+        while (first > 0 && s.Time(first - 1).end != 0) first--;
+        for (size_t i = first; i < n; i++) all.push_back({ s.Time(i).end, num, s.Outcome(i) });
+    }
+    // Stable, so a shot's attempts keep their order on equal times
+    std::stable_sort(all.begin(), all.end(), [](const Timed& a, const Timed& b) { return a.ms < b.ms; });
+    marks.reserve(all.size());
+    for (const Timed& t : all) {
+        marks.push_back({ t.ms, t.shot, t.goal, true });
+        live[t.shot].push_back((uint32_t)(marks.size() - 1));
+    }
+    if (marks.size() >= MAX_MARKS) Compact();
+}
+
+void SessionTimeline::Apply(const ShotEvent& e, uint32_t ms, const ShotTable& shots)
+{
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt:
+        if (e.time.end != 0) ms = e.time.end;
+        // Keep the array sorted if the clock steps back
+        ms = std::max(ms, LastMs());
+        marks.push_back({ ms, e.shot, e.goal, true });
+        live[e.shot].push_back((uint32_t)(marks.size() - 1));
+        if (marks.size() >= MAX_MARKS) Compact();
+        break;
+    case ShotEvent::Kind::Flip: {
+        int32_t m = MarkOf(e.shot, e.index, shots);
+        if (m >= 0) marks[m].goal = !marks[m].goal;
+        break;
+    }
+    case ShotEvent::Kind::Remove: {
+        auto it = live.find(e.shot);
+        if (it == live.end() || it->second.empty()) break;
+        removed[e.shot].push_back(it->second.back());
+        Kill(e.shot);
+        break;
+    }
+    }
+}
+
+void SessionTimeline::Revert(const ShotEvent& e, const ShotTable& shots)
+{
+    switch (e.kind) {
+    case ShotEvent::Kind::Attempt:
+        Kill(e.shot);
+        break;
+    case ShotEvent::Kind::Flip: {
+        int32_t m = MarkOf(e.shot, e.index, shots);
+        if (m >= 0) marks[m].goal = !marks[m].goal;
+        break;
+    }
+    case ShotEvent::Kind::Remove: {
+        // Undo is last in, first out, so the mark taken is the newest live one again
+        auto it = removed.find(e.shot);
+        if (it == removed.end() || it->second.empty()) break;
+        uint32_t m = it->second.back();
+        it->second.pop_back();
+        // Its mark was dropped to make room; a new one keeps MarkOf in line
+        if (m == GONE) { Apply(ShotEvent::Attempt(e.shot, e.goal, e.time), LastMs(), shots); break; }
+        marks[m].alive = true;
+        live[e.shot].push_back(m);
+        break;
+    }
+    }
+}
+
+void SessionTimeline::Kill(int shot)
+{
+    auto it = live.find(shot);
+    if (it == live.end() || it->second.empty()) return;
+    marks[it->second.back()].alive = false;
+    it->second.pop_back();
+}
+
+void SessionTimeline::Compact()
+{
+    std::vector<bool> keep(marks.size(), false);
+    for (const auto& [shot, list] : live)
+        for (uint32_t m : list) keep[m] = true;
+    for (const auto& [shot, list] : removed)
+        for (uint32_t m : list) if (m != GONE) keep[m] = true;
+    // Newest first, up to half the room
+    size_t kept = 0;
+    for (size_t m = marks.size(); m-- > 0;)
+        if (keep[m]) keep[m] = kept++ < MAX_MARKS / 2;
+
+    std::vector<uint32_t> to(marks.size(), GONE);
+    std::vector<Mark> next;
+    next.reserve(std::min(kept, MAX_MARKS / 2));
+    for (size_t m = 0; m < marks.size(); m++) {
+        if (!keep[m]) continue;
+        to[m] = (uint32_t)next.size();
+        next.push_back(marks[m]);
+    }
+    marks.swap(next);
+
+    // A shot's live marks are oldest first, so the ones dropped are at the
+    // front, as MarkOf expects of untimed attempts
+    for (auto& [shot, list] : live) {
+        list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t m) { return to[m] == GONE; }), list.end());
+        for (uint32_t& m : list) m = to[m];
+    }
+    for (auto& [shot, list] : removed)
+        for (uint32_t& m : list) if (m != GONE) m = to[m];
+}
+
+int32_t SessionTimeline::MarkOf(int shot, int index, const ShotTable& shots) const
+{
+    auto l = live.find(shot);
+    auto s = shots.find(shot);
+    if (l == live.end() || s == shots.end()) return -1;
+    // The untimed attempts come first
+    int64_t i = (int64_t)index - ((int64_t)s->second.Count() - (int64_t)l->second.size());
+    return i >= 0 && i < (int64_t)l->second.size() ? (int32_t)l->second[(size_t)i] : -1;
+}
+
+const SessionTimeline::Mark* SessionTimeline::At(uint32_t ms) const
+{
+    return std::lower_bound(marks.data(), end(), ms,
+        [](const Mark& m, uint32_t t) { return m.ms < t; });
+}
+
+void SessionTimeline::Zoom(float factor, uint32_t around, uint32_t total)
+{
+    total = std::max(total, MIN_SPAN);
+    double span = std::clamp((double)view.span * factor, (double)MIN_SPAN, (double)total);
+    // Keep `around` under the cursor
+    double rel = view.span > 0 ? ((double)around - view.start) / view.span : 0.5;
+    double start = std::clamp((double)around - rel * span, 0.0, (double)total - span);
+    view.start = (uint32_t)start;
+    view.span = (uint32_t)span;
+    view.follow = view.span >= total;
+}
+
+void SessionTimeline::Pan(int64_t delta, uint32_t total)
+{
+    total = std::max(total, MIN_SPAN);
+    int64_t start = std::clamp<int64_t>((int64_t)view.start + delta, 0, (int64_t)total - view.span);
+    view.start = (uint32_t)std::max<int64_t>(start, 0);
+    view.follow = false;
+}
+
+void SessionTimeline::Draw(ImDrawList* dl, ImVec2 p0, ImVec2 p1, const ShotTable& shots) const
+{
+    const int LANES = std::max((int)shots.size(), 1);
+    const float W = p1.x - p0.x;
+    const float LANE_H = (p1.y - p0.y) / LANES;
+    const float TICK_H = std::max(LANE_H - 2.f, 1.f);
+
+    // lane and colours per shot, in table order
+    std::map<int, int> lane;
+    std::vector<ImU32> goalCol, missCol;
+    for (const auto& [num, s] : shots) {
+        float hue = (float)lane.size() * 0.618034f;
+        hue -= (float)(int)hue;
+        goalCol.push_back(ImColor::HSV(hue, 0.6f, 0.95f));
+        missCol.push_back(ImColor::HSV(hue, 0.6f, 0.45f, 0.7f));
+        lane.emplace(num, (int)lane.size());
+    }
+
+    // last pixel column drawn in each lane, and whether it was a goal
+    std::vector<int>  lastPx(LANES, -1);
+    std::vector<bool> lastGoal(LANES, false);
+
+    const uint32_t from = view.start, to = view.start + view.span;
+    const float pxPerMs = W / (float)std::max<uint32_t>(view.span, 1);
+    for (const Mark* m = At(from), *last = At(to); m != last; ++m) {
+        if (!m->alive) continue;
+        auto l = lane.find(m->shot);
+        if (l == lane.end()) continue;
+        int k = l->second;
+        int px = (int)((m->ms - from) * pxPerMs);
+        if (px == lastPx[k] && (lastGoal[k] || !m->goal)) continue;
+        lastPx[k] = px;
+        lastGoal[k] = m->goal;
+
+        ImU32 col = m->goal ? goalCol[k] : missCol[k];
+        float x = p0.x + px, y = p0.y + k * LANE_H + 1.f;
+        // misses are half height, goals full
+        float top = m->goal ? y : y + TICK_H * 0.5f;
+        dl->AddRectFilled({ x, top }, { x + 2.f, y + TICK_H }, col);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "ShotStats.h"
+#include "SessionLog.h"
+#include "IMGUI/imgui.h"
+#include <map>
+#include <vector>
+#include <cstdint>
+
+// Every attempt of the session on a time axis, for the timeline panel.
+//
+// Marks are appended in time order as attempts are recorded, so the marks
+// inside any time range are found with two binary searches and drawing
+// touches only what is on screen. A replaced table (a load or a reset) is
+// laid out again from its attempt times; attempts without times are left
+// out. Fed the same events as LiveMetrics; game thread only.
+//
+// At most MAX_MARKS marks are held. When they fill up, the dead ones a
+// removal can no longer bring back go, and if live ones still fill more than
+// half, the oldest of them: the panel then starts later in the session, and
+// their attempts count as untimed.
+class SessionTimeline {
+public:
+    struct Mark {
+        uint32_t ms;        // since session start
+        int      shot;
+        bool     goal;
+        bool     alive;     // false once removed or undone
+    };
+
+    // Visible range of the panel. While `follow` is set it tracks the whole
+    // session; zooming or panning clears it.
+    struct View {
+        uint32_t start = 0;
+        uint32_t span = 60000;
+        bool     follow = true;
+    };
+    View view;
+
+    static constexpr uint32_t MIN_SPAN = 10000;     // most zoomed in, ms
+    static constexpr size_t   MAX_MARKS = 1 << 15;
+
+    void Clear();
+    // Marks for every timed attempt of shots, placed at their end times
+    void Rebuild(const ShotTable& shots);
+    // After the SessionLog applied (or redid) e, ms after session start if e
+    // has no end time of its own
+    void Apply(const ShotEvent& e, uint32_t ms, const ShotTable& shots);
+    // After the SessionLog undid e
+    void Revert(const ShotEvent& e, const ShotTable& shots);
+
+    // First mark at or after ms, so [At(from), At(to)) is a time range.
+    // Dead marks are included.
+    const Mark* At(uint32_t ms) const;
+    const Mark* end() const { return marks.data() + marks.size(); }
+
+    uint32_t LastMs() const { return marks.empty() ? 0 : marks.back().ms; }
+    size_t   Size() const { return marks.size(); }
+
+    // Zooms by `factor` (< 1 is in) around ms, or pans by delta ms, within
+    // [0, total]
+    void Zoom(float factor, uint32_t around, uint32_t total);
+    void Pan(int64_t delta, uint32_t total);
+
+    // Marks in [view.start, view.start + view.span) as ticks in [p0, p1],
+    // one lane per shot of `shots` in order; a lane gets at most one tick
+    // per pixel column, a goal winning over a miss
+    void Draw(ImDrawList* dl, ImVec2 p0, ImVec2 p1, const ShotTable& shots) const;
+
+private:
+    // Index of the live mark behind attempt `index` of a shot, or -1
+    int32_t MarkOf(int shot, int index, const ShotTable& shots) const;
+    void Kill(int shot);
+    // Makes room once MAX_MARKS are held (see above)
+    void Compact();
+
+    static constexpr uint32_t GONE = UINT32_MAX;    // a removed mark Compact() dropped
+
+    std::vector<Mark> marks;
+    std::map<int, std::vector<uint32_t>> live;      // shot -> its live marks, oldest first
+    std::map<int, std::vector<uint32_t>> removed;   // shot -> marks a Remove took, for undo, or GONE
+};
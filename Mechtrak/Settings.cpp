@@ -15,6 +15,8 @@ void Settings::CreateFile(std::shared_ptr<CVarManagerWrapper> cvarManager)
     }
     settingsFile << "MECH TRAK|Settings\n";
     settingsFile << "1|Hide HUD|mechtrak_hide_hud\n";
+    settingsFile << "1|Hide Trend Graph|mechtrak_remove_graph\n";
+    settingsFile << "1|Show Shot Grid With Edit Panel|mechtrak_show_grid\n";
     settingsFile << "4|HUD X Position|mechtrak_hud_x|0|1\n";
     settingsFile << "4|HUD Y Position|mechtrak_hud_y|0|1\n";
     settingsFile << "12|Edit Panel Key (default F4)|mechtrak_key_edit_panel\n";
@@ -29,13 +31,27 @@ void Settings::RegisterCvars(std::shared_ptr<CVarManagerWrapper> cvarManager)
         true, true, 0, true, 1);
     cvarManager->registerCvar("mechtrak_compact_hud", "1", "Use compact HUD in top right",
         true, true, 0, true, 1);
-    cvarManager->registerCvar("mechtrak_remove_graph", "0", "Remove the bar graph",
+    cvarManager->registerCvar("mechtrak_remove_graph", "0", "Hide the HUD trend graph",
+        true, true, 0, true, 1);
+    cvarManager->registerCvar("mechtrak_show_grid", "1", "Show the pack grid under the HUD while the edit panel is open",
         true, true, 0, true, 1);
     cvarManager->registerCvar("mechtrak_hud_x", "-1", "HUD X position (0-1, -1 = top right)",
         true, true, -1.f, true, 1.f);
     cvarManager->registerCvar("mechtrak_hud_y", "0.02", "HUD Y position (0-1)",
         true, true, 0.f, true, 1.f);
 
+    cvarManager->registerCvar("mechtrak_debug_pretty_json", "0", "Indent saved session files (debug)",
+        true, true, 0, true, 1);
+
+    cvarManager->registerCvar("mechtrak_sync_max_staleness", "8", "Longest an attempt waits to be batched into an upload (seconds, 0 = upload every attempt)",
+        true, true, 0.f, true, 60.f);
+
+    cvarManager->registerCvar("mechtrak_shutdown_timeout", "2", "Seconds unload waits for the last upload before cancelling it",
+        true, true, 0.f, true, 10.f);
+
+    cvarManager->registerCvar("mechtrak_memory_cap_kb", "256", "Attempt history kept in memory before the oldest is moved to disk (KB)",
+        true, true, 16, true, 65536);
+
     cvarManager->registerCvar("mechtrak_key_edit_panel", "F4", "Key to toggle the edit panel");
     cvarManager->registerCvar("mechtrak_key_flip_last", "F7", "Key to flip last attempt goal/miss");
 
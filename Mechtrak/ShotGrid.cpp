@@ -0,0 +1,121 @@
+#include "pch.h"
+#include "ShotGrid.h"
+#include "SessionAggregates.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace {
+
+// Red at 0%, amber at 50%, green at 100%
+ImU32 Heat(float acc)
+{
+    auto mix = [](int a, int b, float t) { return (int)(a + (b - a) * t); };
+    if (acc < 0.5f) {
+        float t = acc * 2.f;
+        return IM_COL32(mix(190, 220, t), mix(50, 150, t), mix(45, 40, t), 235);
+    }
+    float t = (acc - 0.5f) * 2.f;
+    return IM_COL32(mix(220, 50, t), mix(150, 200, t), mix(40, 100, t), 235);
+}
+
+// Keeps the batch addressable with 16-bit indices
+constexpr int MAX_VERTICES = 0xFFFF - 256;
+
+} // namespace
+
+ImVec2 ShotGrid::Size(int shots)
+{
+    int rows = (std::max(shots, 1) + COLUMNS - 1) / COLUMNS;
+    return { COLUMNS * TILE + (COLUMNS - 1) * GAP, rows * TILE + (rows - 1) * GAP };
+}
+
+int ShotGrid::HitTest(ImVec2 p) const
+{
+    const float PITCH = TILE + GAP;
+    if (p.x < 0.f || p.y < 0.f) return 0;
+    int col = (int)(p.x / PITCH), row = (int)(p.y / PITCH);
+    if (col >= COLUMNS) return 0;
+    if (p.x - col * PITCH >= TILE || p.y - row * PITCH >= TILE) return 0;
+    size_t i = (size_t)row * COLUMNS + col;
+    return i < shots.size() ? shots[i] : 0;
+}
+
+bool ShotGrid::TileOf(int shot, ImVec2& out) const
+{
+    auto it = std::find(shots.begin(), shots.end(), shot);
+    if (it == shots.end()) return false;
+    int i = (int)(it - shots.begin());
+    out = { (i % COLUMNS) * (TILE + GAP), (i / COLUMNS) * (TILE + GAP) };
+    return true;
+}
+
+void ShotGrid::Draw(ImDrawList* dl, ImVec2 origin,
+    const ShotTable& shotStats, const SessionAggregates& aggregates)
+{
+    if (dirty || shots.size() != shotStats.size() || fontSize != ImGui::GetFontSize())
+        Build(shotStats, aggregates);
+    if (vtx.empty()) return;
+
+    dl->PrimReserve((int)idx.size(), (int)vtx.size());
+    const ImDrawIdx base = (ImDrawIdx)dl->_VtxCurrentIdx;
+    ImDrawVert* v = dl->_VtxWritePtr;
+    for (const ImDrawVert& src : vtx) {
+        v->pos = { src.pos.x + origin.x, src.pos.y + origin.y };
+        v->uv = src.uv;
+        v->col = src.col;
+        v++;
+    }
+    ImDrawIdx* ix = dl->_IdxWritePtr;
+    for (ImDrawIdx i : idx) *ix++ = (ImDrawIdx)(base + i);
+    dl->_VtxWritePtr = v;
+    dl->_IdxWritePtr = ix;
+    dl->_VtxCurrentIdx += (unsigned int)vtx.size();
+}
+
+void ShotGrid::Build(const ShotTable& shotStats, const SessionAggregates& aggregates)
+{
+    dirty = false;
+    fontSize = ImGui::GetFontSize();
+    shots.clear();
+    vtx.clear();
+    idx.clear();
+
+    // Drawn with the usual ImDrawList calls into a private list, then kept
+    // in grid-local space, which can run past the bottom of the screen
+    ImDrawList scratch(ImGui::GetDrawListSharedData());
+    ImVec2 size = Size((int)shotStats.size());
+    scratch.PushClipRect({ 0.f, 0.f }, { size.x, size.y });
+    scratch.PushTextureID(ImGui::GetIO().Fonts->TexID);
+    ImFont* fnt = ImGui::GetFont();
+    const float FS = fontSize;
+
+    const float PITCH = TILE + GAP;
+    int i = 0;
+    for (const auto& [shotNum, s] : shotStats) {
+        shots.push_back(shotNum);
+        ImVec2 p0 = { (i % COLUMNS) * PITCH, (i / COLUMNS) * PITCH };
+        ImVec2 p1 = { p0.x + TILE, p0.y + TILE };
+        i++;
+
+        const Tally& t = aggregates.Shot(shotNum);
+        scratch.AddRectFilled(p0, p1, t.attempts > 0 ? Heat(t.Accuracy()) : IM_COL32(255, 255, 255, 18));
+        // Past the index limit the remaining tiles still hit-test, unlabeled
+        if (scratch.VtxBuffer.Size > MAX_VERTICES) continue;
+
+        std::string num = std::to_string(shotNum);
+        ImVec2 nSz = fnt->CalcTextSizeA(FS * 0.85f, FLT_MAX, 0, num.c_str());
+        scratch.AddText(fnt, FS * 0.85f, { p0.x + (TILE - nSz.x) * 0.5f, p0.y + 3.f }, IM_COL32(255, 255, 255, 235), num.c_str());
+
+        if (t.attempts > 0) {
+            std::string n = HUD::FmtNum(t.attempts);
+            ImVec2 bSz = fnt->CalcTextSizeA(FS * 0.6f, FLT_MAX, 0, n.c_str());
+            ImVec2 b0 = { p1.x - bSz.x - 4.f, p1.y - bSz.y - 2.f };
+            scratch.AddRectFilled(b0, p1, IM_COL32(0, 0, 0, 120));
+            scratch.AddText(fnt, FS * 0.6f, { b0.x + 2.f, b0.y + 1.f }, IM_COL32(255, 255, 255, 200), n.c_str());
+        }
+    }
+
+    vtx.assign(scratch.VtxBuffer.begin(), scratch.VtxBuffer.end());
+    idx.assign(scratch.IdxBuffer.begin(), scratch.IdxBuffer.end());
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "HUD.h"
+#include "imgui/imgui.h"
+#include <map>
+#include <vector>
+
+class SessionAggregates;
+
+// The pack at a glance: one tile per shot, coloured by accuracy, with the
+// shot number and a badge for the attempts behind that colour.
+//
+// Tiles are built once into a vertex/index batch in grid-local coordinates;
+// each frame copies it into the window's draw list at an offset, so drawing
+// costs the same handful of copies per vertex with no per-tile ImGui calls.
+// The batch is rebuilt after Invalidate(), when shots are added or when the
+// font changes. Hover and clicks map to a tile by dividing by the pitch.
+// Game thread only.
+class ShotGrid {
+public:
+    static constexpr int   COLUMNS = 7;
+    static constexpr float TILE = 33.f;
+    static constexpr float GAP = 3.f;
+
+    // The shot table changed
+    void Invalidate() { dirty = true; }
+
+    // Width and height of a grid of `shots` tiles
+    static ImVec2 Size(int shots);
+
+    // Appends the grid at origin, rebuilding the batch first if it is stale
+    void Draw(ImDrawList* dl, ImVec2 origin,
+        const ShotTable& shotStats, const SessionAggregates& aggregates);
+
+    // Shot whose tile contains p (grid-local), or 0 for a gap or past the end
+    int HitTest(ImVec2 p) const;
+    // Top-left of a shot's tile, grid-local; false if it has none
+    bool TileOf(int shot, ImVec2& out) const;
+
+private:
+    void Build(const ShotTable& shotStats, const SessionAggregates& aggregates);
+
+    bool  dirty = true;
+    float fontSize = 0.f;
+    std::vector<int>        shots;     // tile index -> shot number
+    std::vector<ImDrawVert> vtx;
+    std::vector<ImDrawIdx>  idx;       // relative to the first vertex
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include "AttemptTiming.h"
+#include "AttemptSpill.h"
+#include "SessionArena.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// One shot's record in the session. Kept out of HUD.h so the session code
+// that only works on the table builds without the SDK, as tools/ does.
+struct ShotStats {
+    int attempts = 0;
+    int goals = 0;
+    // The newest attempts. Older ones move to `sealed` once the session
+    // outgrows its memory budget; see AttemptSpill.
+    std::vector<bool> attemptHistory;
+    // Start, first touch and end of the most recent of those, in ms since
+    // the session started; see AttemptTiming.h
+    std::vector<uint32_t> attemptTimes;
+    SealedAttempts sealed;
+
+    // Attempts in the history, sealed ones included
+    size_t Count() const { return sealed.Size() + attemptHistory.size(); }
+
+    // Outcome of attempt i < Count()
+    bool Outcome(size_t i) const
+    {
+        return i < sealed.Size() ? sealed.Outcome(i) : attemptHistory[i - sealed.Size()];
+    }
+
+    // Times of attempt i, zeros if it was not timed
+    AttemptTime Time(size_t i) const
+    {
+        if (i < sealed.Size()) return sealed.Time(i);
+        i -= sealed.Size();
+        size_t untimed = attemptHistory.size() - std::min(attemptHistory.size(), timing::Count(attemptTimes));
+        return i >= untimed && i < attemptHistory.size() ? timing::At(attemptTimes, i - untimed) : AttemptTime{};
+    }
+
+    size_t Timed() const { return sealed.Timed() + timing::Count(attemptTimes); }
+    TimingStats Timing() const
+    {
+        TimingStats t = sealed.Timing();
+        t.Add(TimingStats::Of(attemptTimes));
+        return t;
+    }
+
+    // Turns attempt i < Count() from goal to miss or back and returns what
+    // it was. A sealed one is rewritten in place, or brought back hot if
+    // its journal cannot be written.
+    bool Flip(size_t i)
+    {
+        bool wasGoal = Outcome(i);
+        if (i < sealed.Size() && sealed.Flip(i)) return wasGoal;
+        Thaw(i);
+        attemptHistory[i - sealed.Size()].flip();
+        return wasGoal;
+    }
+
+    // Brings attempts [from, Count()) back into the hot vectors
+    void Thaw(size_t from = 0)
+    {
+        if (from < sealed.Size()) sealed.Unseal(from, attemptHistory, attemptTimes);
+    }
+};
@@ -0,0 +1,305 @@
+#include "SyncWorker.h"
+#include "Scheduler.h"
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using ms = std::chrono::milliseconds;
+
+constexpr ms     RATE_WINDOW = std::chrono::minutes(10);
+constexpr double EWMA_ALPHA = 0.3;
+// Hold a batch open this many average attempt gaps after the latest attempt
+constexpr double WINDOW_GAPS = 2.0;
+
+std::mutex              mtx;
+bool                    busy = false;      // a job or the idle task has not called done yet
+std::vector<SyncWorker::Done> waiters;     // Flush callers, released once idle
+
+SyncWorker::Job    pending;
+uint64_t           pendingCount = 0;
+Clock::time_point  oldestChange{};
+Clock::time_point  deadline{};
+bool               editPending = false;   // deadline must not move later
+Scheduler::TimerId flushTimer = 0;
+
+Clock::time_point lastAttempt{};
+double            avgGapMs = 0.0;
+ms                maxStaleness{ 8000 };
+
+SyncWorker::IdleTask idleTask;
+ms                   idleInterval{ 0 };
+Scheduler::TimerId   idleTimer = 0;
+
+SyncWorker::Stats       stats;
+const Clock::time_point started = Clock::now();
+Clock::time_point       lastRequest{};
+std::deque<Clock::time_point> recentRequests;
+
+void RunPending();
+void RunIdle();
+
+ms Until(Clock::time_point t)
+{
+    return std::max(ms(0), std::chrono::duration_cast<ms>(t - Clock::now()));
+}
+
+// Caller holds mtx
+void ScheduleLocked(SyncWorker::Trigger trigger, Clock::time_point now)
+{
+    if (trigger == SyncWorker::Trigger::Edit) editPending = true;
+    if (trigger == SyncWorker::Trigger::Edit || maxStaleness.count() == 0) {
+        deadline = now;
+        return;
+    }
+
+    // An attempt after an unsent edit still updates the rate estimate below,
+    // but the edit's deadline stands
+    const Clock::time_point held = deadline;
+
+    bool first = lastAttempt == Clock::time_point{};
+    double gapMs = first ? 0.0 : std::chrono::duration<double, std::milli>(now - lastAttempt).count();
+    lastAttempt = now;
+
+    // Quiet before this attempt: nothing to batch with, send now
+    if (first || gapMs >= (double)maxStaleness.count()) {
+        avgGapMs = 0.0;
+        deadline = now;
+        return;
+    }
+
+    avgGapMs = avgGapMs == 0.0 ? gapMs : EWMA_ALPHA * gapMs + (1.0 - EWMA_ALPHA) * avgGapMs;
+    auto hold = ms((int64_t)(avgGapMs * WINDOW_GAPS));
+    deadline = std::min(now + hold, oldestChange + maxStaleness);
+    if (editPending) deadline = std::min(deadline, held);
+}
+
+// Caller holds mtx; takes ownership of the pending job
+SyncWorker::Job TakeLocked(uint64_t& count, Clock::time_point& oldest)
+{
+    SyncWorker::Job job = std::move(pending);
+    pending = nullptr;
+    count = pendingCount;
+    oldest = oldestChange;
+    pendingCount = 0;
+    editPending = false;
+    busy = true;
+    return job;
+}
+
+// Caller holds mtx
+void RecordLocked(uint64_t count, Clock::time_point oldest)
+{
+    auto now = Clock::now();
+    if (lastRequest != Clock::time_point{})
+        stats.requestGap.Record(std::chrono::duration_cast<ms>(now - lastRequest));
+    stats.staleness.Record(std::chrono::duration_cast<ms>(now - oldest));
+    stats.requests++;
+    stats.submitted += count;
+    lastRequest = now;
+
+    recentRequests.push_back(now);
+    while (!recentRequests.empty() && now - recentRequests.front() > RATE_WINDOW)
+        recentRequests.pop_front();
+}
+
+void Run(SyncWorker::Job& job, uint64_t count, Clock::time_point oldest);
+
+// Caller holds lock, which is released. While Flush callers wait, starts
+// the pending job, or releases them once there is none.
+void ContinueLocked(std::unique_lock<std::mutex>& lock)
+{
+    if (busy || waiters.empty()) return;
+    if (pending) {
+        uint64_t count;
+        Clock::time_point oldest;
+        SyncWorker::Job job = TakeLocked(count, oldest);
+        lock.unlock();
+        Run(job, count, oldest);
+        return;
+    }
+    std::vector<SyncWorker::Done> ready;
+    ready.swap(waiters);
+    lock.unlock();
+    for (auto& done : ready)
+        if (done) done();
+}
+
+void Run(SyncWorker::Job& job, uint64_t count, Clock::time_point oldest)
+{
+    // A job that calls done twice must not end the next one
+    auto called = std::make_shared<std::atomic<bool>>(false);
+    job([count, oldest, called]() {
+        if (called->exchange(true)) return;
+        std::unique_lock<std::mutex> lock(mtx);
+        RecordLocked(count, oldest);
+        busy = false;
+        ContinueLocked(lock);
+    });
+}
+
+// Scheduler task armed for the pending job's deadline
+void RunPending()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    flushTimer = 0;
+    if (!pending) return;
+    if (busy) {
+        // A job or the idle task is still waiting on the server; look again shortly
+        flushTimer = Scheduler::After(ms(100), RunPending);
+        return;
+    }
+    uint64_t count;
+    Clock::time_point oldest;
+    SyncWorker::Job job = TakeLocked(count, oldest);
+    lock.unlock();
+    Run(job, count, oldest);
+}
+
+void RunIdle()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    idleTimer = 0;
+    if (!idleTask) return;
+    if (busy) {
+        idleTimer = Scheduler::After(ms(1000), RunIdle);
+        return;
+    }
+    SyncWorker::IdleTask task = idleTask;
+    busy = true;
+    lock.unlock();
+    auto called = std::make_shared<std::atomic<bool>>(false);
+    task([called](ms next) {
+        if (called->exchange(true)) return;
+        std::unique_lock<std::mutex> lock(mtx);
+        busy = false;
+        stats.idleRuns++;
+        if (idleTask) {
+            idleInterval = std::max(ms(1000), next);
+            idleTimer = Scheduler::Reset(idleTimer, idleInterval, RunIdle);
+        }
+        ContinueLocked(lock);
+    });
+}
+
+} // namespace
+
+// ── Histogram ────────────────────────────────────────────────────────────────
+
+void SyncHistogram::Record(std::chrono::milliseconds value)
+{
+    int b = 0;
+    for (int64_t bound = 250; b < BUCKETS - 1 && value.count() >= bound; bound *= 2) b++;
+    counts[b]++;
+    total++;
+}
+
+std::chrono::milliseconds SyncHistogram::Percentile(double p) const
+{
+    if (total == 0) return ms(0);
+    uint64_t target = (uint64_t)((p / 100.0) * (double)total + 0.5);
+    if (target == 0) target = 1;
+    uint64_t seen = 0;
+    int64_t bound = 250;
+    for (int b = 0; b < BUCKETS; b++, bound *= 2) {
+        seen += counts[b];
+        if (seen >= target) return ms(bound);
+    }
+    return ms(bound);
+}
+
+std::string SyncHistogram::Format() const
+{
+    static const char* labels[BUCKETS] = {
+        "<0.25s", "<0.5s", "<1s", "<2s", "<4s", "<8s", "<16s", "<32s", "<64s", "64s+"
+    };
+    std::string out;
+    for (int b = 0; b < BUCKETS; b++) {
+        if (counts[b] == 0) continue;
+        if (!out.empty()) out += "  ";
+        out += std::string(labels[b]) + ":" + std::to_string(counts[b]);
+    }
+    return out.empty() ? "(none)" : out;
+}
+
+// ── Sync ─────────────────────────────────────────────────────────────────────
+
+void SyncWorker::Stop(Done done)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        idleTask = nullptr;
+        Scheduler::Cancel(idleTimer);
+        Scheduler::Cancel(flushTimer);
+        idleTimer = flushTimer = 0;
+    }
+    Flush(std::move(done));
+}
+
+void SyncWorker::Submit(Job job, Trigger trigger)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    auto now = Clock::now();
+    if (!pending) oldestChange = now;
+    pending = std::move(job);
+    pendingCount++;
+    ScheduleLocked(trigger, now);
+    flushTimer = Scheduler::Reset(flushTimer, Until(deadline), RunPending);
+}
+
+void SyncWorker::Flush(Done done)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    Scheduler::Cancel(flushTimer);
+    flushTimer = 0;
+    waiters.push_back(std::move(done));
+    ContinueLocked(lock);
+}
+
+void SyncWorker::SetIdleTask(IdleTask task, std::chrono::milliseconds firstDelay)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    idleTask = std::move(task);
+    idleInterval = firstDelay;
+    idleTimer = Scheduler::Reset(idleTimer, firstDelay, RunIdle);
+}
+
+void SyncWorker::NoteContact()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (idleTask) idleTimer = Scheduler::Reset(idleTimer, idleInterval, RunIdle);
+}
+
+void SyncWorker::WakeIdle()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if (idleTask) idleTimer = Scheduler::Reset(idleTimer, ms(0), RunIdle);
+}
+
+void SyncWorker::SetMaxStaleness(std::chrono::milliseconds bound)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    maxStaleness = std::max(ms(0), bound);
+    if (pending) {
+        deadline = std::min(deadline, oldestChange + maxStaleness);
+        flushTimer = Scheduler::Reset(flushTimer, Until(deadline), RunPending);
+    }
+}
+
+SyncWorker::Stats SyncWorker::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Stats s = stats;
+    auto now = Clock::now();
+    s.uptimeHours = std::chrono::duration<double, std::ratio<3600>>(now - started).count();
+    size_t n = 0;
+    for (auto t : recentRequests)
+        if (now - t <= RATE_WINDOW) n++;
+    s.requestsPerMinute = n / std::chrono::duration<double, std::ratio<60>>(RATE_WINDOW).count();
+    return s;
+}
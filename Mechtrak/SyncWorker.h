@@ -0,0 +1,74 @@
+#pragma once
+#include <string>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <array>
+
+// Fixed log2 buckets in milliseconds: <250, <500, <1s, <2s ... <64s, 64s+
+struct SyncHistogram {
+    static constexpr int BUCKETS = 10;
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+
+    void Record(std::chrono::milliseconds value);
+    // Upper bound of the bucket holding the p-th percentile (0-100)
+    std::chrono::milliseconds Percentile(double p) const;
+    std::string Format() const;
+};
+
+// Saves and uploads the session on the Scheduler thread. Callers submit a job
+// holding a snapshot of the session; a newer job replaces the pending one, so
+// a burst of attempts becomes one request. The window adapts to the attempt
+// rate: the first attempt after a quiet spell goes out at once, rapid-fire
+// attempts are held until the stream pauses or the oldest unsent attempt
+// reaches the staleness bound.
+//
+// Jobs and the idle task start their requests and return; each calls its
+// done once the last response is in, and nothing else starts until then.
+// The scheduler thread is free to run timers while the requests are out.
+class SyncWorker {
+public:
+    using Done = std::function<void()>;
+    using Job = std::function<void(Done done)>;
+    // Calls next with how long to wait before running it again
+    using IdleTask = std::function<void(std::function<void(std::chrono::milliseconds)> next)>;
+
+    enum class Trigger {
+        Attempt,   // batched by the adaptive window
+        Edit       // user correction: sent as soon as nothing else is running
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t submitted = 0;            // jobs folded into those requests
+        uint64_t idleRuns = 0;
+        double   uptimeHours = 0.0;
+        double   requestsPerMinute = 0.0;  // over the last 10 minutes
+        SyncHistogram requestGap;          // time between consecutive requests
+        SyncHistogram staleness;           // oldest change -> its upload finished
+    };
+
+    // Cancels the idle task and flushes; done runs as Flush's does
+    static void Stop(Done done);
+
+    static void Submit(Job job, Trigger trigger);
+
+    // Starts the pending job on the calling thread, or once the one in
+    // flight finishes, and calls done when nothing is pending or running.
+    // Used before state the job depends on is torn down.
+    static void Flush(Done done);
+
+    // Runs task on the scheduler once nothing has reached the server for the
+    // delay its previous run returned (firstDelay initially)
+    static void SetIdleTask(IdleTask task, std::chrono::milliseconds firstDelay);
+    // The server just heard from us; pushes the idle task back a full interval
+    static void NoteContact();
+    // Runs the idle task as soon as possible
+    static void WakeIdle();
+
+    // Bound on how long an attempt may wait for its upload; 0 disables batching
+    static void SetMaxStaleness(std::chrono::milliseconds bound);
+
+    static Stats GetStats();
+};
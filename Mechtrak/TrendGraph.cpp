@@ -0,0 +1,157 @@
+#include "TrendGraph.h"
+#include "HistoryKernels.h"
+#include <algorithm>
+#include <cmath>
+
+void TrendGraph::Rebuild(const ShotTable& shots)
+{
+    curves.clear();
+    for (const auto& [num, s] : shots) Reset(num, shots);
+}
+
+void TrendGraph::Apply(const ShotEvent& e, const ShotTable& shots)
+{
+    Update(e.shot, e.kind == ShotEvent::Kind::Attempt, shots);
+}
+
+void TrendGraph::Revert(const ShotEvent& e, const ShotTable& shots)
+{
+    // Undoing a Remove puts the attempt back on the end
+    Update(e.shot, e.kind == ShotEvent::Kind::Remove, shots);
+}
+
+const std::vector<TrendGraph::Point>& TrendGraph::Points(int shot) const
+{
+    static const std::vector<Point> none;
+    auto it = curves.find(shot);
+    return it != curves.end() ? it->second.points : none;
+}
+
+size_t TrendGraph::Attempts(int shot) const
+{
+    auto it = curves.find(shot);
+    return it != curves.end() ? it->second.n : 0;
+}
+
+void TrendGraph::Append(Curve& c, const ShotStats& s)
+{
+    size_t i = c.n;
+    size_t from = i + 1 >= (size_t)WINDOW ? i + 1 - WINDOW : 0;
+    int goals = 0;
+    for (size_t j = from; j <= i; j++) goals += s.Outcome(j);
+    // As WindowAccuracy rounds it, so a rebuild lands on the same values
+    float y = i + 1 >= (size_t)WINDOW ? (float)goals * (1.f / (float)WINDOW) : (float)goals / (float)(i + 1);
+    Fold(c, { (float)i, y });
+}
+
+void TrendGraph::Fold(Curve& c, Point p)
+{
+    size_t i = c.n;
+    c.n++;
+    if (i == 0) c.first = p;
+    c.last = p;
+
+    if (!c.bins.empty() && c.lastFill < c.width) {
+        Bin& b = c.bins.back();
+        if (p.y < b.lo.y) b.lo = p;
+        if (p.y > b.hi.y) b.hi = p;
+        c.lastFill++;
+        return;
+    }
+
+    if (c.bins.size() == 2 * (size_t)BUDGET) {
+        // Every bin is full: pair them up, keeping the extremes of each pair
+        for (size_t k = 0; k < (size_t)BUDGET; k++) {
+            const Bin& a = c.bins[2 * k];
+            const Bin& b = c.bins[2 * k + 1];
+            c.bins[k] = { b.lo.y < a.lo.y ? b.lo : a.lo, b.hi.y > a.hi.y ? b.hi : a.hi };
+        }
+        c.bins.resize(BUDGET);
+        c.width *= 2;
+    }
+    c.bins.push_back({ p, p });
+    c.lastFill = 1;
+}
+
+void TrendGraph::Downsample(Curve& c)
+{
+    c.points.clear();
+    if (c.n < 2) return;
+
+    // The first attempt, both extremes of every bin and the latest attempt,
+    // in attempt order
+    std::vector<Point> in;
+    in.reserve(c.bins.size() * 2 + 2);
+    auto add = [&in](const Point& p) { if (in.empty() || p.x > in.back().x) in.push_back(p); };
+    add(c.first);
+    for (const Bin& b : c.bins) {
+        add(b.lo.x < b.hi.x ? b.lo : b.hi);
+        add(b.lo.x < b.hi.x ? b.hi : b.lo);
+    }
+    add(c.last);
+    if (in.size() <= (size_t)BUDGET) {
+        c.points = std::move(in);
+        return;
+    }
+
+    // LTTB: keep the ends; from each bucket between them take the point
+    // that makes the largest triangle with the last point taken and the
+    // average of the next bucket
+    const size_t n = in.size();
+    const double every = (double)(n - 2) / (BUDGET - 2);
+    size_t a = 0;
+    c.points.push_back(in[0]);
+    for (int i = 0; i < BUDGET - 2; i++) {
+        size_t avgFrom = (size_t)std::floor((i + 1) * every) + 1;
+        size_t avgTo = std::min((size_t)std::floor((i + 2) * every) + 1, n);
+        double ax = 0.0, ay = 0.0;
+        for (size_t j = avgFrom; j < avgTo; j++) { ax += in[j].x; ay += in[j].y; }
+        ax /= (double)(avgTo - avgFrom);
+        ay /= (double)(avgTo - avgFrom);
+
+        size_t from = (size_t)std::floor(i * every) + 1;
+        size_t to = (size_t)std::floor((i + 1) * every) + 1;
+        double best = -1.0;
+        size_t pick = from;
+        for (size_t j = from; j < to; j++) {
+            double area = std::fabs((in[a].x - ax) * (in[j].y - in[a].y) - (in[a].x - in[j].x) * (ay - in[a].y));
+            if (area > best) { best = area; pick = j; }
+        }
+        c.points.push_back(in[pick]);
+        a = pick;
+    }
+    c.points.push_back(in[n - 1]);
+}
+
+void TrendGraph::Reset(int shot, const ShotTable& shots)
+{
+    auto it = shots.find(shot);
+    if (it == shots.end()) { curves.erase(shot); return; }
+    const ShotStats& s = it->second;
+    Curve& c = curves[shot];
+    c = Curve();
+    if (s.Count() == 0) return;
+
+    // Packed once, then every rolling value from prefix counts rather than
+    // a rescan of the window per attempt
+    PackedHistory h;
+    for (size_t i = 0; i < s.sealed.Size(); i++) h.Push(s.sealed.Outcome(i));
+    h.Append(s.attemptHistory);
+    std::vector<float> acc(h.Size());
+    HistoryKernels::WindowAccuracy(h, WINDOW, acc.data());
+    for (size_t i = 0; i < acc.size(); i++) Fold(c, { (float)i, acc[i] });
+    Downsample(c);
+}
+
+void TrendGraph::Update(int shot, bool appended, const ShotTable& shots)
+{
+    auto it = shots.find(shot);
+    auto curve = curves.find(shot);
+    if (it == shots.end() || curve == curves.end() || !appended ||
+        curve->second.n + 1 != it->second.Count()) {
+        Reset(shot, shots);
+        return;
+    }
+    Append(curve->second, it->second);
+    Downsample(curve->second);
+}
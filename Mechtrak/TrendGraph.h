@@ -0,0 +1,65 @@
+#pragma once
+#include "ShotStats.h"
+#include "SessionLog.h"
+#include <map>
+#include <vector>
+
+// The HUD's trend line: rolling accuracy over each shot's whole history,
+// cut down to a fixed number of points with Largest-Triangle-Three-Buckets.
+//
+// Attempts are folded into at most 2 * BUDGET bins, each keeping its lowest
+// and highest rolling accuracy; when the bins run out, neighbours pair up and
+// the bin width doubles. LTTB then picks BUDGET points from those extremes.
+// An appended attempt costs O(WINDOW) plus one LTTB pass over about
+// 4 * BUDGET points, and the HUD draws BUDGET points, whether the shot has
+// 10 attempts or 10,000. Flips and removals rebuild the shot's bins, taking
+// every rolling value from HistoryKernels::WindowAccuracy in one pass; the
+// append uses the same arithmetic, so both give the same curve.
+// Game thread only, fed the same events as LiveMetrics.
+class TrendGraph {
+public:
+    static constexpr int BUDGET = 64;    // points drawn, about one per 3 px
+    static constexpr int WINDOW = 10;    // attempts behind each rolling value
+
+    struct Point {
+        float x;    // attempt index, 0 = first
+        float y;    // rolling accuracy, 0..1
+    };
+
+    void Rebuild(const ShotTable& shots);
+    // After the SessionLog applied (or redid) e
+    void Apply(const ShotEvent& e, const ShotTable& shots);
+    // After the SessionLog undid e
+    void Revert(const ShotEvent& e, const ShotTable& shots);
+
+    // Oldest first; empty for a shot with fewer than two attempts
+    const std::vector<Point>& Points(int shot) const;
+    size_t Attempts(int shot) const;
+
+private:
+    struct Bin {
+        Point lo;
+        Point hi;
+    };
+
+    struct Curve {
+        size_t n = 0;               // attempts folded in
+        size_t width = 1;           // attempts per bin; the last bin may hold fewer
+        size_t lastFill = 0;        // attempts in the last bin
+        Point first = {};           // kept so the line spans the whole history
+        Point last = {};
+        std::vector<Bin>   bins;
+        std::vector<Point> points;  // what Points() returns
+    };
+
+    // Adds attempt c.n of s, sealed or hot
+    static void Append(Curve& c, const ShotStats& s);
+    // Adds the next attempt, whose rolling accuracy is p
+    static void Fold(Curve& c, Point p);
+    static void Downsample(Curve& c);
+    void Reset(int shot, const ShotTable& shots);
+    // An append when the history grew by one at the end, otherwise a rebuild
+    void Update(int shot, bool appended, const ShotTable& shots);
+
+    std::map<int, Curve> curves;
+};
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdio>
+#include <cstdlib>
+
+// Shared by the test_*.cpp programs: a failed CHECK prints where and exits 1,
+// so each test is just a main() that runs to the end when everything holds.
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                \
+                __FILE__, __LINE__, #cond);                                  \
+            std::exit(1);                                                    \
+        }                                                                    \
+    } while (0)
@@ -0,0 +1,150 @@
+// Cost of reading GET /api/sessions/active: the body fed in 8 KB chunks to
+// JsonStreamParser with the ActiveSessionHandler Session uses, against
+// collecting it into one string, nlohmann::json::parse and the copy loop
+// that filled the shot table before. Responses of 10, 100 and 1000 shots of
+// 60 timed attempts, shaped as SessionJson::Write shapes a shot; both paths
+// must stage the same table. Then the token response, the smallest one.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. bench_json_parse.cpp ../SessionJson.cpp ../JsonReader.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o bench_json_parse && ./bench_json_parse
+
+#include "Check.h"
+#include "SessionJson.h"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const int ATTEMPTS = 60;
+    const size_t CHUNK = 8 * 1024;
+
+    // { "success": true, "session": { "session_id", "shots_data" } } with
+    // count shots in the saved-file shape
+    std::string Response(std::mt19937& rng, int count)
+    {
+        ShotTable shots;
+        ShotNames names;
+        uint32_t clock = 0;
+        for (int shot = 1; shot <= count; shot++) {
+            ShotStats& s = shots[shot];
+            for (int i = 0; i < ATTEMPTS; i++) {
+                bool goal = rng() % 3 == 0;
+                s.attemptHistory.push_back(goal);
+                s.attempts++;
+                s.goals += goal;
+                clock += 1000;
+                timing::Push(s.attemptTimes, { clock, clock + 200, clock + 900 });
+            }
+            names[shot] = "Shot type " + std::to_string(shot % 9);
+        }
+        std::string file;
+        SessionJson::Write(file, false, "session_1760875200000", true, std::chrono::system_clock::now(),
+            shots, names, SessionTotals{}, MetricsReport{});
+        json doc = json::parse(file);
+        json response;
+        response["success"] = true;
+        response["session"]["session_id"] = "session_1760875200000";
+        response["session"]["shots_data"] = doc["shots"];
+        return response.dump();
+    }
+
+    // The old path, chunks and all
+    bool Dom(const std::string& body, ShotTable& shots, ShotNames& names)
+    {
+        std::string collected;
+        for (size_t at = 0; at < body.size(); at += CHUNK)
+            collected.append(body, at, std::min(CHUNK, body.size() - at));
+        try {
+            json response = json::parse(collected);
+            if (response["success"] != true || response["session"].is_null()) return false;
+            auto session = response["session"];
+            for (auto& [num, data] : session["shots_data"].items()) {
+                ShotStats stats;
+                stats.attempts = data["attempts"];
+                stats.goals = data["goals"];
+                for (bool result : data["attemptHistory"]) stats.attemptHistory.push_back(result);
+                shots[std::stoi(num)] = stats;
+                names[std::stoi(num)] = data["shotType"].get<std::string>();
+            }
+            return true;
+        }
+        catch (...) {
+            return false;
+        }
+    }
+
+    template<typename Handler>
+    bool Stream(const std::string& body, Handler& handler)
+    {
+        JsonStreamParser parser(handler);
+        for (size_t at = 0; at < body.size(); at += CHUNK)
+            if (!parser.Feed(body.data() + at, std::min(CHUNK, body.size() - at))) return false;
+        return parser.Finish();
+    }
+
+    // Best of reps, in ms
+    template<typename Read>
+    double Time(int reps, Read&& read)
+    {
+        double best = 1e30;
+        for (int r = 0; r < reps; r++) {
+            auto start = Clock::now();
+            read();
+            best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(28);
+    for (int count : { 10, 100, 1000 }) {
+        const std::string body = Response(rng, count);
+        int reps = std::max(5, 2000 / count);
+
+        ShotTable domShots;
+        ShotNames domNames;
+        CHECK(Dom(body, domShots, domNames));
+        ActiveSessionHandler streamed(true);
+        CHECK(Stream(body, streamed));
+        CHECK(streamed.success && streamed.hasSession && streamed.sessionId == "session_1760875200000");
+        CHECK(streamed.table.shots.size() == (size_t)count && domShots.size() == (size_t)count);
+        for (const auto& [num, s] : domShots) {
+            const ShotStats& t = streamed.table.shots[num];
+            CHECK(t.attempts == s.attempts && t.goals == s.goals && t.attemptHistory == s.attemptHistory);
+            CHECK(t.Timed() == (size_t)ATTEMPTS);
+            CHECK(streamed.table.types[num] == domNames[num]);
+        }
+
+        double dom = Time(reps, [&] {
+            ShotTable shots;
+            ShotNames names;
+            CHECK(Dom(body, shots, names));
+        });
+        double stream = Time(reps, [&] {
+            ActiveSessionHandler handler(true);
+            CHECK(Stream(body, handler));
+        });
+        std::printf("  %4d shots (%4zu KB): json::parse and copy %7.3f ms, stream %7.3f ms (%.0f MB/s)\n",
+            count, body.size() / 1024, dom, stream, body.size() / (1024.0 * 1024.0) / (stream / 1000.0));
+    }
+
+    const std::string token = "{\"success\":true,\"token\":\"" + std::string(64, 'a') + "\"}";
+    double dom = Time(2000, [&] {
+        json response = json::parse(token);
+        CHECK(response["success"] == true && response["token"].get<std::string>().size() == 64);
+    });
+    double stream = Time(2000, [&] {
+        TokenHandler handler;
+        CHECK(Stream(token, handler) && handler.success && handler.token.size() == 64);
+    });
+    std::printf("  token: json::parse %.2f us, stream %.2f us\n", dom * 1000.0, stream * 1000.0);
+    std::printf("bench_json_parse: ok\n");
+    return 0;
+}
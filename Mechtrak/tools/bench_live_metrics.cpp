@@ -0,0 +1,137 @@
+// Cost of keeping the rolling figures current, as MechTrak::Record does it:
+// SessionLog::Apply and then LiveMetrics::Apply for each attempt, on a
+// session of 8 shots. ns per attempt is sampled as the session grows from 0
+// to 100k attempts, so it shows whether the cost stays flat; then undo and
+// redo of the newest attempt, a flip near the end of a shot and removals.
+// Those replay the edited shot's drop detector, so they grow with the shot
+// where appending does not. The shot figures must match a full rebuild at
+// the end.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. bench_live_metrics.cpp ../LiveMetrics.cpp ../DropDetector.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o bench_live_metrics && ./bench_live_metrics
+
+#include "Check.h"
+#include "LiveMetrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const int SHOTS = 8;
+    const int TOTAL = 100000;
+    const int SAMPLE = 2000;   // attempts timed at each point
+
+    bool Same(const RollingStats& a, const RollingStats& b)
+    {
+        return a.last10 == b.last10 && a.last25 == b.last25 && a.last50 == b.last50 &&
+            a.streak == b.streak && a.bestStreak == b.bestStreak &&
+            std::abs(a.ewma - b.ewma) < 1e-5f && a.wilsonLow == b.wilsonLow && a.wilsonHigh == b.wilsonHigh;
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(40);
+    ShotTable shots;
+    SessionLog log;
+    LiveMetrics metrics;
+    log.Bind("bench");
+
+    // Attempts only, timed in batches of SAMPLE; the best batch of each
+    // 20k is shown
+    std::vector<std::pair<int, double>> growth;
+    std::vector<ShotEvent> batch(SAMPLE);
+    double logOnly;
+    for (int done = 0; done < TOTAL; done += SAMPLE) {
+        for (auto& e : batch) e = ShotEvent::Attempt(1 + (int)(rng() % SHOTS), rng() % 5 < 2);
+        auto start = Clock::now();
+        for (const auto& e : batch) {
+            CHECK(log.Apply(shots, e));
+            metrics.Apply(e, shots);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / SAMPLE;
+        if (done % 20000 == 0) growth.push_back({ done, ns });
+        else growth.back().second = std::min(growth.back().second, ns);
+    }
+
+    // The log alone, on a copy of the table, for the split; best of 10
+    {
+        ShotTable copy = shots;
+        SessionLog alone;
+        alone.Bind("bench-log");
+        logOnly = 1e30;
+        for (int r = 0; r < 10; r++) {
+            for (auto& e : batch) e = ShotEvent::Attempt(1 + (int)(rng() % SHOTS), rng() % 5 < 2);
+            auto start = Clock::now();
+            for (const auto& e : batch) CHECK(alone.Apply(copy, e));
+            logOnly = std::min(logOnly, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / SAMPLE);
+        }
+    }
+
+    // Undo then redo of the newest attempt, SAMPLE times
+    auto start = Clock::now();
+    for (int i = 0; i < SAMPLE; i++) {
+        const ShotEvent* e = log.Undo(shots);
+        CHECK(e != nullptr);
+        metrics.Revert(*e, shots);
+        e = log.Redo(shots);
+        CHECK(e != nullptr);
+        metrics.Apply(*e, shots);
+    }
+    double undoRedo = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (2 * SAMPLE);
+
+    // Flips among a shot's last 20 attempts, twice each so the table ends
+    // where it started
+    start = Clock::now();
+    for (int i = 0; i < SAMPLE; i++) {
+        int shot = 1 + (int)(rng() % SHOTS);
+        int index = (int)shots[shot].Count() - 1 - (int)(rng() % 20);
+        for (int k = 0; k < 2; k++) {
+            ShotEvent e = ShotEvent::Flip(shot, index);
+            CHECK(log.Apply(shots, e));
+            metrics.Apply(e, shots);
+        }
+    }
+    double flip = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (2 * SAMPLE);
+
+    // Removing the session's latest attempt, and the latest of another
+    // shot, which rebuilds the session stream; each is put back untimed
+    const int REMOVALS = 50;
+    double removeLatest = 0.0, removeOlder = 0.0;
+    for (int i = 0; i < REMOVALS; i++) {
+        int shot = 1 + (int)(rng() % SHOTS);
+        for (int other = 0; other < 2; other++) {
+            ShotEvent newest = ShotEvent::Attempt(shot, rng() % 5 < 2);
+            CHECK(log.Apply(shots, newest));
+            metrics.Apply(newest, shots);
+            int from = other ? shot % SHOTS + 1 : shot;
+            bool goal = shots[from].Outcome(shots[from].Count() - 1);
+            start = Clock::now();
+            CHECK(log.Apply(shots, ShotEvent::Remove(from)));
+            metrics.Apply(*(log.end() - 1), shots);
+            (other ? removeOlder : removeLatest) += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            ShotEvent back = ShotEvent::Attempt(from, goal);
+            CHECK(log.Apply(shots, back));
+            metrics.Apply(back, shots);
+        }
+    }
+    removeLatest /= REMOVALS;
+    removeOlder /= REMOVALS;
+
+    LiveMetrics rebuilt;
+    rebuilt.Rebuild(shots);
+    for (int shot = 1; shot <= SHOTS; shot++) CHECK(Same(metrics.Shot(shot), rebuilt.Shot(shot)));
+
+    for (auto [done, ns] : growth)
+        std::printf("  attempts %6d-%6d: %.0f ns each (log and metrics)\n", done, done + 20000, ns);
+    std::printf("  log alone %.0f ns; with %zu attempts a shot: undo or redo %.1f us, flip %.1f us, removal of the "
+        "latest %.1f us, of another shot's latest %.1f us\n", logOnly, shots[1].Count(),
+        undoRedo / 1000.0, flip / 1000.0, removeLatest / 1000.0, removeOlder / 1000.0);
+    std::printf("bench_live_metrics: ok\n");
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Rollups over five years of synthetic play: one session most days, 6 shot
+// types, a few hundred attempts a session. Times folding a session in, alone
+// and with the save stats_end_session makes, a Rebuild from the whole list,
+// loading the store, a 260-week graph for every type through Series, single
+// Gets, and the same graph by rescanning every session. Sessions start on
+// the hour and last under one, in UTC, so each lands whole in one bucket
+// and every series can be checked against a plain recount.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. bench_rollups.cpp ../Rollups.cpp -o bench_rollups && ./bench_rollups
+
+#include "Check.h"
+#include "Rollups.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <random>
+
+using Clock = std::chrono::steady_clock;
+using Resolution = Rollups::Resolution;
+
+namespace
+{
+    const int64_t START = 1609459200;   // 2021-01-01 00:00 UTC
+    const int DAYS = 5 * 365 + 1;
+    const char* TYPES[] = { "Air dribble", "Ceiling shot", "Flip reset", "Musty", "Redirect", "Wall shot" };
+
+    double Ms(Clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    std::vector<ImportedSession> Play(std::mt19937& rng)
+    {
+        std::vector<ImportedSession> sessions;
+        for (int day = 0; day < DAYS; day++) {
+            if (rng() % 100 < 4) continue;                 // a day off now and then
+            ImportedSession s;
+            s.sessionId = std::to_string(day);
+            s.startTime = START + day * 86400LL + (16 + rng() % 6) * 3600;
+            s.durationMinutes = 20 + (int)(rng() % 40);
+            int improving = 25 + day * 30 / DAYS;          // percent, rising over the years
+            for (int shot = 0; shot < 8; shot++) {
+                ImportedShot sh;
+                sh.shotNum = shot + 1;
+                sh.shotType = TYPES[rng() % 6];
+                int n = 20 + (int)(rng() % 80);
+                for (int i = 0; i < n; i++) {
+                    bool goal = (int)(rng() % 100) < improving;
+                    sh.attemptHistory.push_back(goal);
+                    sh.attempts++;
+                    sh.goals += goal;
+                }
+                s.shots.push_back(std::move(sh));
+            }
+            sessions.push_back(std::move(s));
+        }
+        return sessions;
+    }
+
+    // type -> bucket -> totals, the obvious way
+    std::map<std::string, std::map<int32_t, Rollups::Bucket>> Recount(
+        const std::vector<ImportedSession>& sessions, Resolution res)
+    {
+        std::map<std::string, std::map<int32_t, Rollups::Bucket>> out;
+        for (const auto& s : sessions) {
+            int32_t b = Rollups::BucketOf(s.startTime, res);
+            for (const auto& sh : s.shots)
+                for (const std::string& type : { sh.shotType, std::string(Rollups::ALL) }) {
+                    out[type][b].attempts += sh.attempts;
+                    out[type][b].goals += sh.goals;
+                }
+        }
+        return out;
+    }
+
+    // Every series of every type at every resolution against the recount
+    void Check(const std::vector<ImportedSession>& sessions)
+    {
+        for (int r = 0; r < Rollups::RESOLUTIONS; r++) {
+            Resolution res = (Resolution)r;
+            auto want = Recount(sessions, res);
+            int32_t first = want[Rollups::ALL].begin()->first, last = Rollups::Latest(res);
+            CHECK(last == want[Rollups::ALL].rbegin()->first);
+            for (const auto& [type, buckets] : want) {
+                auto series = Rollups::Series(type, res, first, (size_t)(last - first + 1));
+                for (int32_t b = first; b <= last; b++) {
+                    auto it = buckets.find(b);
+                    Rollups::Bucket expect = it != buckets.end() ? it->second : Rollups::Bucket();
+                    CHECK(series[(size_t)(b - first)].attempts == expect.attempts);
+                    CHECK(series[(size_t)(b - first)].goals == expect.goals);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    setenv("TZ", "UTC", 1);
+    tzset();
+    std::mt19937 rng(42);
+    const std::vector<ImportedSession> sessions = Play(rng);
+    size_t attempts = 0;
+    for (const auto& s : sessions)
+        for (const auto& sh : s.shots) attempts += (size_t)sh.attempts;
+
+    // Folding alone: before Open there is no file, so nothing is saved
+    auto start = Clock::now();
+    for (const auto& s : sessions) Rollups::Add(s);
+    double fold = Ms(start) * 1000.0 / sessions.size();
+    Check(sessions);
+
+    // Rebuilt into a store on disk, then loaded back
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_bench_rollups";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    Rollups::Open(folder.string());
+    start = Clock::now();
+    Rollups::Rebuild(sessions);
+    double rebuild = Ms(start);
+    size_t bytes = (size_t)std::filesystem::file_size(folder / "rollups.mtk");
+    start = Clock::now();
+    Rollups::Open(folder.string());
+    double load = Ms(start);
+    Check(sessions);
+
+    // The last 260 weeks for every type and the total
+    const size_t WEEKS = 260;
+    int32_t lastWeek = Rollups::Latest(Resolution::Week);
+    int32_t firstWeek = lastWeek - (int32_t)WEEKS + 1;
+    std::vector<std::string> types = Rollups::Types();
+    types.push_back(Rollups::ALL);
+    const int REPS = 200;
+    int64_t sink = 0;
+    start = Clock::now();
+    for (int rep = 0; rep < REPS; rep++)
+        for (const auto& type : types) sink += Rollups::Series(type, Resolution::Week, firstWeek, WEEKS)[rep % WEEKS].attempts;
+    double graph = Ms(start) / REPS;
+
+    start = Clock::now();
+    const int GETS = 1000000;
+    for (int i = 0; i < GETS; i++)
+        sink += Rollups::Get(types[(size_t)i % types.size()], Resolution::Day, (int32_t)(START / 86400 + i % DAYS)).goals;
+    double get = Ms(start) * 1e6 / GETS;
+
+    // The same graph by reading every session again
+    start = Clock::now();
+    for (int rep = 0; rep < 10; rep++) {
+        std::map<std::string, std::vector<Rollups::Bucket>> rescan;
+        for (const auto& s : sessions) {
+            int32_t w = Rollups::BucketOf(s.startTime, Resolution::Week) - firstWeek;
+            if (w < 0 || w >= (int32_t)WEEKS) continue;
+            for (const auto& sh : s.shots)
+                for (const std::string& type : { sh.shotType, std::string(Rollups::ALL) }) {
+                    auto& series = rescan[type];
+                    series.resize(WEEKS);
+                    series[(size_t)w].attempts += sh.attempts;
+                    series[(size_t)w].goals += sh.goals;
+                }
+        }
+        sink += rescan[Rollups::ALL][(size_t)rep].attempts;
+    }
+    double rescan = Ms(start) / 10;
+
+    // Sessions after the five years, each saving the whole store as
+    // stats_end_session does
+    const int MORE = 20;
+    double saved = 0.0;
+    for (int i = 0; i < MORE; i++) {
+        ImportedSession s = sessions[(size_t)i];
+        s.startTime += DAYS * 86400LL;
+        start = Clock::now();
+        Rollups::Add(s);
+        saved += Ms(start);
+    }
+    saved /= MORE;
+
+    std::filesystem::remove_all(folder);
+    std::printf("  %zu sessions, %zu attempts, %zu KB store\n", sessions.size(), attempts, bytes / 1024);
+    std::printf("  folding a session in %.1f us; Add with its save %.2f ms; Rebuild with one save %.1f ms; load %.2f ms\n",
+        fold, saved, rebuild, load);
+    std::printf("  %zu-week graph of %zu series: %.1f us (%.1f ns a bucket); Get %.0f ns; rescanning the sessions %.2f ms\n",
+        WEEKS, types.size(), graph * 1000.0, graph * 1e6 / (WEEKS * types.size()), get, rescan);
+    std::printf("bench_rollups: ok (%lld)\n", (long long)(sink % 10));
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Cost of writing a session file: SessionJson::Write into a reused buffer,
+// compact and pretty, against the nlohmann tree SaveToFile used to build and
+// dump(2), with the fields it wrote then. Sessions of 10, 100 and 1000 shots
+// of 60 attempts, untimed and timed; ns per shot and heap allocations per
+// save, with every global new counted. The tree writes neither times nor
+// metrics, so the comparison leans its way. Every output must parse back to
+// the same shots.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. bench_session_json.cpp ../SessionJson.cpp ../JsonReader.cpp ../SessionAggregates.cpp ../LiveMetrics.cpp ../DropDetector.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o bench_session_json && ./bench_session_json
+
+#include "Check.h"
+#include "SessionJson.h"
+#include "json.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    std::atomic<size_t> allocations{ 0 };
+}
+
+void* operator new(size_t bytes)
+{
+    allocations++;
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace
+{
+    const int ATTEMPTS = 60;
+
+    // Formatted on the stack so only the saves' own allocations count
+    const char* Name(int shot)
+    {
+        static char text[64];
+        std::snprintf(text, sizeof(text), "Shot type %d", shot % 9);
+        return text;
+    }
+
+    // The old path: one tree for the whole session, then dump(2)
+    void Dom(std::string& out, const std::string& sessionId, const ShotTable& shots, const ShotNames& names)
+    {
+        json data;
+        data["sessionId"] = sessionId;
+        data["status"] = "active";
+        data["startTime"] = "2026-10-19T12:00:00";
+        data["lastUpdated"] = "2026-10-19T12:30:00";
+        data["durationMinutes"] = 30;
+        int attempts = 0, goals = 0;
+        for (const auto& [num, s] : shots) {
+            attempts += s.attempts;
+            goals += s.goals;
+        }
+        data["totalAttempts"] = attempts;
+        data["totalGoals"] = goals;
+        data["totalAccuracy"] = attempts > 0 ? (float)goals / attempts * 100.0f : 0.0f;
+        json shotsData;
+        for (const auto& [num, s] : shots) {
+            json shot;
+            shot["attempts"] = s.attempts;
+            shot["goals"] = s.goals;
+            shot["attemptHistory"] = std::vector<bool>(s.attemptHistory.begin(), s.attemptHistory.end());
+            auto type = names.find(num);
+            shot["shotType"] = type != names.end() ? std::string(type->second) : "Unknown";
+            shot["accuracy"] = s.attempts > 0 ? (float)s.goals / s.attempts * 100.0f : 0.0f;
+            shotsData[std::to_string(num)] = shot;
+        }
+        data["shots"] = shotsData;
+        data["totalShots"] = shots.size();
+        out = data.dump(2);
+    }
+
+    struct Cost {
+        double nsPerShot;
+        double allocations;
+    };
+
+    // Best of reps saves
+    template<typename Save>
+    Cost Measure(int shots, int reps, Save&& save)
+    {
+        save();   // warms whatever the save reuses
+        Cost best{ 1e30, 1e30 };
+        for (int r = 0; r < reps; r++) {
+            size_t before = allocations;
+            auto start = Clock::now();
+            save();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            best.nsPerShot = std::min(best.nsPerShot, ns / shots);
+            best.allocations = std::min(best.allocations, (double)(allocations - before));
+        }
+        return best;
+    }
+
+    // Shot number -> attempts and goals, as the file says
+    std::map<int, std::pair<int, int>> Counts(const std::string& text, const char* shotsKey)
+    {
+        std::map<int, std::pair<int, int>> counts;
+        json doc = json::parse(text);
+        for (auto& [key, shot] : doc[shotsKey].items())
+            counts[std::stoi(key)] = { shot["attempts"].get<int>(), shot["goals"].get<int>() };
+        return counts;
+    }
+
+    // One session of `count` shots, saved each way
+    void Run(std::mt19937& rng, int count, bool timed)
+    {
+        ShotTable shots;
+        ShotNames names;
+        uint32_t clock = 0;
+        for (int shot = 1; shot <= count; shot++) {
+            ShotStats& s = shots[shot];
+            for (int i = 0; i < ATTEMPTS; i++) {
+                bool goal = rng() % 3 == 0;
+                s.attemptHistory.push_back(goal);
+                s.attempts++;
+                s.goals += goal;
+                clock += 1000;
+                if (timed) timing::Push(s.attemptTimes, { clock, clock + 200, clock + 900 });
+            }
+            names[shot] = Name(shot);
+        }
+        const std::string id = "session_1760875200000";
+        const auto started = std::chrono::system_clock::now() - std::chrono::minutes(30);
+        SessionTotals totals = SessionTotals::Of(shots);
+        MetricsReport metrics = LiveMetrics::Of(shots);
+
+        std::string compact, pretty, dom;
+        int reps = std::max(5, 20000 / count);
+        Cost writer = Measure(count, reps, [&] {
+            SessionJson::Write(compact, false, id, true, started, shots, names, totals, metrics);
+        });
+        Cost indented = Measure(count, reps, [&] {
+            SessionJson::Write(pretty, true, id, true, started, shots, names, totals, metrics);
+        });
+        Cost tree = Measure(count, reps, [&] { Dom(dom, id, shots, names); });
+
+        auto want = Counts(dom, "shots");
+        CHECK(want.size() == (size_t)count);
+        CHECK(Counts(compact, "shots") == want);
+        CHECK(Counts(pretty, "shots") == want);
+
+        std::printf("  %4d %s shots: tree + dump(2) %6.0f ns/shot, %6.0f allocations; writer %4.0f ns/shot, %.0f allocations "
+            "(pretty %4.0f ns/shot, %.0f allocations); %zu bytes compact\n",
+            count, timed ? "timed  " : "untimed", tree.nsPerShot, tree.allocations, writer.nsPerShot, writer.allocations,
+            indented.nsPerShot, indented.allocations, compact.size());
+    }
+}
+
+int main()
+{
+    std::mt19937 rng(27);
+    for (int count : { 10, 100, 1000 }) {
+        Run(rng, count, false);
+        Run(rng, count, true);
+    }
+    std::printf("bench_session_json: ok\n");
+    return 0;
+}
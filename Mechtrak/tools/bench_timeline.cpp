@@ -0,0 +1,216 @@
+// Cost of the timeline panel on a headless ImGui: a 3-hour session of 2000
+// attempts over 8 shots, recorded through SessionLog and SessionTimeline as
+// MechTrak::Record does, with the odd removal and undo. A frame is the panel
+// laid out as HUD::RenderTimeline lays it out, between NewFrame and Render,
+// for the whole session, a 30-minute window and one minute; then
+// SessionTimeline::Draw alone against drawing every live mark. The marks
+// must match the table, a Rebuild must give the same marks, and a lane gets
+// at most two ticks a pixel column.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. -DIMGUI_NO_ROOT_PCH bench_timeline.cpp ../SessionTimeline.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp ../IMGUI/imgui.cpp ../IMGUI/imgui_draw.cpp ../IMGUI/imgui_widgets.cpp ../IMGUI/imgui_timeline.cpp -o bench_timeline && ./bench_timeline
+
+#include "Check.h"
+#include "SessionTimeline.h"
+#include "IMGUI/imgui_timeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const int SHOTS = 8;
+    const int ATTEMPTS = 2000;
+    const uint32_t LENGTH = 3 * 3600 * 1000;   // ms
+    const float TW = 720.f, TH = 240.f, HDR = 34.f, PAD = 12.f;
+
+    // The live marks of each shot, oldest first, as goals and misses
+    std::map<int, std::vector<bool>> Lanes(const SessionTimeline& timeline)
+    {
+        std::map<int, std::vector<bool>> lanes;
+        for (const auto* m = timeline.At(0); m != timeline.end(); ++m)
+            if (m->alive) lanes[m->shot].push_back(m->goal);
+        return lanes;
+    }
+
+    // HUD::RenderTimeline without its input handling
+    void Panel(SessionTimeline& timeline, const ShotTable& shots, uint32_t nowMs)
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        auto& view = timeline.view;
+        const uint32_t total = std::max(nowMs, timeline.LastMs());
+        if (view.follow) {
+            view.start = 0;
+            view.span = std::max(total, SessionTimeline::MIN_SPAN);
+        }
+        ImGuiWindowFlags flags =
+            ImGuiWindowFlags_NoTitleBar | ImGuiWindowFlags_NoResize |
+            ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoCollapse |
+            ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings |
+            ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoFocusOnAppearing |
+            ImGuiWindowFlags_NoScrollWithMouse;
+        ImGui::SetNextWindowPos({ (io.DisplaySize.x - TW) * 0.5f, io.DisplaySize.y * 0.62f }, ImGuiCond_Always);
+        ImGui::SetNextWindowSize({ TW, TH }, ImGuiCond_Always);
+        ImGui::SetNextWindowBgAlpha(0.f);
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, { PAD, PAD });
+        ImGui::PushStyleVar(ImGuiStyleVar_WindowBorderSize, 0.f);
+        ImGui::PushStyleVar(ImGuiStyleVar_ChildBorderSize, 0.f);
+        if (ImGui::Begin("##MechTrakTimeline", nullptr, flags)) {
+            ImDrawList* dl = ImGui::GetWindowDrawList();
+            ImVec2 wp = ImGui::GetWindowPos();
+            ImFont* fnt = ImGui::GetFont();
+            const float FS = fnt->FontSize;
+            dl->AddRectFilled(wp, { wp.x + TW, wp.y + TH }, IM_COL32(0, 0, 0, 242), 14.f);
+            dl->AddRect(wp, { wp.x + TW, wp.y + TH }, IM_COL32(70, 130, 255, 40), 14.f, 0, 1.f);
+            dl->AddRectFilled(wp, { wp.x + TW, wp.y + HDR }, IM_COL32(8, 25, 70, 235), 14.f);
+            char title[64];
+            std::snprintf(title, sizeof(title), "SESSION TIMELINE  %u - %u", view.start / 1000, (view.start + view.span) / 1000);
+            dl->AddText(fnt, FS, { wp.x + PAD, wp.y + (HDR - FS) * 0.5f }, IM_COL32(255, 255, 255, 255), title);
+
+            ImGui::SetCursorPos({ PAD, HDR + 8.f });
+            if (ImGui::BeginTimeline("##MechTrakTimelineTrack", view.span / 60000.f)) {
+                ImVec2 tp = ImGui::GetWindowPos();
+                ImVec2 t0 = { tp.x + ImGui::GetWindowContentRegionMin().x, tp.y + ImGui::GetWindowContentRegionMin().y };
+                ImVec2 t1 = { tp.x + ImGui::GetWindowContentRegionMax().x,
+                    tp.y + ImGui::GetWindowContentRegionMax().y - ImGui::GetTextLineHeightWithSpacing() };
+                timeline.Draw(ImGui::GetWindowDrawList(), t0, t1, shots);
+            }
+            float now = nowMs >= view.start && nowMs <= view.start + view.span ? (nowMs - view.start) / 60000.f : -1.f;
+            ImGui::EndTimeline(now);
+        }
+        ImGui::End();
+        ImGui::PopStyleVar(3);
+    }
+
+    struct Frame {
+        double us;
+        int vertices;
+    };
+
+    // Best of 20 batches of 50 frames
+    Frame Frames(SessionTimeline& timeline, const ShotTable& shots)
+    {
+        Frame best{ 1e30, 0 };
+        for (int batch = 0; batch < 20; batch++) {
+            auto start = Clock::now();
+            for (int i = 0; i < 50; i++) {
+                ImGui::NewFrame();
+                Panel(timeline, shots, LENGTH);
+                ImGui::Render();
+            }
+            best.us = std::min(best.us, std::chrono::duration<double, std::micro>(Clock::now() - start).count() / 50);
+            best.vertices = ImGui::GetDrawData()->TotalVtxCount;
+        }
+        return best;
+    }
+
+    // Best of 1000, in us, with the ticks emitted
+    template<typename Paint>
+    std::pair<double, int> Ticks(Paint&& paint)
+    {
+        ImDrawList dl(ImGui::GetDrawListSharedData());
+        double best = 1e30;
+        for (int r = 0; r < 1000; r++) {
+            dl.Clear();
+            dl.PushClipRect({ 0, 0 }, { 1920, 1080 });
+            dl.PushTextureID(ImGui::GetIO().Fonts->TexID);
+            auto start = Clock::now();
+            paint(dl);
+            best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        return { best, dl.VtxBuffer.Size / 4 };
+    }
+}
+
+int main()
+{
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = { 1920, 1080 };
+    io.DeltaTime = 1.f / 60.f;
+    io.IniFilename = nullptr;
+    unsigned char* pixels;
+    int w, h;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &w, &h);
+
+    std::mt19937 rng(47);
+    ShotTable shots;
+    SessionLog log;
+    SessionTimeline timeline;
+    log.Bind("bench");
+    for (int shot = 1; shot <= SHOTS; shot++) shots[shot];
+    timeline.Rebuild(shots);
+    for (int i = 0; i < ATTEMPTS; i++) {
+        uint32_t ms = (uint32_t)((uint64_t)LENGTH * (i + 1) / ATTEMPTS) - rng() % 2000;
+        int shot = 1 + (int)(rng() % SHOTS);
+        ShotEvent e = ShotEvent::Attempt(shot, rng() % 5 < 2, { ms - 4000, ms - 3000, ms });
+        CHECK(log.Apply(shots, e));
+        timeline.Apply(e, ms, shots);
+        if (rng() % 50 == 0) {
+            CHECK(log.Apply(shots, ShotEvent::Remove(shot)));
+            timeline.Apply(*(log.end() - 1), ms, shots);
+        }
+        else if (rng() % 50 == 0) {
+            const ShotEvent* undone = log.Undo(shots);
+            CHECK(undone != nullptr);
+            timeline.Revert(*undone, shots);
+        }
+    }
+
+    std::map<int, std::vector<bool>> lanes = Lanes(timeline);
+    size_t live = 0;
+    for (const auto& [num, s] : shots) {
+        CHECK(lanes[num].size() == s.Count());
+        for (size_t i = 0; i < s.Count(); i++) CHECK(lanes[num][i] == s.Outcome(i));
+        live += s.Count();
+    }
+    SessionTimeline rebuilt;
+    rebuilt.Rebuild(shots);
+    CHECK(Lanes(rebuilt) == lanes);
+
+    // A few frames so the window settles before timing
+    for (int i = 0; i < 3; i++) {
+        ImGui::NewFrame();
+        Panel(timeline, shots, LENGTH);
+        ImGui::Render();
+    }
+
+    struct Window { const char* name; uint32_t start, span; };
+    const ImVec2 t0 = { 0, 0 }, t1 = { TW - 2 * PAD, 160 };
+    for (Window v : { Window{ "whole session", 0, 0 }, Window{ "30 minutes", LENGTH / 2, 30 * 60000 },
+        Window{ "1 minute", LENGTH / 2, 60000 } }) {
+        timeline.view = SessionTimeline::View();
+        if (v.span) timeline.view = { v.start, v.span, false };
+        Frame frame = Frames(timeline, shots);
+
+        auto [drawUs, ticks] = Ticks([&](ImDrawList& dl) { timeline.Draw(&dl, t0, t1, shots); });
+        // Every live mark in the view, no column culling
+        const uint32_t from = timeline.view.start, to = from + timeline.view.span;
+        const float pxPerMs = (t1.x - t0.x) / (float)timeline.view.span;
+        auto [allUs, all] = Ticks([&](ImDrawList& dl) {
+            for (const auto* m = timeline.At(from), *last = timeline.At(to); m != last; ++m) {
+                if (!m->alive) continue;
+                float x = t0.x + (m->ms - from) * pxPerMs, y = t0.y + (m->shot - 1) * 20.f;
+                dl.AddRectFilled({ x, m->goal ? y : y + 9.f }, { x + 2.f, y + 18.f }, m->goal ? 0xFFFFFFFF : 0x80808080);
+            }
+        });
+        // Columns a lane has marks in: Draw emits one tick each, or two
+        // where a goal follows a miss
+        std::set<std::pair<int, int>> columns;
+        for (const auto* m = timeline.At(from), *last = timeline.At(to); m != last; ++m)
+            if (m->alive) columns.insert({ m->shot, (int)((m->ms - from) * pxPerMs) });
+        CHECK(ticks >= (int)columns.size() && ticks <= 2 * (int)columns.size());
+        CHECK(all >= ticks);
+
+        std::printf("  %-13s: frame %5.1f us, %5d vertices; Draw %5.1f us for %4d ticks, every mark %5.1f us for %4d\n",
+            v.name, frame.us, frame.vertices, drawUs, ticks, allUs, all);
+    }
+    std::printf("  %zu live marks of %zu held\n", live, timeline.Size());
+    ImGui::DestroyContext();
+    std::printf("bench_timeline: ok\n");
+    return 0;
+}
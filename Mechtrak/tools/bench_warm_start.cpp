@@ -0,0 +1,167 @@
+// Cost of the warm start onLoad does before the first HUD frame: the steps of
+// Session::LoadSnapshot (current_session, SessionJson::Read, the start time,
+// the move into the arena tables) and then MechTrak::Retally's rebuilds of
+// the aggregates, metrics, trend line and timeline. Saved sessions of 10, 50
+// and 200 shots of 150 timed attempts, written by SessionJson::Write to a
+// temporary folder and read back with the page cache warm, best of reps.
+// After this the first frame waits only for the next game tick. The tables
+// must come back as saved, and a completed session must not be restored.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. -DIMGUI_NO_ROOT_PCH bench_warm_start.cpp ../SessionJson.cpp ../JsonReader.cpp ../SessionAggregates.cpp ../LiveMetrics.cpp ../DropDetector.cpp ../TrendGraph.cpp ../HistoryKernels.cpp ../SessionTimeline.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp ../IMGUI/imgui.cpp ../IMGUI/imgui_draw.cpp ../IMGUI/imgui_widgets.cpp -o bench_warm_start && ./bench_warm_start
+
+#include "Check.h"
+#include "SessionJson.h"
+#include "SessionArena.h"
+#include "TrendGraph.h"
+#include "SessionTimeline.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <sstream>
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const int ATTEMPTS = 150;
+
+    double Ms(Clock::time_point since)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+    }
+
+    // What onLoad keeps: the arena tables and the caches over them
+    struct Plugin {
+        std::unique_ptr<SessionArena> arena = std::make_unique<SessionArena>();
+        ShotTable shotStats{ arena.get() };
+        ShotNames shotTypes{ arena.get() };
+        std::string sessionId;
+        bool sessionActive = false;
+        std::chrono::system_clock::time_point sessionStartTime;
+        SessionAggregates aggregates;
+        LiveMetrics metrics;
+        TrendGraph trend;
+        SessionTimeline timeline;
+        uint64_t version = 0;
+    };
+
+    struct Phases {
+        double read = 0, move = 0, retally = 0;
+        double Total() const { return read + move + retally; }
+    };
+
+    // Session::LoadSnapshot with the folder given, then Retally
+    bool WarmStart(const std::filesystem::path& folder, Plugin& p, Phases& t)
+    {
+        auto start = Clock::now();
+        std::string id;
+        std::ifstream current(folder / "current_session");
+        if (current.is_open()) std::getline(current, id);
+        if (id.empty()) return false;
+        SessionFileHandler snapshot;
+        if (!SessionJson::Read((folder / ("session_" + id + ".json")).string(), snapshot)) return false;
+        if (snapshot.meta.status != "active" || snapshot.meta.sessionId != id) return false;
+        p.sessionId = id;
+        p.sessionActive = true;
+        std::tm tm = {};
+        std::istringstream startTime(snapshot.meta.startTime);
+        startTime >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+        if (!startTime.fail()) {
+            tm.tm_isdst = -1;
+            p.sessionStartTime = std::chrono::system_clock::from_time_t(std::mktime(&tm));
+        }
+        t.read = Ms(start);
+
+        start = Clock::now();
+        SessionArena::Reset(p.shotStats, p.shotTypes);
+        p.shotStats = std::move(snapshot.table.shots);
+        p.shotTypes = std::move(snapshot.table.types);
+        p.version++;
+        t.move = Ms(start);
+
+        start = Clock::now();
+        p.aggregates.Rebuild(p.shotStats, p.shotTypes, p.version);
+        p.metrics.Rebuild(p.shotStats);
+        p.trend.Rebuild(p.shotStats);
+        p.timeline.Rebuild(p.shotStats);
+        t.retally = Ms(start);
+        return true;
+    }
+
+    void Save(const std::filesystem::path& folder, const std::string& id, bool active,
+        std::chrono::system_clock::time_point started, const ShotTable& shots, const ShotNames& names)
+    {
+        std::string text;
+        SessionJson::Write(text, false, id, active, started, shots, names, SessionTotals::Of(shots), LiveMetrics::Of(shots));
+        std::ofstream(folder / ("session_" + id + ".json"), std::ios::binary) << text;
+        std::ofstream(folder / "current_session", std::ios::binary) << id;
+    }
+}
+
+int main()
+{
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_bench_warm_start";
+    std::filesystem::remove_all(folder);
+    std::filesystem::create_directories(folder);
+    std::mt19937 rng(35);
+    const auto started = std::chrono::system_clock::from_time_t(
+        std::chrono::system_clock::to_time_t(std::chrono::system_clock::now() - std::chrono::minutes(40)));
+
+    for (int count : { 10, 50, 200 }) {
+        ShotTable shots;
+        ShotNames names;
+        uint32_t clock = 0;
+        for (int shot = 1; shot <= count; shot++) {
+            ShotStats& s = shots[shot];
+            for (int i = 0; i < ATTEMPTS; i++) {
+                bool goal = rng() % 3 == 0;
+                s.attemptHistory.push_back(goal);
+                s.attempts++;
+                s.goals += goal;
+                clock += 1000;
+                timing::Push(s.attemptTimes, { clock, clock + 200, clock + 900 });
+            }
+            names[shot] = "Shot type " + std::to_string(shot % 9);
+        }
+        const std::string id = "session_" + std::to_string(count);
+        Save(folder, id, true, started, shots, names);
+        size_t bytes = (size_t)std::filesystem::file_size(folder / ("session_" + id + ".json"));
+
+        Plugin p;
+        Phases best{ 1e30, 1e30, 1e30 }, t;
+        int reps = std::max(10, 2000 / count);
+        for (int r = 0; r < reps; r++) {
+            CHECK(WarmStart(folder, p, t));
+            if (t.Total() < best.Total()) best = t;
+        }
+
+        CHECK(p.sessionId == id && p.sessionActive && p.sessionStartTime == started);
+        CHECK(p.shotStats.size() == shots.size());
+        for (const auto& [num, s] : shots) {
+            const ShotStats& r = p.shotStats[num];
+            CHECK(r.attempts == s.attempts && r.goals == s.goals && r.attemptHistory == s.attemptHistory);
+            CHECK(r.Timed() == (size_t)ATTEMPTS);
+            CHECK(p.shotTypes[num] == names[num]);
+        }
+        CHECK(p.shotStats.get_allocator().resource() == p.arena.get());
+        CHECK(p.aggregates.Totals().all.attempts == count * ATTEMPTS);
+        CHECK(p.timeline.Size() == (size_t)(count * ATTEMPTS));
+
+        std::printf("  %3d shots (%4zu KB): %.3f ms before the first frame can draw: read %.3f, move in %.3f, retally %.3f\n",
+            count, bytes / 1024, best.Total(), best.read, best.move, best.retally);
+
+        // Ended: left for the server
+        Save(folder, id, false, started, shots, names);
+        Plugin ended;
+        CHECK(!WarmStart(folder, ended, t));
+        CHECK(ended.shotStats.empty());
+    }
+    std::filesystem::remove_all(folder);
+    std::printf("bench_warm_start: ok\n");
+    return 0;
+}
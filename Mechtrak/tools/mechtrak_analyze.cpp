@@ -0,0 +1,44 @@
+// Standalone analytics — same code path as the in-game analytics panel.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. mechtrak_analyze.cpp ../Analytics.cpp ../Importer.cpp -o mechtrak_analyze
+//   ./mechtrak_analyze <rl_best_stats dir> [threads]
+
+#include "Analytics.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <session dir> [threads]\n", argv[0]);
+        return 2;
+    }
+
+    std::filesystem::path folder = argv[1];
+    unsigned threads = argc > 2 ? (unsigned)std::atoi(argv[2]) : 0;
+
+    auto report = [](const ImportProgress& p) {
+        std::fprintf(stderr, "\r%zu/%zu files  %.0f files/s  %.1f MB/s   ",
+            p.filesDone, p.filesTotal, p.FilesPerSec(), p.MBPerSec());
+    };
+
+    AnalyticsReport r = Analytics::Run(folder, threads, report);
+    std::fprintf(stderr, "\n");
+    std::printf("%zu sessions (%zu skipped) on %u threads in %.3f s\n\n",
+        r.files - r.skipped, r.skipped, r.threads, r.elapsedSec);
+
+    std::printf("%-20s %8s %9s %6s %6s %6s %6s %7s %7s %7s %6s\n",
+        "type", "sessions", "attempts", "acc", "p10", "p50", "p90", "consist", "touch", "length", "/min");
+    for (const auto& t : r.types)
+        std::printf("%-20s %8d %9lld %5.1f%% %5.1f%% %5.1f%% %5.1f%% %7.0f %6.1fs %6.1fs %6.1f\n",
+            t.type.c_str(), t.sessions, (long long)t.attempts, t.Accuracy() * 100.f,
+            t.p10 * 100.f, t.p50 * 100.f, t.p90 * 100.f, t.consistency,
+            t.timing.TouchSec(), t.timing.AttemptSec(), t.timing.PerMinute());
+
+    for (const auto& t : r.types) {
+        std::printf("\n%s learning curve (attempts: accuracy)\n", t.type.c_str());
+        for (const auto& pt : t.curve) std::printf("  %7d: %5.1f%%\n", pt.practice, pt.accuracy * 100.f);
+    }
+    return 0;
+}
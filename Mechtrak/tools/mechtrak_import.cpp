@@ -0,0 +1,39 @@
+// Standalone bulk importer — same code path as the in-game stats_import command.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. mechtrak_import.cpp ../Importer.cpp -o mechtrak_import
+//   ./mechtrak_import <rl_best_stats dir> [out file] [threads]
+
+#include "Importer.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <session dir> [out file] [threads]\n", argv[0]);
+        return 2;
+    }
+
+    std::filesystem::path folder = argv[1];
+    std::filesystem::path out = argc > 2 ? std::filesystem::path(argv[2]) : folder / "history.mtk";
+    unsigned threads = argc > 3 ? (unsigned)std::atoi(argv[3]) : 0;
+
+    auto report = [](const ImportProgress& p) {
+        std::fprintf(stderr, "\r%zu/%zu files  %.0f files/s  %.1f MB/s   ",
+            p.filesDone, p.filesTotal, p.FilesPerSec(), p.MBPerSec());
+    };
+
+    ImportProgress result = Importer::Run(folder, out, threads, report);
+    std::fprintf(stderr, "\n");
+    std::printf("imported %zu sessions (%zu skipped), %.2f MB in %.3f s — %.0f files/s, %.1f MB/s\n",
+        result.filesDone - result.filesSkipped, result.filesSkipped,
+        result.bytesRead / (1024.0 * 1024.0), result.elapsedSec,
+        result.FilesPerSec(), result.MBPerSec());
+    if (!result.written) {
+        std::fprintf(stderr, "could not write %s\n", out.string().c_str());
+        return 1;
+    }
+    std::printf("wrote %s\n", out.string().c_str());
+    return 0;
+}
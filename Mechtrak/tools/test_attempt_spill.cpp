@@ -0,0 +1,127 @@
+// AttemptSpill write-behind: sealing and flips leave the disk alone until
+// Flush, sealed attempts read back the same before and after it, a journal
+// gone mostly dead through flips is compacted, and a Flush on another
+// thread can run while the table is sealed, flipped and read.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_attempt_spill.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_attempt_spill && ./test_attempt_spill
+
+#include "Check.h"
+#include "ShotStats.h"
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::filesystem::path spill;
+
+    // Journal files and their bytes
+    std::pair<size_t, uintmax_t> OnDisk()
+    {
+        size_t files = 0;
+        uintmax_t bytes = 0;
+        for (const auto& f : std::filesystem::directory_iterator(spill))
+            if (f.path().extension() == ".mtb") {
+                files++;
+                bytes += f.file_size();
+            }
+        return { files, bytes };
+    }
+
+    void Add(ShotStats& s, std::vector<bool>& want, bool goal, uint32_t t)
+    {
+        s.attemptHistory.push_back(goal);
+        timing::Push(s.attemptTimes, { t, t + 600, t + 5000 });
+        s.attempts++;
+        s.goals += goal;
+        want.push_back(goal);
+    }
+
+    void Same(const ShotStats& s, const std::vector<bool>& want)
+    {
+        CHECK(s.Count() == want.size());
+        for (size_t i = 0; i < want.size(); i++) CHECK(s.Outcome(i) == want[i]);
+    }
+}
+
+int main()
+{
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_test_attempt_spill";
+    std::filesystem::remove_all(folder);
+    AttemptSpill::Open(folder.string());
+    spill = folder / "spill";
+    AttemptSpill::SetBudget(4 * 1024);
+    std::mt19937 rng(49);
+
+    ShotTable shots;
+    std::vector<bool> want;
+    uint32_t t = 0;
+    for (int i = 0; i < 12 * (int)AttemptSpill::BLOCK; i++, t += 9000) Add(shots[1], want, rng() % 3 == 0, t);
+
+    // Sealing encodes in memory only
+    CHECK(AttemptSpill::Enforce(shots, "s1") > 0);
+    CHECK(shots[1].sealed.Blocks() > 0);
+    CHECK(AttemptSpill::Pending());
+    CHECK(OnDisk().first == 0);
+    Same(shots[1], want);
+    for (size_t i = 0; i < 3; i++) {
+        CHECK(shots[1].Flip(i) == want[i]);
+        want[i] = !want[i];
+    }
+    CHECK(OnDisk().first == 0);
+
+    // Written out, and read back from the file
+    AttemptSpill::Flush();
+    CHECK(!AttemptSpill::Pending());
+    auto [files, bytes] = OnDisk();
+    CHECK(files == 1 && bytes > 0);
+    Same(shots[1], want);
+    AttemptTime first = shots[1].Time(0);
+    CHECK(first.start == 0 && first.touch == 600 && first.end == 5000);
+
+    // Flips leave dead copies behind until they outweigh the live blocks
+    // and pass the slack; then the journal is rewritten with the live ones
+    uintmax_t most = 0;
+    for (int round = 0; round < 400; round++) {
+        size_t i = rng() % shots[1].sealed.Size();
+        CHECK(shots[1].Flip(i) == want[i]);
+        want[i] = !want[i];
+        AttemptSpill::Flush();
+        most = std::max(most, OnDisk().second);
+    }
+    CHECK(most > (1u << 20));
+    CHECK(OnDisk().first == 1 && OnDisk().second < most / 2);
+    Same(shots[1], want);
+
+    // A scheduler-side Flush alongside game-thread sealing, flips and reads
+    std::atomic<bool> done{ false };
+    std::thread flusher([&] {
+        while (!done) AttemptSpill::Flush();
+    });
+    for (int shot = 2; shot <= 4; shot++) {
+        std::vector<bool> more;
+        for (int i = 0; i < 6 * (int)AttemptSpill::BLOCK; i++, t += 9000) Add(shots[shot], more, rng() % 2 == 0, t);
+        AttemptSpill::Enforce(shots, "s1");
+        for (int k = 0; k < 50; k++) {
+            size_t i = rng() % shots[shot].Count();
+            CHECK(shots[shot].Flip(i) == more[i]);
+            more[i] = !more[i];
+        }
+        Same(shots[shot], more);
+    }
+    done = true;
+    flusher.join();
+    AttemptSpill::Flush();
+    Same(shots[1], want);
+
+    // Thawing drops every block; the journal goes with the last one
+    for (auto& [num, s] : shots) s.Thaw();
+    Same(shots[1], want);
+    CHECK(OnDisk().first == 0);
+
+    std::filesystem::remove_all(folder);
+    std::printf("test_attempt_spill: ok\n");
+    return 0;
+}
@@ -0,0 +1,205 @@
+// Round trips through the codecs generated from SessionSchema.h: random
+// ShotStats, SessionMeta and RollingStats go through the binary codec and
+// through JSON and must come back field for field. Every cut-short binary
+// encoding must fail to decode, and random bytes must not crash it. Ends
+// with a rough timing of the encode paths.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_codec.cpp ../JsonReader.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_codec && ./test_codec
+
+#include "Check.h"
+#include "SessionSchema.h"
+#include "JsonReader.h"
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    std::mt19937_64 rng(29);
+
+    int64_t Pick(int64_t lo, int64_t hi) { return std::uniform_int_distribution<int64_t>(lo, hi)(rng); }
+    float   PickFloat() { return std::uniform_real_distribution<float>(-1e6f, 1e6f)(rng); }
+
+    std::string PickString()
+    {
+        // Quotes, escapes, control characters and multi-byte UTF-8
+        static const char* parts[] = { "a", "Z", "0", " ", "\"", "\\", "/", "\n", "\t", "\x01", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x8E\xAF" };
+        std::string s;
+        for (int n = (int)Pick(0, 12); n > 0; n--) s += parts[Pick(0, std::size(parts) - 1)];
+        return s;
+    }
+
+    ShotStats PickShot()
+    {
+        ShotStats s;
+        size_t n = (size_t)Pick(0, 3000);
+        for (size_t i = 0; i < n; i++) s.attemptHistory.push_back(Pick(0, 2) == 0);
+        s.attempts = (int)n;
+        s.goals = (int)std::count(s.attemptHistory.begin(), s.attemptHistory.end(), true);
+        // Mostly increasing milliseconds, with the odd step back
+        uint32_t t = (uint32_t)Pick(0, 1u << 31);
+        for (size_t i = (size_t)Pick(0, (int64_t)n); i > 0; i--)
+            for (int k = 0; k < 3; k++) {
+                t += (uint32_t)Pick(-2000, 20000);
+                s.attemptTimes.push_back(t);
+            }
+        return s;
+    }
+
+    SessionMeta PickMeta()
+    {
+        SessionMeta m;
+        m.sessionId = PickString();
+        m.status = PickString();
+        m.startTime = PickString();
+        m.lastUpdated = PickString();
+        m.durationMinutes = Pick(INT64_MIN, INT64_MAX);
+        m.totalAttempts = (int)Pick(INT32_MIN, INT32_MAX);
+        m.totalGoals = (int)Pick(INT32_MIN, INT32_MAX);
+        m.totalShots = Pick(INT64_MIN, INT64_MAX);
+        m.bestShotPct = PickFloat();
+        m.attemptsPerMinute = PickFloat();
+        m.avgTouchSec = PickFloat();
+        m.avgAttemptSec = PickFloat();
+        return m;
+    }
+
+    RollingStats PickRolling()
+    {
+        RollingStats r;
+        r.last10 = PickFloat();
+        r.last25 = PickFloat();
+        r.last50 = PickFloat();
+        r.streak = (int)Pick(INT32_MIN, INT32_MAX);
+        r.bestStreak = (int)Pick(INT32_MIN, INT32_MAX);
+        r.ewma = PickFloat();
+        r.wilsonLow = PickFloat();
+        r.wilsonHigh = PickFloat();
+        r.dropped = Pick(0, 1) == 1;
+        r.dropFrom = PickFloat();
+        r.dropTo = PickFloat();
+        r.dropLength = (int)Pick(INT32_MIN, INT32_MAX);
+        return r;
+    }
+
+    // Every Member field equal; Computed ones are write-only
+    template<typename T>
+    bool Same(const T& a, const T& b)
+    {
+        bool same = true;
+        codec::ForEachField<T>([&](const auto& f) {
+            if constexpr (codec::IsMember<std::decay_t<decltype(f)>>::value) same = same && a.*(f.ptr) == b.*(f.ptr);
+        });
+        return same;
+    }
+
+    // One flat object into obj through FieldReader, as Session.cpp reads them
+    template<typename T>
+    struct Into : JsonHandler {
+        T& obj;
+        codec::FieldReader<T> reader;
+        explicit Into(T& obj) : obj(obj) {}
+        bool Key(std::string_view k) override       { reader.Key(k); return true; }
+        bool StartArray() override                  { reader.BeginArray(obj); return true; }
+        bool EndArray() override                    { reader.EndArray(); return true; }
+        bool Int(int64_t v) override                { reader.Int(obj, v); return true; }
+        bool Float(double v) override               { reader.Float(obj, v); return true; }
+        bool Bool(bool v) override                  { reader.Bool(obj, v); return true; }
+        bool String(std::string_view v) override    { reader.String(obj, v); return true; }
+    };
+
+    template<typename T>
+    void RoundTrip(const T& value)
+    {
+        std::string bin;
+        codec::Encode(bin, value);
+        T back;
+        size_t pos = 0;
+        CHECK(codec::Decode(std::string_view(bin), pos, back));
+        CHECK(pos == bin.size());
+        CHECK(Same(value, back));
+
+        std::string json;
+        JsonWriter w(json);
+        codec::WriteJson(w, value);
+        T read;
+        Into<T> into(read);
+        JsonStreamParser parser(into);
+        CHECK(parser.Feed(json) && parser.Finish());
+        CHECK(Same(value, read));
+    }
+
+    template<typename T>
+    void Truncated(const T& value)
+    {
+        std::string bin;
+        codec::Encode(bin, value);
+        for (size_t len = 0; len < bin.size(); len++) {
+            T back;
+            size_t pos = 0;
+            CHECK(!codec::Decode(std::string_view(bin.data(), len), pos, back));
+        }
+    }
+
+    template<typename Fn>
+    double MicrosEach(int reps, Fn&& fn)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < reps; i++) fn();
+        std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - start;
+        return took.count() / reps;
+    }
+}
+
+int main()
+{
+    for (int i = 0; i < 300; i++) {
+        RoundTrip(PickShot());
+        RoundTrip(PickMeta());
+        RoundTrip(PickRolling());
+    }
+
+    for (int i = 0; i < 20; i++) {
+        ShotStats small;
+        small.attemptHistory = { true, false, true };
+        small.attempts = 3;
+        small.goals = 2;
+        small.attemptTimes = { 5, 9, 12 };
+        Truncated(small);
+        Truncated(PickMeta());
+        Truncated(PickRolling());
+    }
+
+    // Garbage may fail but must stay inside the buffer
+    for (int i = 0; i < 20000; i++) {
+        std::string junk((size_t)Pick(0, 64), '\0');
+        for (char& c : junk) c = (char)Pick(0, 255);
+        ShotStats s;
+        SessionMeta m;
+        size_t pos = 0;
+        codec::Decode(std::string_view(junk), pos, s);
+        CHECK(pos <= junk.size());
+        pos = 0;
+        codec::Decode(std::string_view(junk), pos, m);
+        CHECK(pos <= junk.size());
+    }
+
+    // A long shot: 2048 timed attempts
+    ShotStats shot;
+    for (int i = 0; i < 2048; i++) {
+        shot.attemptHistory.push_back(i % 3 == 0);
+        shot.attemptTimes.insert(shot.attemptTimes.end(), { (uint32_t)i * 9000, (uint32_t)i * 9000 + 1500, (uint32_t)i * 9000 + 6000 });
+    }
+    shot.attempts = 2048;
+    shot.goals = (int)std::count(shot.attemptHistory.begin(), shot.attemptHistory.end(), true);
+    std::string bin, json;
+    double encode = MicrosEach(2000, [&] { bin.clear(); codec::Encode(bin, shot); });
+    double decode = MicrosEach(2000, [&] { ShotStats s; size_t pos = 0; codec::Decode(std::string_view(bin), pos, s); });
+    double write = MicrosEach(200, [&] { json.clear(); JsonWriter w(json); codec::WriteJson(w, shot); });
+    std::printf("  2048-attempt shot: binary %zu bytes, encode %.1f us, decode %.1f us; json %zu bytes, write %.1f us\n",
+        bin.size(), encode, decode, json.size(), write);
+
+    std::printf("test_codec: ok\n");
+    return 0;
+}
@@ -0,0 +1,125 @@
+// DropDetector on synthetic streams from fixed seeds: how often a steady
+// stream is flagged, how long a known drop takes to flag and how close the
+// estimated change point lands, how rarely a drop goes unflagged, and how
+// often the flag clears once play recovers. Prints the figures it checks.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_drop_detector.cpp ../DropDetector.cpp -o test_drop_detector && ./test_drop_detector
+
+#include "Check.h"
+#include "DropDetector.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const int RUNS = 2000;
+    const int LENGTH = 500;
+    const int CHANGE = 150;
+
+    struct Outcome {
+        double flagged = 0;          // share of runs flagged before the change, or at all if none
+        double missed = 0;           // share of runs with a change never flagged after it
+        int    medianDelay = 0;      // attempts from the change to the first flag after it
+        int    medianBias = 0;       // estimated change point - CHANGE at that flag
+        int    medianError = 0;      // and its size
+        double cleared = 0;          // share of flagged runs not flagged at the end
+    };
+
+    int Median(std::vector<int> v)
+    {
+        if (v.empty()) return -1;
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    }
+
+    // RUNS streams of LENGTH attempts: rate before until CHANGE, after until
+    // CHANGE + lasts, then before again
+    Outcome Simulate(uint32_t seed, double before, double after, int lasts = LENGTH)
+    {
+        std::mt19937 rng(seed);
+        std::bernoulli_distribution early(before), late(after);
+        bool changes = before != after;
+        int earlyFlags = 0, missed = 0, flaggedEver = 0, clearedAtEnd = 0;
+        std::vector<int> delays, errors, misses;
+        for (int run = 0; run < RUNS; run++) {
+            DropDetector d;
+            bool falseAlarm = false, found = false, ever = false;
+            for (int i = 0; i < LENGTH; i++) {
+                bool slump = changes && i >= CHANGE && i < CHANGE + lasts;
+                d.Add(slump ? late(rng) : early(rng));
+                if (!d.Dropped()) continue;
+                ever = true;
+                if (!changes || i < CHANGE) falseAlarm = true;
+                else if (!found) {
+                    found = true;
+                    delays.push_back(i - CHANGE);
+                    errors.push_back(i - d.Length() + 1 - CHANGE);
+                    misses.push_back(std::abs(errors.back()));
+                }
+            }
+            earlyFlags += falseAlarm;
+            missed += changes && !found;
+            flaggedEver += ever;
+            clearedAtEnd += ever && !d.Dropped();
+        }
+        Outcome o;
+        o.flagged = (double)earlyFlags / RUNS;
+        o.missed = (double)missed / RUNS;
+        o.medianDelay = Median(delays);
+        o.medianBias = Median(errors);
+        o.medianError = Median(misses);
+        o.cleared = flaggedEver ? (double)clearedAtEnd / flaggedEver : 0.0;
+        return o;
+    }
+}
+
+int main()
+{
+    // Steady play at several skill levels: flagged rarely over a long run
+    for (double p : { 0.2, 0.5, 0.8 }) {
+        Outcome o = Simulate(41 + (uint32_t)(p * 10), p, p);
+        std::printf("  steady %.2f: flagged in %.1f%% of %d-attempt runs\n", p, 100.0 * o.flagged, LENGTH);
+        CHECK(o.flagged < 0.10);
+    }
+
+    // Known drops at attempt 150
+    struct Drop { double before, after; };
+    for (Drop drop : { Drop{ 0.50, 0.25 }, Drop{ 0.80, 0.57 } }) {
+        Outcome o = Simulate(4141, drop.before, drop.after);
+        std::printf("  %.2f -> %.2f: median delay %d attempts, change point off by %+d (%d either way), missed %.1f%%, "
+            "flagged before the drop %.1f%%\n",
+            drop.before, drop.after, o.medianDelay, o.medianBias, o.medianError, 100.0 * o.missed, 100.0 * o.flagged);
+        CHECK(o.medianDelay >= 0 && o.medianDelay <= 60);
+        CHECK(std::abs(o.medianBias) <= 2);
+        CHECK(o.medianError <= 10);
+        CHECK(o.missed < 0.03);
+        CHECK(o.flagged < 0.05);
+    }
+
+    // A 100-attempt slump, then back to form: the flag clears
+    Outcome recovered = Simulate(414141, 0.50, 0.25, 100);
+    std::printf("  0.50 -> 0.25 for 100 attempts, then back: cleared by the end in %.1f%% of flagged runs\n",
+        100.0 * recovered.cleared);
+    CHECK(recovered.cleared > 0.90);
+
+    // Cost of one update
+    std::mt19937 rng(7);
+    std::vector<char> stream(1 << 20);
+    for (auto& g : stream) g = rng() % 2;
+    DropDetector d;
+    int flags = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (char g : stream) {
+        d.Add(g);
+        flags += d.Dropped();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / stream.size();
+    std::printf("  Add: %.1f ns (%d flagged)\n", ns, flags);
+
+    std::printf("test_drop_detector: ok\n");
+    return 0;
+}
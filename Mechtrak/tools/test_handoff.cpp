@@ -0,0 +1,174 @@
+// Reload handoff: a RuntimeState written by one load comes back whole in
+// the next, including attempts that had been sealed to disk, and a blob
+// that is from another version, cut short, too old or for another session
+// is turned down (and deleted either way).
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_handoff.cpp ../Handoff.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_handoff && ./test_handoff
+
+#include "Check.h"
+#include "Handoff.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+namespace
+{
+    int64_t NowMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    RuntimeState Sample(std::mt19937& rng, size_t attempts)
+    {
+        RuntimeState s;
+        s.savedAtMs = NowMs();
+        s.sessionId = "65f0c2a1b3";
+        s.sessionActive = true;
+        s.sessionStartMs = s.savedAtMs - 3600000;
+        s.currentShotNumber = 7;
+        s.roundActive = true;
+        s.justRecordedAttempt = true;
+        s.roundStartMs = 3500000;
+        s.firstTouchMs = 3501200;
+        s.lastKnownScore = 42;
+        s.lastGoalAgoMs = 850;
+        s.showEditPanel = true;
+        for (int shot = 1; shot <= 8; shot++) {
+            ShotStats& st = s.shotStats[shot];
+            uint32_t t = 1000;
+            for (size_t i = 0; i < attempts; i++) {
+                bool goal = rng() % 3 == 0;
+                st.attemptHistory.push_back(goal);
+                st.attempts++;
+                st.goals += goal;
+                if (shot % 2 == 0) {
+                    timing::Push(st.attemptTimes, { t, t + 700, t + 4000 });
+                    t += 9000;
+                }
+            }
+            s.shotTypes[shot] = shot == 3 ? "Ceiling shot \xE2\x80\x94 \"left\"" : "Shot " + std::to_string(shot);
+        }
+        return s;
+    }
+
+    bool Same(const RuntimeState& a, const RuntimeState& b)
+    {
+        if (a.shotStats.size() != b.shotStats.size()) return false;
+        for (const auto& [num, s] : a.shotStats) {
+            auto it = b.shotStats.find(num);
+            if (it == b.shotStats.end()) return false;
+            const ShotStats& t = it->second;
+            if (s.attempts != t.attempts || s.goals != t.goals || s.Count() != t.Count() || s.Timed() != t.Timed()) return false;
+            for (size_t i = 0; i < s.Count(); i++)
+                if (s.Outcome(i) != t.Outcome(i)) return false;
+            for (size_t i = s.Count() - s.Timed(); i < s.Count(); i++) {
+                AttemptTime x = s.Time(i), y = t.Time(i);
+                if (x.start != y.start || x.touch != y.touch || x.end != y.end) return false;
+            }
+        }
+        return a.savedAtMs == b.savedAtMs && a.sessionId == b.sessionId && a.sessionActive == b.sessionActive
+            && a.sessionStartMs == b.sessionStartMs && a.currentShotNumber == b.currentShotNumber
+            && a.roundActive == b.roundActive && a.justRecordedAttempt == b.justRecordedAttempt
+            && a.roundStartMs == b.roundStartMs && a.firstTouchMs == b.firstTouchMs
+            && a.lastKnownScore == b.lastKnownScore && a.lastGoalAgoMs == b.lastGoalAgoMs
+            && a.showEditPanel == b.showEditPanel && a.shotTypes == b.shotTypes;
+    }
+
+    void WriteRaw(const std::string& path, const std::string& blob)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(blob.data(), (std::streamsize)blob.size());
+    }
+}
+
+int main()
+{
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_test_handoff";
+    std::filesystem::remove_all(folder);
+    const std::string path = (folder / "handoff.mtk").string();
+    std::mt19937 rng(36);
+
+    // Round trip, single use
+    RuntimeState state = Sample(rng, 300);
+    CHECK(Handoff::Write(path, state));
+    RuntimeState back;
+    CHECK(Handoff::Take(path, state.sessionId, back) == Handoff::Result::Restored);
+    CHECK(Same(state, back));
+    CHECK(!std::filesystem::exists(path));
+    CHECK(Handoff::Take(path, state.sessionId, back) == Handoff::Result::Missing);
+
+    // Sealed attempts are thawed before the write, as SaveHandoff does, so
+    // the blob holds every attempt
+    {
+        AttemptSpill::Open(folder.string());
+        AttemptSpill::SetBudget(1024);
+        RuntimeState big = Sample(rng, 3000);
+        RuntimeState want = big;
+        CHECK(AttemptSpill::Enforce(big.shotStats, big.sessionId) > 0);
+        CHECK(AttemptSpill::Measure(big.shotStats).sealedAttempts > 0);
+        CHECK(Same(big, want));
+        for (auto& [num, s] : big.shotStats) s.Thaw();
+        CHECK(Handoff::Write(path, big));
+        RuntimeState got;
+        CHECK(Handoff::Take(path, big.sessionId, got) == Handoff::Result::Restored);
+        CHECK(Same(got, want));
+        CHECK(AttemptSpill::Measure(got.shotStats).sealedAttempts == 0);
+    }
+
+    std::string blob;
+    Handoff::Encode(blob, state);
+    RuntimeState untouched;
+
+    // Another version of the plugin wrote it
+    std::string other = blob;
+    other[4] = (char)(Handoff::VERSION + 1);
+    CHECK(Handoff::Decode(other, untouched) == Handoff::Result::VersionMismatch);
+    WriteRaw(path, other);
+    CHECK(Handoff::Take(path, state.sessionId, untouched) == Handoff::Result::VersionMismatch);
+    CHECK(!std::filesystem::exists(path));
+
+    // Not a handoff, cut short anywhere, or with bytes left over
+    CHECK(Handoff::Decode("", untouched) == Handoff::Result::BadHeader);
+    CHECK(Handoff::Decode("MTK", untouched) == Handoff::Result::BadHeader);
+    CHECK(Handoff::Decode("MTKS\x02", untouched) == Handoff::Result::BadHeader);
+    for (size_t len = 5; len < blob.size(); len += 1 + len / 64)
+        CHECK(Handoff::Decode(std::string_view(blob.data(), len), untouched) == Handoff::Result::Corrupt);
+    CHECK(Handoff::Decode(blob + "x", untouched) == Handoff::Result::Corrupt);
+    CHECK(untouched.shotStats.empty() && untouched.sessionId.empty());
+
+    // Too old, or from a clock that has since gone back
+    RuntimeState old = state;
+    old.savedAtMs = NowMs() - 6 * 60 * 1000;
+    CHECK(Handoff::Write(path, old));
+    CHECK(Handoff::Take(path, state.sessionId, untouched) == Handoff::Result::Stale);
+    old.savedAtMs = NowMs() + 60 * 1000;
+    CHECK(Handoff::Write(path, old));
+    CHECK(Handoff::Take(path, state.sessionId, untouched) == Handoff::Result::Stale);
+
+    // An active session must be the one the server says is current; with
+    // none active the id does not matter
+    CHECK(Handoff::Write(path, state));
+    CHECK(Handoff::Take(path, "someone-else", untouched) == Handoff::Result::OtherSession);
+    CHECK(untouched.shotStats.empty());
+    RuntimeState idle = state;
+    idle.sessionActive = false;
+    CHECK(Handoff::Write(path, idle));
+    CHECK(Handoff::Take(path, "", back) == Handoff::Result::Restored);
+    CHECK(Same(idle, back));
+
+    // What a reload costs: decoding a session of 8 x 3000 attempts
+    RuntimeState big = Sample(rng, 3000);
+    Handoff::Encode(blob, big);
+    auto start = std::chrono::steady_clock::now();
+    const int reps = 50;
+    for (int i = 0; i < reps; i++) CHECK(Handoff::Decode(blob, back) == Handoff::Result::Restored);
+    std::chrono::duration<double, std::micro> took = std::chrono::steady_clock::now() - start;
+    std::printf("  %zu-byte handoff decodes in %.0f us\n", blob.size(), took.count() / reps);
+
+    std::filesystem::remove_all(folder);
+    std::printf("test_handoff: ok\n");
+    return 0;
+}
@@ -0,0 +1,234 @@
+// HistoryKernels: the AVX2 and scalar paths agree bit for bit with each
+// other and with plain loops over random histories, and TrendGraph gives
+// the same curve whether it grows attempt by attempt or is rebuilt through
+// WindowAccuracy. Then attempts/ns for the rolling window against the loop
+// TrendGraph used to rebuild with, and for a whole rebuild.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_history_kernels.cpp ../HistoryKernels.cpp ../TrendGraph.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_history_kernels && ./test_history_kernels
+
+#include "Check.h"
+#include "HistoryKernels.h"
+#include "TrendGraph.h"
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    std::vector<bool> Random(std::mt19937& rng, size_t n, int goalPercent)
+    {
+        std::vector<bool> h(n);
+        for (size_t i = 0; i < n; i++) h[i] = (int)(rng() % 100) < goalPercent;
+        return h;
+    }
+
+    // Everything the kernels answer for one history, on the current path
+    struct Answers {
+        std::vector<std::vector<float>> windows;
+        std::vector<std::vector<float>> blocks;
+        std::vector<size_t> goals;
+        std::vector<HistoryKernels::Run> runs;
+        int longest = 0;
+    };
+
+    const int WINDOWS[] = { 1, 5, 10, 37 };
+    const int BLOCKS[] = { 1, 10, 64, 1000 };
+
+    Answers Ask(const PackedHistory& h, const std::vector<std::pair<size_t, size_t>>& ranges)
+    {
+        Answers a;
+        for (int w : WINDOWS) {
+            a.windows.emplace_back(h.Size());
+            HistoryKernels::WindowAccuracy(h, w, a.windows.back().data());
+        }
+        for (int b : BLOCKS) {
+            a.blocks.emplace_back((h.Size() + b - 1) / b);
+            HistoryKernels::BlockAccuracy(h, b, a.blocks.back().data());
+        }
+        for (auto [from, to] : ranges) a.goals.push_back(HistoryKernels::Goals(h, from, to));
+        HistoryKernels::GoalRuns(h, a.runs);
+        a.longest = HistoryKernels::LongestRun(h);
+        return a;
+    }
+
+    // The same questions as plain loops, with the kernels' rounding
+    Answers Naive(const std::vector<bool>& h, const std::vector<std::pair<size_t, size_t>>& ranges)
+    {
+        Answers a;
+        size_t n = h.size();
+        for (int w : WINDOWS) {
+            std::vector<float> out(n);
+            for (size_t i = 0; i < n; i++) {
+                size_t from = i + 1 >= (size_t)w ? i + 1 - w : 0;
+                int g = 0;
+                for (size_t j = from; j <= i; j++) g += h[j];
+                out[i] = i + 1 >= (size_t)w ? (float)g * (1.f / (float)w) : (float)g / (float)(i + 1);
+            }
+            a.windows.push_back(std::move(out));
+        }
+        for (int b : BLOCKS) {
+            std::vector<float> out;
+            for (size_t k = 0; k * b < n; k++) {
+                size_t to = std::min(n, (k + 1) * b);
+                int g = 0;
+                for (size_t j = k * b; j < to; j++) g += h[j];
+                out.push_back(to - k * b == (size_t)b ? (float)g * (1.f / (float)b) : (float)g / (float)(to - k * b));
+            }
+            a.blocks.push_back(std::move(out));
+        }
+        for (auto [from, to] : ranges) {
+            size_t g = 0;
+            for (size_t j = from; j < std::min(to, n); j++) g += h[j];
+            a.goals.push_back(g);
+        }
+        for (size_t i = 0; i < n;) {
+            if (!h[i]) { i++; continue; }
+            size_t start = i;
+            while (i < n && h[i]) i++;
+            a.runs.push_back({ (uint32_t)start, (uint32_t)(i - start) });
+            a.longest = std::max(a.longest, (int)(i - start));
+        }
+        return a;
+    }
+
+    bool SameFloats(const std::vector<float>& a, const std::vector<float>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+    }
+
+    void Same(const Answers& a, const Answers& b)
+    {
+        CHECK(a.windows.size() == b.windows.size() && a.blocks.size() == b.blocks.size());
+        for (size_t k = 0; k < a.windows.size(); k++) CHECK(SameFloats(a.windows[k], b.windows[k]));
+        for (size_t k = 0; k < a.blocks.size(); k++) CHECK(SameFloats(a.blocks[k], b.blocks[k]));
+        CHECK(a.goals == b.goals);
+        CHECK(a.runs.size() == b.runs.size());
+        for (size_t k = 0; k < a.runs.size(); k++)
+            CHECK(a.runs[k].start == b.runs[k].start && a.runs[k].length == b.runs[k].length);
+        CHECK(a.longest == b.longest);
+    }
+
+    // Attempts per ns over reps runs of fn on n attempts, best run
+    template<typename Fn>
+    double Rate(size_t n, int reps, Fn&& fn)
+    {
+        double best = 1e30;
+        for (int r = 0; r < reps; r++) {
+            auto start = Clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+        }
+        return (double)n / best;
+    }
+
+    volatile float sink;
+}
+
+int main()
+{
+    HistoryKernels::ForceScalar(false);
+    const std::string backend = HistoryKernels::Backend();
+    std::mt19937 rng(44);
+
+    // Both paths against the loops, over sizes around every word and
+    // vector boundary and random ones
+    std::vector<size_t> sizes = { 0, 1, 2, 7, 8, 9, 63, 64, 65, 127, 128, 129, 255, 256, 257, 1000, 4096 };
+    for (int i = 0; i < 400; i++) sizes.push_back(rng() % 5000);
+    for (size_t n : sizes) {
+        auto history = Random(rng, n, (int)(rng() % 101));
+        PackedHistory packed(history);
+        CHECK(packed.Size() == n);
+        // Sealed attempts pushed one by one, then the hot ones in bulk
+        PackedHistory split;
+        size_t cut = n ? rng() % (n + 1) : 0;
+        for (size_t i = 0; i < cut; i++) split.Push(history[i]);
+        split.Append(std::vector<bool>(history.begin() + (long)cut, history.end()));
+        CHECK(split.Size() == n && split.Words() == packed.Words());
+        std::vector<std::pair<size_t, size_t>> ranges;
+        for (int k = 0; k < 20; k++) {
+            size_t a = n ? rng() % (n + 1) : 0, b = n ? rng() % (n + 1) : 0;
+            ranges.push_back({ std::min(a, b), std::max(a, b) + k % 3 });
+        }
+        Answers want = Naive(history, ranges);
+        HistoryKernels::ForceScalar(true);
+        Same(Ask(packed, ranges), want);
+        HistoryKernels::ForceScalar(false);
+        Same(Ask(packed, ranges), want);
+    }
+
+    // TrendGraph: grown attempt by attempt, then rebuilt through the kernel
+    ShotTable shots;
+    TrendGraph trend;
+    auto history = Random(rng, 3000, 45);
+    for (size_t i = 0; i < history.size(); i++) {
+        ShotStats& s = shots[1];
+        s.attemptHistory.push_back(history[i]);
+        s.attempts++;
+        s.goals += history[i];
+        ShotEvent e;
+        e.kind = ShotEvent::Kind::Attempt;
+        e.shot = 1;
+        e.goal = history[i];
+        trend.Apply(e, shots);
+    }
+    std::vector<TrendGraph::Point> grown = trend.Points(1);
+    CHECK(grown.size() == (size_t)TrendGraph::BUDGET);
+    trend.Rebuild(shots);
+    const auto& rebuilt = trend.Points(1);
+    CHECK(rebuilt.size() == grown.size());
+    for (size_t i = 0; i < grown.size(); i++) CHECK(rebuilt[i].x == grown[i].x && rebuilt[i].y == grown[i].y);
+
+    // Rolling window of TrendGraph::WINDOW over a 100k-attempt shot: the
+    // per-attempt rescan through Outcome() that TrendGraph rebuilt with
+    // before, against packing the shot as Reset does plus the kernel
+    const size_t N = 100000;
+    const int W = TrendGraph::WINDOW;
+    auto big = Random(rng, N, 45);
+    ShotTable one;
+    ShotStats& s = one[1];
+    for (size_t i = 0; i < N; i++) {
+        s.attemptHistory.push_back(big[i]);
+        s.attempts++;
+    }
+    std::vector<float> out(N);
+    double loop = Rate(N, 20, [&] {
+        for (size_t i = 0; i < N; i++) {
+            size_t from = i + 1 >= (size_t)W ? i + 1 - W : 0;
+            int g = 0;
+            for (size_t j = from; j <= i; j++) g += s.Outcome(j);
+            out[i] = (float)g / (float)(i + 1 - from);
+        }
+        sink = out[N - 1];
+    });
+    PackedHistory packed;
+    double pack = Rate(N, 20, [&] {
+        packed = PackedHistory();
+        packed.Append(s.attemptHistory);
+    });
+    double kernel[2];
+    for (int scalar = 1; scalar >= 0; scalar--) {
+        HistoryKernels::ForceScalar(scalar);
+        kernel[scalar] = Rate(N, 20, [&] {
+            HistoryKernels::WindowAccuracy(packed, W, out.data());
+            sink = out[N - 1];
+        });
+    }
+    HistoryKernels::ForceScalar(false);
+    auto both = [pack](double k) { return 1.0 / (1.0 / pack + 1.0 / k); };
+
+    // A whole TrendGraph rebuild of the shot, bins and LTTB included
+    TrendGraph graph;
+    double rebuild = Rate(N, 10, [&] { graph.Rebuild(one); });
+    CHECK(graph.Points(1).size() == (size_t)TrendGraph::BUDGET);
+
+    std::printf("  window %d over %zu attempts, attempts/ns: old loop %.2f; packing %.2f, then scalar %.2f, %s %.2f "
+        "(%.2f and %.2f with packing)\n",
+        W, N, loop, pack, kernel[1], backend.c_str(), kernel[0], both(kernel[1]), both(kernel[0]));
+    std::printf("  TrendGraph rebuild of %zu attempts: %.2f attempts/ns\n", N, rebuild);
+    std::printf("test_history_kernels: ok (%zu histories, %s)\n", sizes.size(), backend.c_str());
+    return 0;
+}
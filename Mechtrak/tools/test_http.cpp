@@ -0,0 +1,243 @@
+// Http over the loopback backend: bodies round-trip whole or through
+// onChunk, many slow requests overlap instead of queueing, a timeout or a
+// Cancel completes its request once while the others carry on, Stop cancels
+// what is in flight and refuses what comes after until Start, a refused
+// connection reports Network, and SendScheduled completes on the scheduler.
+// The server below answers on 127.0.0.1 at a port picked before main.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_http.cpp ../HttpLoopback.cpp ../Scheduler.cpp -o test_http && ./test_http
+
+#include "Check.h"
+#include "Http.h"
+#include "Config.h"
+#include "Scheduler.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+using Clock = steady_clock;
+using Error = HttpResponse::Error;
+
+namespace
+{
+    int listener = -1;
+
+    int Listen()
+    {
+        listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(listener, (sockaddr*)&addr, sizeof(addr));
+        listen(listener, 128);
+        socklen_t len = sizeof(addr);
+        getsockname(listener, (sockaddr*)&addr, &len);
+        return ntohs(addr.sin_port);
+    }
+}
+
+const std::wstring SERVER_HOST = L"127.0.0.1";
+const int SERVER_PORT = Listen();
+
+namespace
+{
+    const size_t BIG = 3 * 1024 * 1024;
+
+    std::atomic<bool> serving{ true };
+    std::mutex        threadsMtx;
+    std::vector<std::thread> threads;
+
+    void Reply(int fd, int status, const std::string& body, bool length = true)
+    {
+        std::string out = "HTTP/1.0 " + std::to_string(status) + " X\r\n";
+        if (length) out += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+        out += "\r\n" + body;
+        for (size_t at = 0; at < out.size();) {
+            ssize_t n = send(fd, out.data() + at, out.size() - at, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            at += (size_t)n;
+        }
+    }
+
+    // One request: the path picks the answer
+    void Serve(int fd)
+    {
+        std::string in;
+        char buf[4096];
+        size_t end;
+        while ((end = in.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) { close(fd); return; }
+            in.append(buf, (size_t)n);
+        }
+        size_t at = in.find("Content-Length: ");
+        size_t want = at == std::string::npos ? 0 : std::stoul(in.substr(at + 16));
+        while (in.size() < end + 4 + want) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) { close(fd); return; }
+            in.append(buf, (size_t)n);
+        }
+        std::string path = in.substr(in.find(' ') + 1, in.find(' ', in.find(' ') + 1) - in.find(' ') - 1);
+        std::string body = in.substr(end + 4, want);
+
+        if (path == "/echo") Reply(fd, 200, body);
+        else if (path == "/big") Reply(fd, 200, std::string(BIG, 'b'));
+        else if (path == "/close") Reply(fd, 200, "until close", false);
+        else if (path == "/slow") {
+            std::this_thread::sleep_for(milliseconds(200));
+            Reply(fd, 200, "slow");
+        }
+        else if (path == "/hang") {
+            // Until the client gives up
+            pollfd p{ fd, POLLIN, 0 };
+            while (serving && poll(&p, 1, 20) == 0) {}
+        }
+        else Reply(fd, 404, "");
+        close(fd);
+    }
+
+    void Accept()
+    {
+        for (;;) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) return;
+            std::lock_guard<std::mutex> lock(threadsMtx);
+            threads.emplace_back(Serve, fd);
+        }
+    }
+
+    HttpRequest Get(const char* path, milliseconds timeout = milliseconds(5000))
+    {
+        HttpRequest r;
+        r.path = std::wstring(path, path + std::strlen(path));
+        r.timeout = timeout;
+        return r;
+    }
+
+    HttpResponse Fetch(HttpRequest request)
+    {
+        auto result = std::make_shared<std::promise<HttpResponse>>();
+        auto response = result->get_future();
+        Http::Send(std::move(request), [result](HttpResponse&& r) { result->set_value(std::move(r)); });
+        return response.get();
+    }
+}
+
+int main()
+{
+    std::thread acceptor(Accept);
+
+    // Refused until started
+    Error before = Error::None;
+    CHECK(Http::Send(Get("/echo"), [&](HttpResponse&& r) { before = r.error; }) == 0);
+    CHECK(before == Error::Refused);
+
+    Scheduler::Start();
+    Http::Start();
+
+    HttpRequest post = Get("/echo");
+    post.method = L"POST";
+    post.headers = L"Content-Type: application/json\r\n";
+    post.body = "{\"shots\":[1,2,3]}";
+    HttpResponse echoed = Fetch(post);
+    CHECK(echoed.Answered() && echoed.status == 200 && echoed.body == post.body);
+
+    HttpResponse missing = Fetch(Get("/nope"));
+    CHECK(missing.Answered() && missing.status == 404 && missing.body.empty());
+
+    HttpResponse closed = Fetch(Get("/close"));
+    CHECK(closed.Answered() && closed.body == "until close");
+
+    // Streamed: the body goes to onChunk and is not kept
+    size_t streamed = 0;
+    int chunks = 0;
+    HttpRequest big = Get("/big");
+    big.onChunk = [&](std::string_view chunk) {
+        streamed += chunk.size();
+        chunks++;
+    };
+    HttpResponse whole = Fetch(big);
+    CHECK(whole.Answered() && whole.status == 200 && whole.body.empty());
+    CHECK(streamed == BIG && chunks > 1);
+
+    // Overlapped: all of them in about one server delay, completed on the
+    // scheduler, which keeps running its own timers meanwhile
+    const int MANY = 40;
+    std::atomic<int> answered{ 0 }, onScheduler{ 0 }, ticks{ 0 };
+    Scheduler::TimerId ticker = Scheduler::Every(milliseconds(20), [&] { ticks++; });
+    auto start = Clock::now();
+    for (int i = 0; i < MANY; i++)
+        CHECK(Http::SendScheduled(Get("/slow"), [&](HttpResponse&& r) {
+            onScheduler += Scheduler::OnSchedulerThread();
+            answered += r.Answered() && r.body == "slow";
+        }) != 0);
+    while (answered < MANY && Clock::now() - start < seconds(5)) std::this_thread::sleep_for(milliseconds(2));
+    auto took = duration_cast<milliseconds>(Clock::now() - start);
+    CHECK(answered == MANY && onScheduler == MANY);
+    CHECK(took < milliseconds(200 * 4));
+    CHECK(ticks >= 5);
+    Scheduler::Cancel(ticker);
+    std::printf("  %d requests to a 200 ms server: %lld ms\n", MANY, (long long)took.count());
+
+    // A timeout ends its own request only
+    std::atomic<int> timedOut{ 0 };
+    start = Clock::now();
+    Http::Send(Get("/hang", milliseconds(150)), [&](HttpResponse&& r) { timedOut += r.error == Error::Timeout; });
+    HttpResponse meanwhile = Fetch(post);
+    CHECK(meanwhile.Answered() && meanwhile.body == post.body && timedOut == 0);
+    while (!timedOut && Clock::now() - start < seconds(2)) std::this_thread::sleep_for(milliseconds(2));
+    CHECK(timedOut == 1);
+    CHECK(Clock::now() - start >= milliseconds(140));
+
+    // Cancel completes once; the second finds nothing
+    std::atomic<int> cancelled{ 0 }, calls{ 0 };
+    Http::RequestId id = Http::Send(Get("/hang"), [&](HttpResponse&& r) {
+        calls++;
+        cancelled += r.error == Error::Cancelled;
+    });
+    CHECK(id != 0 && Http::InFlight() == 1);
+    CHECK(Http::Cancel(id));
+    CHECK(!Http::Cancel(id));
+    while (calls == 0) std::this_thread::sleep_for(milliseconds(1));
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(calls == 1 && cancelled == 1 && Http::InFlight() == 0);
+
+    // Stop cancels what is open and refuses what follows
+    std::atomic<int> stopped{ 0 };
+    for (int i = 0; i < 3; i++)
+        Http::Send(Get("/hang"), [&](HttpResponse&& r) { stopped += r.error == Error::Cancelled; });
+    Http::StopResult stop = Http::Stop(Clock::now() + seconds(2));
+    CHECK(stop.cancelled == 3 && stop.stillOpen == 0 && stopped == 3);
+    Error after = Error::None;
+    CHECK(Http::Send(post, [&](HttpResponse&& r) { after = r.error; }) == 0);
+    CHECK(after == Error::Refused);
+
+    // Started again, as a reload does
+    Http::Start();
+    HttpResponse again = Fetch(post);
+    CHECK(again.Answered() && again.body == post.body);
+
+    // Nobody listening
+    serving = false;
+    shutdown(listener, SHUT_RDWR);
+    close(listener);
+    acceptor.join();
+    HttpResponse refused = Fetch(Get("/echo"));
+    CHECK(refused.error == Error::Network && refused.status == 0);
+
+    CHECK(Http::InFlight() == 0);
+    Http::Stop(Clock::now() + seconds(1));
+    Scheduler::Stop();
+    for (auto& t : threads) t.join();
+    std::printf("test_http: ok\n");
+    return 0;
+}
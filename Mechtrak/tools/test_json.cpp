@@ -0,0 +1,100 @@
+// JsonWriter output must always parse back: shortest round-trip numbers,
+// escapes, and null for the non-finite values JSON can't represent.
+//
+//   g++ -std=c++20 -O2 -I.. test_json.cpp ../JsonReader.cpp -o test_json && ./test_json
+
+#include "Check.h"
+#include "JsonWriter.h"
+#include "JsonReader.h"
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Records the scalar values in document order
+    struct Values : JsonHandler {
+        std::vector<double> numbers;
+        std::vector<std::string> strings;
+        size_t nulls = 0;
+        bool Int(int64_t v) override              { numbers.push_back((double)v); return true; }
+        bool Float(double v) override             { numbers.push_back(v); return true; }
+        bool String(std::string_view s) override  { strings.emplace_back(s); return true; }
+        bool Null() override                      { nulls++; return true; }
+    };
+
+    bool Parses(const std::string& doc, Values& v)
+    {
+        JsonStreamParser p(v);
+        return p.Feed(doc) && p.Finish();
+    }
+}
+
+int main()
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    // Non-finite values become null and the document stays valid
+    {
+        std::string out;
+        JsonWriter w(out);
+        w.BeginArray();
+        w.Float(nan);
+        w.Float(inf);
+        w.Float(-inf);
+        w.Float(1.5);
+        w.EndArray();
+        CHECK(out == "[null,null,null,1.5]");
+        Values v;
+        CHECK(Parses(out, v));
+        CHECK(v.nulls == 3);
+        CHECK(v.numbers.size() == 1 && v.numbers[0] == 1.5);
+    }
+
+    // Same inside an object, pretty or not
+    for (bool pretty : { false, true }) {
+        std::string out;
+        JsonWriter w(out, pretty);
+        w.BeginObject();
+        w.Key("avg");
+        w.Float(0.0 / std::sin(0.0));
+        w.Key("n");
+        w.Int(3);
+        w.EndObject();
+        Values v;
+        CHECK(Parses(out, v));
+        CHECK(v.nulls == 1);
+    }
+
+    // Finite values keep a fraction and round-trip exactly
+    {
+        const double xs[] = { 0.0, -0.0, 1.0, 0.1, 1e300, -2.5e-308, 123456789.0 };
+        std::string out;
+        JsonWriter w(out);
+        w.BeginArray();
+        for (double x : xs) w.Float(x);
+        w.EndArray();
+        CHECK(out.find("null") == std::string::npos);
+        CHECK(out.rfind("[0.0,-0.0,1.0,", 0) == 0);
+        Values v;
+        CHECK(Parses(out, v));
+        CHECK(v.numbers.size() == std::size(xs));
+        for (size_t i = 0; i < v.numbers.size(); i++) CHECK(v.numbers[i] == xs[i]);
+    }
+
+    // Escapes survive the trip
+    {
+        const std::string s = "a\"b\\c\n\t\x01 end";
+        std::string out;
+        JsonWriter w(out);
+        w.String(s);
+        Values v;
+        CHECK(Parses(out, v));
+        CHECK(v.strings.size() == 1 && v.strings[0] == s);
+    }
+
+    std::printf("test_json: ok\n");
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Lifecycle shutdown: every Spawned thread is cancelled and joined before
+// Shutdown returns, the flush starts on the scheduler and counts only if it
+// calls done inside the deadline, a flush waiting on a request is released
+// by Http::Stop, and the whole thing can be started again as a reload does.
+// WinHTTP is replaced by a stand-in Http::Start/Stop below that holds
+// requests open until they are cancelled, or past it when told to.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_lifecycle.cpp ../Lifecycle.cpp ../Scheduler.cpp -o test_lifecycle && ./test_lifecycle
+
+#include "Check.h"
+#include "Lifecycle.h"
+#include "Scheduler.h"
+#include "Http.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+namespace
+{
+    // What the transport holds: requests that end when cancelled and ones
+    // that ignore it, as a handle WinHTTP never releases would
+    struct Transport {
+        std::mutex              mtx;
+        std::condition_variable cv;
+        bool started = false;
+        bool stopped = false;
+        int  stuck = 0;
+        int  starts = 0;
+        std::vector<std::function<void()>> open;
+
+        // Completes like a request: at once if refused, else when Stop cancels it
+        void Request(std::function<void()> done)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                if (started && !stopped) {
+                    open.push_back(std::move(done));
+                    return;
+                }
+            }
+            done();
+        }
+    } transport;
+
+    std::atomic<int> alive{ 0 };
+
+    // A worker that polls cancel as the plugin's do, counting itself alive
+    void Worker(const std::atomic<bool>& cancel)
+    {
+        alive++;
+        while (!cancel) std::this_thread::sleep_for(milliseconds(5));
+        std::this_thread::sleep_for(milliseconds(20));
+        alive--;
+    }
+
+    bool Within(milliseconds took, milliseconds bound) { return took <= bound + milliseconds(150); }
+}
+
+void Http::Start()
+{
+    std::lock_guard<std::mutex> lock(transport.mtx);
+    transport.started = true;
+    transport.stopped = false;
+    transport.starts++;
+}
+
+Http::StopResult Http::Stop(std::chrono::steady_clock::time_point until)
+{
+    std::vector<std::function<void()>> cancelled;
+    std::unique_lock<std::mutex> lock(transport.mtx);
+    StopResult result;
+    result.cancelled = (int)transport.open.size() + transport.stuck;
+    transport.stopped = true;
+    cancelled.swap(transport.open);
+    lock.unlock();
+    for (auto& done : cancelled) done();
+    lock.lock();
+    transport.cv.wait_until(lock, until, [] { return transport.stuck == 0; });
+    result.stillOpen = transport.stuck;
+    return result;
+}
+
+int main()
+{
+    // A quick flush, workers that outlive it, and no request in flight
+    Lifecycle::Start();
+    CHECK(!Lifecycle::ShuttingDown());
+    for (int i = 0; i < 8; i++) Lifecycle::Spawn(Worker);
+    while (alive < 8) std::this_thread::sleep_for(milliseconds(1));
+
+    std::atomic<bool> flushedOnScheduler{ false };
+    Lifecycle::ShutdownReport report = Lifecycle::Shutdown([&](std::function<void()> done) {
+        flushedOnScheduler = Scheduler::OnSchedulerThread();
+        Scheduler::After(milliseconds(50), done);
+    }, milliseconds(2000));
+    CHECK(report.flushed && flushedOnScheduler);
+    CHECK(report.threadsJoined == 8);
+    CHECK(alive == 0);
+    CHECK(report.requestsCancelled == 0 && report.requestsStuck == 0);
+    CHECK(report.elapsed < milliseconds(1000));
+    CHECK(Lifecycle::ShuttingDown());
+    CHECK(Scheduler::Pending() == 0);
+
+    // Nothing starts once shutdown has begun
+    std::atomic<bool> ran{ false };
+    Lifecycle::Spawn([&](const std::atomic<bool>&) { ran = true; });
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK(!ran);
+
+    // Reload: started again, finished workers are reaped as new ones come,
+    // and a flush stuck on a request is let go by Http::Stop once the
+    // reserve is reached, too late to count as flushed
+    Lifecycle::Start();
+    CHECK(!Lifecycle::ShuttingDown() && transport.starts == 2);
+    for (int i = 0; i < 20; i++) Lifecycle::Spawn([](const std::atomic<bool>&) { alive++; alive--; });
+    for (int i = 0; i < 3; i++) Lifecycle::Spawn(Worker);
+    while (alive < 3) std::this_thread::sleep_for(milliseconds(1));
+    std::atomic<int> ticks{ 0 };
+    Scheduler::Every(milliseconds(20), [&] { ticks++; });
+
+    const milliseconds deadline(800);
+    report = Lifecycle::Shutdown([](std::function<void()> done) { transport.Request(done); }, deadline);
+    CHECK(!report.flushed);
+    CHECK(report.requestsCancelled == 1 && report.requestsStuck == 0);
+    CHECK(report.threadsJoined >= 3 && report.threadsJoined <= 23);
+    CHECK(alive == 0);
+    CHECK(report.elapsed >= deadline - deadline / 4 - milliseconds(20) && Within(report.elapsed, deadline));
+    CHECK(transport.open.empty());
+    int after = ticks;
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK(ticks == after);
+
+    // A handle WinHTTP never lets go: Stop waits out the deadline and
+    // reports it, and Shutdown still returns
+    Lifecycle::Start();
+    Lifecycle::Spawn(Worker);
+    {
+        std::lock_guard<std::mutex> lock(transport.mtx);
+        transport.stuck = 1;
+    }
+    report = Lifecycle::Shutdown(nullptr, milliseconds(300));
+    CHECK(!report.flushed);
+    CHECK(report.requestsCancelled == 1 && report.requestsStuck == 1);
+    CHECK(report.threadsJoined == 1 && alive == 0);
+    CHECK(report.elapsed >= milliseconds(290) && Within(report.elapsed, milliseconds(300)));
+
+    std::printf("test_lifecycle: ok\n");
+    return 0;
+}
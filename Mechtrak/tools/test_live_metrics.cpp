@@ -0,0 +1,211 @@
+// LiveMetrics over a long session: attempts, flips, removals, undos and redos
+// fed through the SessionLog as the plugin does, with the session figures
+// checked against ones worked out from scratch over the recorded order and
+// the shot figures against a full rebuild. The session runs well past
+// 2 * LiveMetrics::ORDER attempts so the oldest get folded away; edits to
+// those and undoing back past them are checked at the end.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_live_metrics.cpp ../LiveMetrics.cpp ../DropDetector.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_live_metrics && ./test_live_metrics [seeds] [steps]
+
+#include "Check.h"
+#include "LiveMetrics.h"
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // The session in recorded order, as LiveMetrics keeps it: an undone
+    // removal comes back at the end
+    struct Order {
+        std::vector<std::pair<int, bool>> attempts;
+
+        void Push(int shot, bool goal) { attempts.push_back({ shot, goal }); }
+        void Pop(int shot)
+        {
+            for (size_t i = attempts.size(); i-- > 0;)
+                if (attempts[i].first == shot) { attempts.erase(attempts.begin() + i); return; }
+        }
+        void Flip(int shot, int index)
+        {
+            for (auto& [s, goal] : attempts)
+                if (s == shot && index-- == 0) { goal = !goal; return; }
+        }
+        std::vector<bool> Bits() const
+        {
+            std::vector<bool> h;
+            for (const auto& [s, goal] : attempts) h.push_back(goal);
+            return h;
+        }
+    };
+
+    // What Stream::Read() should give for h, worked out directly; without
+    // `all`, the EWMA and the drop detector are left out
+    RollingStats Expect(const std::vector<bool>& h, bool all = true)
+    {
+        RollingStats r;
+        size_t n = h.size();
+        auto window = [&](size_t w) {
+            size_t from = n > w ? n - w : 0;
+            int goals = 0;
+            for (size_t i = from; i < n; i++) goals += h[i];
+            return n > from ? (float)goals / (float)(n - from) : 0.f;
+        };
+        r.last10 = window(10);
+        r.last25 = window(25);
+        r.last50 = window(50);
+
+        int run = 0, goals = 0;
+        double ewma = 0.0;
+        DropDetector drop;
+        for (bool goal : h) {
+            run = goal ? run + 1 : 0;
+            r.bestStreak = std::max(r.bestStreak, run);
+            goals += goal;
+            if (!all) continue;
+            ewma = LiveMetrics::EWMA_ALPHA * goal + (1.0 - LiveMetrics::EWMA_ALPHA) * ewma;
+            drop.Add(goal);
+        }
+        r.streak = run;
+        if (n == 0) return r;
+
+        r.ewma = (float)(ewma / (1.0 - std::pow(1.0 - LiveMetrics::EWMA_ALPHA, (double)n)));
+        const double z = 1.96;
+        double p = (double)goals / n;
+        double z2n = z * z / n;
+        double center = (p + z2n / 2.0) / (1.0 + z2n);
+        double half = z * std::sqrt(p * (1.0 - p) / n + z2n / (4.0 * n)) / (1.0 + z2n);
+        r.wilsonLow = (float)std::max(0.0, center - half);
+        r.wilsonHigh = (float)std::min(1.0, center + half);
+        if (drop.Dropped()) {
+            r.dropped = true;
+            r.dropFrom = drop.Before();
+            r.dropTo = drop.Since();
+            r.dropLength = drop.Length();
+        }
+        return r;
+    }
+
+    bool Near(float a, float b) { return std::fabs(a - b) < 1e-4f; }
+
+    // Windows, streak and the lifetime interval; `all` adds the figures that
+    // depend on the whole order
+    bool Same(const RollingStats& a, const RollingStats& b, bool all)
+    {
+        bool same = Near(a.last10, b.last10) && Near(a.last25, b.last25) && Near(a.last50, b.last50)
+            && a.streak == b.streak && Near(a.wilsonLow, b.wilsonLow) && Near(a.wilsonHigh, b.wilsonHigh);
+        if (!all) return same;
+        return same && a.bestStreak == b.bestStreak && Near(a.ewma, b.ewma) && a.dropped == b.dropped
+            && Near(a.dropFrom, b.dropFrom) && Near(a.dropTo, b.dropTo) && a.dropLength == b.dropLength;
+    }
+
+    struct Session {
+        ShotTable   shots;
+        SessionLog  log;
+        LiveMetrics metrics;
+        Order       order;
+
+        bool Apply(ShotEvent e)
+        {
+            if (!log.Apply(shots, e)) return false;
+            e = *(log.end() - 1);
+            metrics.Apply(e, shots);
+            Mirror(e, false);
+            return true;
+        }
+        bool Undo()
+        {
+            const ShotEvent* e = log.Undo(shots);
+            if (!e) return false;
+            metrics.Revert(*e, shots);
+            Mirror(*e, true);
+            return true;
+        }
+        bool Redo()
+        {
+            const ShotEvent* e = log.Redo(shots);
+            if (!e) return false;
+            metrics.Apply(*e, shots);
+            Mirror(*e, false);
+            return true;
+        }
+        void Mirror(const ShotEvent& e, bool undone)
+        {
+            switch (e.kind) {
+            case ShotEvent::Kind::Attempt: if (undone) order.Pop(e.shot); else order.Push(e.shot, e.goal); break;
+            case ShotEvent::Kind::Flip:    order.Flip(e.shot, e.index); break;
+            case ShotEvent::Kind::Remove:  if (undone) order.Push(e.shot, e.goal); else order.Pop(e.shot); break;
+            }
+        }
+        void CheckShots() const
+        {
+            MetricsReport want = LiveMetrics::Of(shots);
+            for (const auto& [num, r] : want.shots) CHECK(Same(metrics.Shot(num), r, true));
+        }
+    };
+
+    void Run(unsigned seed, int steps)
+    {
+        std::mt19937 rng(seed);
+        auto pick = [&](int n) { return (int)(rng() % (unsigned)n); };
+        Session s;
+
+        // A shot only played at the start, whose attempts get folded away
+        for (int i = 0; i < 5; i++) CHECK(s.Apply(ShotEvent::Attempt(9, i % 2 == 0)));
+
+        for (int step = 0; step < steps; step++) {
+            int shot = 1 + pick(3);
+            int roll = pick(100);
+            if (roll < 80) CHECK(s.Apply(ShotEvent::Attempt(shot, pick(5) < 2)));
+            else if (roll < 86) {
+                // A recent attempt, which is still in order
+                int n = (int)s.shots[shot].Count();
+                if (n > 0) CHECK(s.Apply(ShotEvent::Flip(shot, std::max(0, n - 1 - pick(20)))));
+            }
+            else if (roll < 90) s.Apply(ShotEvent::Remove(shot));
+            else if (roll < 96) for (int k = 1 + pick(4); k > 0 && s.Undo(); k--) {}
+            else for (int k = 1 + pick(4); k > 0 && s.Redo(); k--) {}
+
+            if (step % 32 == 0) CHECK(Same(s.metrics.Session(), Expect(s.order.Bits()), true));
+            if (step % 512 == 0) s.CheckShots();
+        }
+        CHECK(s.order.attempts.size() > 2 * LiveMetrics::ORDER);
+        s.CheckShots();
+
+        // Edits to the folded shot only move the totals
+        CHECK(s.Apply(ShotEvent::Flip(9, 0)));
+        CHECK(Same(s.metrics.Session(), Expect(s.order.Bits()), false));
+        CHECK(s.Apply(ShotEvent::Remove(9)));
+        CHECK(Same(s.metrics.Session(), Expect(s.order.Bits()), false));
+        CHECK(s.Undo());
+        CHECK(s.Undo());
+        s.CheckShots();
+
+        // Undoing back past the order lays the session out shot by shot, as
+        // a full rebuild does; from then on only the totals follow the
+        // recorded order
+        bool relaid = false;
+        while (s.Undo()) {
+            RollingStats live = s.metrics.Session(), want = Expect(s.order.Bits(), false);
+            if (!relaid && !Same(live, want, false)) {
+                relaid = true;
+                CHECK(Same(live, LiveMetrics::Of(s.shots).session, true));
+            }
+            CHECK(Near(live.wilsonLow, want.wilsonLow) && Near(live.wilsonHigh, want.wilsonHigh));
+        }
+        CHECK(relaid);
+        CHECK(Same(s.metrics.Session(), RollingStats(), true));
+        for (const auto& [num, shot] : s.shots) CHECK(shot.Count() == 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int seeds = argc > 1 ? std::atoi(argv[1]) : 2;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 20000;
+    for (int seed = 1; seed <= seeds; seed++) Run((unsigned)seed, steps);
+    std::printf("test_live_metrics: ok (%d seeds x %d steps)\n", seeds, steps);
+    return 0;
+}
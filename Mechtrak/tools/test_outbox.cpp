@@ -0,0 +1,200 @@
+// Outbox against a stand-in server that can be switched up and down: what
+// a previous run left is picked up, snapshots of one session merge, nothing
+// is lost while the server is down or drops out mid-drain, backoff grows
+// and stays capped, a rejected body is counted as rejected rather than
+// sent, and a drain never sends faster than its gap allows.
+// Takes a few seconds, mostly the enforced gap between sends.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_outbox.cpp ../Outbox.cpp -o test_outbox && ./test_outbox
+
+#include "Check.h"
+#include "Outbox.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using namespace std::chrono_literals;
+    using Clock = std::chrono::steady_clock;
+
+    // Accepts bodies while up and records when each arrived; turns down
+    // the ones in `refuse` for good
+    struct Server {
+        bool up = false;
+        size_t dropAfter = SIZE_MAX;    // goes down after this many more bodies
+        std::string refuse;
+        std::vector<std::string> got;
+        std::vector<Clock::time_point> at;
+        size_t calls = 0;
+
+        Outbox::Result Send(const std::string& body)
+        {
+            calls++;
+            if (up && dropAfter == 0) up = false;
+            if (!up) return Outbox::Result::Failed;
+            if (dropAfter != SIZE_MAX) dropAfter--;
+            if (body == refuse) return Outbox::Result::Rejected;
+            got.push_back(body);
+            at.push_back(Clock::now());
+            return Outbox::Result::Sent;
+        }
+    };
+
+    // What Session::DrainOutbox does on the scheduler, here on one thread:
+    // oldest first until one fails, the queue is empty or max have been
+    // accepted, sitting out the gap between sends
+    size_t Drain(Server& server, size_t max = 16)
+    {
+        size_t sent = 0;
+        Outbox::Next next;
+        while (sent < max) {
+            if (!Outbox::Take(next)) {
+                if (next.wait.count() == 0) break;
+                std::this_thread::sleep_for(next.wait);
+                continue;
+            }
+            Outbox::Result result = server.Send(next.body);
+            Outbox::Settle(next, result);
+            if (result == Outbox::Result::Failed) break;
+            sent += result == Outbox::Result::Sent;
+        }
+        return sent;
+    }
+
+    void Write(const std::filesystem::path& path, const std::string& body)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << body;
+    }
+
+    size_t Files(const std::filesystem::path& dir)
+    {
+        size_t n = 0;
+        for (const auto& f : std::filesystem::directory_iterator(dir)) n += f.path().extension() == ".json";
+        return n;
+    }
+
+    // Drains until the queue is empty, past any backoff
+    void DrainAll(Server& server)
+    {
+        for (int i = 0; i < 100 && Outbox::GetStatus().pending > 0; i++) {
+            Outbox::NotifyOnline();
+            Drain(server);
+        }
+        CHECK(Outbox::GetStatus().pending == 0);
+    }
+}
+
+int main()
+{
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_test_outbox";
+    std::filesystem::remove_all(folder);
+    auto dir = folder / "outbox";
+    std::filesystem::create_directories(dir);
+
+    // Left by a previous run: two snapshots of one session, the newest
+    // wins, and a half-written one that is thrown away
+    Write(dir / "000000000003_old.json", "old v1");
+    Write(dir / "000000000005_old.json", "old v2");
+    Write(dir / "000000000006_gone.json.tmp", "partial");
+    Outbox::Open(folder.string());
+    Outbox::Open(folder.string());
+    CHECK(Outbox::GetStatus().pending == 1);
+    CHECK(Files(dir) == 1);
+    CHECK(!std::filesystem::exists(dir / "000000000006_gone.json.tmp"));
+
+    // A newer snapshot replaces the pending one of the same session
+    Outbox::Enqueue("a", "a v1");
+    Outbox::Enqueue("b", "b v1");
+    Outbox::Enqueue("c/..", "c v1");
+    Outbox::Enqueue("a", "a v2");
+    CHECK(Outbox::GetStatus().pending == 4);
+    CHECK(Files(dir) == 4);
+
+    // Down: one try, then backing off without calling the server
+    Server server;
+    CHECK(Drain(server) == 0);
+    CHECK(server.calls == 1);
+    Outbox::Status status = Outbox::GetStatus();
+    CHECK(status.consecutiveFailures == 1);
+    CHECK(status.retryIn >= 900ms && status.retryIn <= 2s);
+    CHECK(Drain(server) == 0);
+    CHECK(server.calls == 1);
+
+    // Each failure doubles the delay, with up to half of it random, up to
+    // five minutes
+    auto delay = 2s;
+    for (int failures = 2; failures <= 10; failures++) {
+        Outbox::NotifyOnline();
+        CHECK(Drain(server) == 0);
+        delay = std::min<std::chrono::seconds>(delay * 2, 5min);
+        status = Outbox::GetStatus();
+        CHECK(status.consecutiveFailures == failures);
+        CHECK(status.retryIn >= delay / 2 - 100ms && status.retryIn <= delay);
+    }
+    CHECK(status.pending == 4);
+    CHECK(server.got.empty());
+
+    // Up: everything in order, oldest first, at most one send per gap
+    server.up = true;
+    Outbox::NotifyOnline();
+    CHECK(Drain(server) == 4);
+    CHECK((server.got == std::vector<std::string>{ "old v2", "b v1", "c v1", "a v2" }));
+    for (size_t i = 1; i < server.at.size(); i++) CHECK(server.at[i] - server.at[i - 1] >= 240ms);
+    status = Outbox::GetStatus();
+    CHECK(status.pending == 0 && status.consecutiveFailures == 0 && status.sent == 4);
+    CHECK(Files(dir) == 0);
+
+    // Right after a send, Take holds the next entry back for the rest of the gap
+    Outbox::Enqueue("g", "g v1");
+    Outbox::Next held;
+    CHECK(!Outbox::Take(held));
+    CHECK(held.wait > 0ms && held.wait <= 250ms);
+    std::this_thread::sleep_for(held.wait);
+    CHECK(Outbox::Take(held) && held.body == "g v1" && held.key == "g");
+    Outbox::Settle(held, Outbox::Result::Sent);
+    CHECK(Outbox::GetStatus().pending == 0);
+
+    // Drops out mid-drain: the failed entry stays first and goes out once
+    // the server is back, each session's newest snapshot exactly once
+    server.got.clear();
+    server.at.clear();
+    for (int i = 0; i < 6; i++) Outbox::Enqueue("s" + std::to_string(i), "s" + std::to_string(i) + " v1");
+    Outbox::Enqueue("s4", "s4 v2");
+    server.dropAfter = 2;
+    CHECK(Drain(server) == 2);
+    CHECK(Outbox::GetStatus().pending == 4);
+    CHECK(Drain(server) == 0);
+    server.up = true;
+    server.dropAfter = SIZE_MAX;
+    DrainAll(server);
+    CHECK((server.got == std::vector<std::string>{ "s0 v1", "s1 v1", "s2 v1", "s3 v1", "s5 v1", "s4 v2" }));
+
+    // A body the server turns down is dropped and counted apart from the
+    // ones it took, without a backoff
+    Outbox::Enqueue("bad", "bad v1");
+    Outbox::Enqueue("r1", "r1 v1");
+    server.refuse = "bad v1";
+    server.got.clear();
+    status = Outbox::GetStatus();
+    CHECK(Drain(server) == 1);
+    CHECK((server.got == std::vector<std::string>{ "r1 v1" }));
+    Outbox::Status after = Outbox::GetStatus();
+    CHECK(after.pending == 0 && after.consecutiveFailures == 0);
+    CHECK(after.sent == status.sent + 1 && after.rejected == status.rejected + 1);
+    CHECK(after.lastRejected == "bad");
+    CHECK(Files(dir) == 0);
+
+    // At most maxEntries per call
+    for (int i = 0; i < 3; i++) Outbox::Enqueue("m" + std::to_string(i), "m");
+    CHECK(Drain(server, 2) == 2);
+    CHECK(Drain(server, 2) == 1);
+
+    std::filesystem::remove_all(folder);
+    std::printf("test_outbox: ok\n");
+    return 0;
+}
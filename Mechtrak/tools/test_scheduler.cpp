@@ -0,0 +1,136 @@
+// Scheduler timing wheel: order, never early, cancel and re-arm rules, and
+// timers more than one wheel revolution out.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_scheduler.cpp ../Scheduler.cpp -o test_scheduler && ./test_scheduler
+
+#include "Check.h"
+#include "Scheduler.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+namespace
+{
+    std::mutex       mtx;
+    std::vector<int> fired;
+
+    void Note(int tag)
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fired.push_back(tag);
+    }
+
+    std::vector<int> Fired()
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        return fired;
+    }
+}
+
+int main()
+{
+    // Not started: nothing is armed
+    CHECK(Scheduler::After(milliseconds(0), [] {}) == 0);
+
+    Scheduler::Start();
+    Scheduler::Start();   // second call is a no-op
+
+    // Fires in due order regardless of arming order, and never early
+    {
+        const auto t0 = Clock::now();
+        std::atomic<int64_t> early{ 0 };
+        for (int d : { 120, 40, 80, 0, 200 }) {
+            Scheduler::After(milliseconds(d), [=, &early] {
+                if (Clock::now() - t0 < milliseconds(d)) early++;
+                Note(d);
+            });
+        }
+        std::this_thread::sleep_for(milliseconds(400));
+        CHECK(early == 0);
+        CHECK((Fired() == std::vector<int>{ 0, 40, 80, 120, 200 }));
+        CHECK(Scheduler::Pending() == 0);
+    }
+
+    // Cancel before due; cancelling twice or an unknown id reports false
+    {
+        fired.clear();
+        auto a = Scheduler::After(milliseconds(50), [] { Note(1); });
+        auto b = Scheduler::After(milliseconds(50), [] { Note(2); });
+        CHECK(Scheduler::Cancel(a));
+        CHECK(!Scheduler::Cancel(a));
+        CHECK(!Scheduler::Cancel(0));
+        CHECK(!Scheduler::Cancel(999999));
+        std::this_thread::sleep_for(milliseconds(150));
+        CHECK((Fired() == std::vector<int>{ 2 }));
+        CHECK(!Scheduler::Cancel(b));   // already fired
+    }
+
+    // Reset replaces the old timer
+    {
+        fired.clear();
+        auto id = Scheduler::After(milliseconds(30), [] { Note(1); });
+        id = Scheduler::Reset(id, milliseconds(60), [] { Note(2); });
+        std::this_thread::sleep_for(milliseconds(150));
+        CHECK((Fired() == std::vector<int>{ 2 }));
+    }
+
+    // A periodic timer cancelled from its own task is not re-armed
+    {
+        std::atomic<int> runs{ 0 };
+        std::atomic<Scheduler::TimerId> self{ 0 };
+        self = Scheduler::Every(milliseconds(20), [&] {
+            if (++runs == 3) CHECK(Scheduler::Cancel(self));
+        });
+        std::this_thread::sleep_for(milliseconds(250));
+        CHECK(runs == 3);
+        CHECK(Scheduler::Pending() == 0);
+    }
+
+    // Tasks never overlap, and OnSchedulerThread tells them apart
+    {
+        std::atomic<int> inside{ 0 }, overlap{ 0 }, onThread{ 0 };
+        for (int i = 0; i < 50; i++) {
+            Scheduler::After(milliseconds(i % 5), [&] {
+                if (++inside > 1) overlap++;
+                if (Scheduler::OnSchedulerThread()) onThread++;
+                std::this_thread::sleep_for(microseconds(200));
+                inside--;
+            });
+        }
+        std::this_thread::sleep_for(milliseconds(200));
+        CHECK(overlap == 0);
+        CHECK(onThread == 50);
+        CHECK(!Scheduler::OnSchedulerThread());
+    }
+
+    // 512 slots of 10 ms: a timer past 5.12 s shares a slot with a nearer one
+    // and must wait for its own revolution
+    {
+        fired.clear();
+        const auto t0 = Clock::now();
+        Clock::time_point late{};
+        Scheduler::After(milliseconds(5200), [&] { late = Clock::now(); Note(2); });
+        Scheduler::After(milliseconds(80), [] { Note(1); });
+        std::this_thread::sleep_for(milliseconds(5400));
+        CHECK((Fired() == std::vector<int>{ 1, 2 }));
+        CHECK(late - t0 >= milliseconds(5200));
+    }
+
+    // Stop drops what is pending and is safe to repeat
+    {
+        fired.clear();
+        Scheduler::After(milliseconds(100), [] { Note(1); });
+        Scheduler::Stop();
+        Scheduler::Stop();
+        CHECK(Scheduler::Pending() == 0);
+        std::this_thread::sleep_for(milliseconds(150));
+        CHECK(Fired().empty());
+    }
+
+    std::printf("test_scheduler: ok\n");
+    return 0;
+}
@@ -0,0 +1,221 @@
+// SessionLog replay: random attempts, removals, flips, undos and redos on a
+// live table, checked as it goes against a table rebuilt from scratch out of
+// the events still applied. A small memory budget seals old attempts
+// to disk along the way, so flips and removals reach into sealed blocks,
+// and the log moves its older events out to its undo file. Halfway through,
+// a server copy replaces one shot and the log drops its events, after which
+// undo takes that shot back to the server's history and no further.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_session_log.cpp ../SessionLog.cpp ../AttemptSpill.cpp ../SessionArena.cpp -o test_session_log && ./test_session_log [seeds] [steps]
+
+#include "Check.h"
+#include "SessionLog.h"
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // The reference: one shot as plain outcomes and the times of the newest
+    struct Model {
+        std::vector<bool>        outcomes;
+        std::vector<AttemptTime> times;
+    };
+
+    bool Timed(const AttemptTime& t) { return t.start || t.touch || t.end; }
+
+    // Applies e the obvious way; false where SessionLog must refuse it
+    bool Replay(std::map<int, Model>& table, const ShotEvent& e)
+    {
+        Model& m = table[e.shot];
+        switch (e.kind) {
+        case ShotEvent::Kind::Attempt:
+            m.outcomes.push_back(e.goal);
+            if (!m.times.empty() || Timed(e.time)) m.times.push_back(e.time);
+            return true;
+        case ShotEvent::Kind::Flip:
+            if (e.index < 0 || (size_t)e.index >= m.outcomes.size()) return false;
+            m.outcomes[e.index] = !m.outcomes[e.index];
+            return true;
+        case ShotEvent::Kind::Remove:
+            if (m.outcomes.empty()) return false;
+            m.outcomes.pop_back();
+            if (!m.times.empty()) m.times.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    std::map<int, Model> Rebuild(const std::map<int, Model>& base, const std::vector<ShotEvent>& applied)
+    {
+        std::map<int, Model> table = base;
+        for (const auto& e : applied) CHECK(Replay(table, e));
+        return table;
+    }
+
+    void Compare(const ShotTable& live, const std::map<int, Model>& want)
+    {
+        for (const auto& [num, m] : want) {
+            auto it = live.find(num);
+            if (m.outcomes.empty() && it == live.end()) continue;
+            CHECK(it != live.end());
+            const ShotStats& s = it->second;
+            CHECK(s.Count() == m.outcomes.size());
+            CHECK(s.attempts == (int)m.outcomes.size());
+            int goals = 0;
+            for (size_t i = 0; i < m.outcomes.size(); i++) {
+                CHECK(s.Outcome(i) == m.outcomes[i]);
+                goals += m.outcomes[i];
+            }
+            CHECK(s.goals == goals);
+            CHECK(s.Timed() == m.times.size());
+            size_t first = m.outcomes.size() - m.times.size();
+            for (size_t k = 0; k < m.times.size(); k++) {
+                AttemptTime t = s.Time(first + k);
+                CHECK(t.start == m.times[k].start && t.touch == m.times[k].touch && t.end == m.times[k].end);
+            }
+        }
+        for (const auto& [num, s] : live)
+            if (!want.count(num)) CHECK(s.Count() == 0);
+    }
+
+    void Run(unsigned seed, int steps)
+    {
+        SessionArena arena;
+        ShotTable shots{ &arena };
+        SessionLog log;
+        const std::string sessionId = "test" + std::to_string(seed);
+        log.Bind(sessionId);
+
+        std::mt19937 rng(seed);
+        auto pick = [&](int n) { return (int)(rng() % (unsigned)n); };
+
+        // What the log should hold: every event applied, and how many of
+        // them are in effect
+        std::vector<ShotEvent> events;
+        size_t cursor = 0;
+        std::map<int, Model> model, base;
+        uint32_t clock = 0;
+
+        for (int step = 0; step < steps; step++) {
+            int shot = 1 + pick(3);
+            int roll = pick(100);
+            // Every so often a long way back and part of the way forward
+            // again, which thaws sealed blocks
+            int undo = step % 5000 == 4999 ? 1500 : roll >= 85 && roll < 95 ? 1 + pick(4) : 0;
+            int redo = step % 5000 == 4999 ? pick(1500) : roll >= 95 ? 1 + pick(4) : 0;
+
+            if (undo || redo) {
+                for (; undo > 0; undo--) {
+                    // Undo reaches back to the first event, through the
+                    // ones moved out to the undo file
+                    CHECK(log.Undoable() == cursor);
+                    const ShotEvent* e = log.Undo(shots);
+                    if (!e) { CHECK(cursor == 0); break; }
+                    cursor--;
+                    CHECK(e->kind == events[cursor].kind && e->shot == events[cursor].shot);
+                }
+                for (; redo > 0; redo--) {
+                    const ShotEvent* e = log.Redo(shots);
+                    CHECK((e != nullptr) == (cursor < events.size()));
+                    if (!e) break;
+                    CHECK(e->kind == events[cursor].kind && e->shot == events[cursor].shot);
+                    cursor++;
+                }
+                model = Rebuild(base, std::vector<ShotEvent>(events.begin(), events.begin() + cursor));
+            }
+            else if (roll < 75) {
+                // A third of them timed
+                AttemptTime t;
+                if (pick(3) == 0) { clock += 1000; t = { clock, clock + 200, clock + 900 }; }
+                ShotEvent e = ShotEvent::Attempt(shot, pick(3) == 0, t);
+                CHECK(log.Apply(shots, e));
+                CHECK(Replay(model, e));
+                events.resize(cursor);
+                events.push_back(e);
+                cursor++;
+            }
+            else {
+                // Some of these don't fit: a flip past either end, a removal
+                // from an empty shot
+                ShotEvent e = roll < 79 ? ShotEvent::Remove(shot)
+                    : ShotEvent::Flip(shot, pick((int)model[shot].outcomes.size() + 2) - 1);
+                bool fits = Replay(model, e);
+                CHECK(log.Apply(shots, e) == fits);
+                if (fits) {
+                    events.resize(cursor);
+                    events.push_back(e);
+                    cursor++;
+                }
+            }
+
+            // The server's copy of shot 2, longer than ours, as
+            // Session::ApplyActive moves it in
+            if (step == steps / 2) {
+                Model server;
+                ShotStats fresh;
+                size_t n = model[2].outcomes.size() + 1 + (size_t)pick(50);
+                for (size_t i = 0; i < n; i++) {
+                    bool goal = pick(2) == 0;
+                    server.outcomes.push_back(goal);
+                    fresh.attemptHistory.push_back(goal);
+                    fresh.attempts++;
+                    fresh.goals += goal;
+                }
+                shots[2] = std::move(fresh);
+                log.Drop({ 2 });
+
+                std::vector<ShotEvent> kept;
+                size_t keptCursor = 0;
+                for (size_t i = 0; i < events.size(); i++)
+                    if (events[i].shot != 2) {
+                        kept.push_back(events[i]);
+                        keptCursor += i < cursor;
+                    }
+                events = std::move(kept);
+                cursor = keptCursor;
+                base[2] = server;
+                model = Rebuild(base, std::vector<ShotEvent>(events.begin(), events.begin() + cursor));
+                CHECK(log.Undoable() == cursor);
+            }
+
+            CHECK(log.Redoable() == events.size() - cursor);
+            if (step % 64 == 0) AttemptSpill::Enforce(shots, sessionId);
+            if (step % 16 == 0 || step == steps - 1) Compare(shots, model);
+        }
+
+        // Everything still undoable goes back, then comes forward again
+        CHECK(log.Undoable() == cursor);
+        for (; cursor > 0; cursor--) CHECK(log.Undo(shots));
+        CHECK(!log.Undo(shots));
+        Compare(shots, Rebuild(base, std::vector<ShotEvent>(events.begin(), events.begin() + cursor)));
+        while (log.Redo(shots)) cursor++;
+        CHECK(cursor == events.size());
+        Compare(shots, Rebuild(base, events));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int seeds = argc > 1 ? std::atoi(argv[1]) : 8;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 20000;
+
+    // Without a spill folder nothing seals and the log keeps every event
+    // in memory
+    Run(0, steps / 4);
+
+    auto folder = std::filesystem::temp_directory_path() / "mechtrak_test_session_log";
+    std::filesystem::create_directories(folder);
+    AttemptSpill::Open(folder.string());
+    AttemptSpill::SetBudget(16 * 1024);
+
+    for (int seed = 1; seed <= seeds; seed++) Run((unsigned)seed, steps);
+
+    std::error_code ec;
+    std::filesystem::remove_all(folder, ec);
+    std::printf("test_session_log: ok (%d seeds x %d steps)\n", seeds, steps);
+    return 0;
+}
@@ -0,0 +1,186 @@
+// SyncWorker batching: a burst of attempts becomes few requests, none older
+// than the staleness bound, and an edit is never held back by the attempts
+// that follow it. A job waiting on its response leaves the scheduler free
+// but holds back the next job, and Flush waits for both.
+//
+//   g++ -std=c++20 -O2 -pthread -I.. test_sync.cpp ../SyncWorker.cpp ../Scheduler.cpp -o test_sync && ./test_sync
+
+#include "Check.h"
+#include "SyncWorker.h"
+#include "Scheduler.h"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+namespace
+{
+    // Stands in for the upload: records which snapshot went out and when
+    struct Uploads {
+        std::mutex mtx;
+        std::vector<std::pair<int, Clock::time_point>> sent;
+
+        SyncWorker::Job Job(int tag)
+        {
+            return [this, tag](SyncWorker::Done done) {
+                {
+                    std::lock_guard<std::mutex> lock(mtx);
+                    sent.emplace_back(tag, Clock::now());
+                }
+                done();
+            };
+        }
+
+        size_t Count()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            return sent.size();
+        }
+
+        std::pair<int, Clock::time_point> Last()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            return sent.back();
+        }
+    };
+
+    // Long enough that the worker treats the next attempt as the first
+    void Quiet(milliseconds bound) { std::this_thread::sleep_for(bound + milliseconds(50)); }
+
+    // Flush or Stop, waited for here
+    template<typename Fn>
+    void Wait(Fn&& fn)
+    {
+        std::promise<void> released;
+        fn([&] { released.set_value(); });
+        released.get_future().wait();
+    }
+}
+
+int main()
+{
+    Scheduler::Start();
+    const milliseconds bound(1000);
+    SyncWorker::SetMaxStaleness(bound);
+
+    // A burst folds into a few requests, the newest snapshot always wins,
+    // and no attempt waits past the bound
+    {
+        Uploads up;
+        std::vector<Clock::time_point> submitted;
+        for (int i = 0; i < 60; i++) {
+            submitted.push_back(Clock::now());
+            SyncWorker::Submit(up.Job(i), SyncWorker::Trigger::Attempt);
+            std::this_thread::sleep_for(milliseconds(30));
+        }
+        std::this_thread::sleep_for(bound + milliseconds(200));
+        CHECK(up.Count() >= 2);
+        CHECK(up.Count() < 20);
+        CHECK(up.Last().first == 59);
+        // Each upload carries every attempt since the one before it; the
+        // oldest of those must not have waited past the bound
+        size_t next = 0;
+        for (auto& [tag, at] : up.sent) {
+            CHECK(at - submitted[next] <= bound + milliseconds(100));
+            next = (size_t)tag + 1;
+        }
+        Quiet(bound);
+    }
+
+    // An edit goes out as soon as the scheduler is free, even when attempts
+    // arrive before it has run
+    {
+        Uploads up;
+        const auto t0 = Clock::now();
+        SyncWorker::Submit(up.Job(1), SyncWorker::Trigger::Attempt);   // first: sent now
+        std::this_thread::sleep_for(milliseconds(300));
+        SyncWorker::Submit(up.Job(2), SyncWorker::Trigger::Attempt);   // held ~600 ms
+        std::this_thread::sleep_for(milliseconds(50));
+
+        // Keep the scheduler busy so the edit can't run before the next attempt
+        Scheduler::After(milliseconds(0), [] { std::this_thread::sleep_for(milliseconds(200)); });
+        std::this_thread::sleep_for(milliseconds(20));
+        SyncWorker::Submit(up.Job(3), SyncWorker::Trigger::Edit);
+        SyncWorker::Submit(up.Job(4), SyncWorker::Trigger::Attempt);   // would hold ~460 ms
+
+        std::this_thread::sleep_for(milliseconds(1200));
+        CHECK(up.Count() == 2);
+        CHECK(up.Last().first == 4);
+        CHECK(up.Last().second - t0 < milliseconds(700));
+
+        // Once the edit is out, attempts batch normally again
+        Quiet(bound);
+        SyncWorker::Submit(up.Job(5), SyncWorker::Trigger::Attempt);
+        std::this_thread::sleep_for(milliseconds(300));
+        SyncWorker::Submit(up.Job(6), SyncWorker::Trigger::Attempt);
+        std::this_thread::sleep_for(milliseconds(100));
+        CHECK(up.Count() == 3);
+        Quiet(bound);
+        CHECK(up.Count() == 4);
+        Quiet(bound);
+    }
+
+    // Flush runs what is pending on the caller, once
+    {
+        Uploads up;
+        SyncWorker::Submit(up.Job(1), SyncWorker::Trigger::Attempt);
+        std::this_thread::sleep_for(milliseconds(100));
+        SyncWorker::Submit(up.Job(2), SyncWorker::Trigger::Attempt);
+        Wait(SyncWorker::Flush);
+        CHECK(up.Count() == 2);
+        CHECK(up.Last().first == 2);
+        std::this_thread::sleep_for(bound);
+        CHECK(up.Count() == 2);
+    }
+
+    // A job still waiting on the server: timers keep running, the next job
+    // waits its turn, and Flush returns once both are done
+    {
+        std::atomic<int> started{ 0 }, finished{ 0 }, ticks{ 0 };
+        auto slow = [&](SyncWorker::Done done) {
+            started++;
+            Scheduler::After(milliseconds(300), [&, done] {
+                finished++;
+                done();
+            });
+        };
+        Scheduler::TimerId ticker = Scheduler::Every(milliseconds(20), [&] { ticks++; });
+        SyncWorker::Submit(slow, SyncWorker::Trigger::Edit);
+        std::this_thread::sleep_for(milliseconds(100));
+        CHECK(started == 1 && finished == 0);
+        SyncWorker::Submit(slow, SyncWorker::Trigger::Edit);
+        std::this_thread::sleep_for(milliseconds(100));
+        CHECK(started == 1);
+        CHECK(ticks >= 5);
+        auto start = Clock::now();
+        Wait(SyncWorker::Flush);
+        CHECK(started == 2 && finished == 2);
+        CHECK(Clock::now() - start >= milliseconds(350));
+        Scheduler::Cancel(ticker);
+    }
+
+    // Staleness 0 turns batching off
+    {
+        SyncWorker::SetMaxStaleness(milliseconds(0));
+        Uploads up;
+        for (int i = 0; i < 5; i++) {
+            SyncWorker::Submit(up.Job(i), SyncWorker::Trigger::Attempt);
+            std::this_thread::sleep_for(milliseconds(60));
+        }
+        CHECK(up.Count() == 5);
+    }
+
+    SyncWorker::Stats s = SyncWorker::GetStats();
+    CHECK(s.requests >= 10);
+    CHECK(s.submitted >= s.requests);
+    CHECK(s.staleness.total == s.requests);
+
+    Wait(SyncWorker::Stop);
+    Scheduler::Stop();
+    std::printf("test_sync: ok\n");
+    return 0;
+}